@@ -11,6 +11,17 @@
 #include "glm/gtx/transform.hpp"
 
 #include "Rose/Renderer/API/VKMemAllocator.h"
+#include "Rose/Renderer/API/ShaderCache.h"
+#include "Rose/Renderer/API/UniformRingBuffer.h"
+#include "Rose/Renderer/GPUScene.h"
+#include "Rose/Renderer/ClusterCuller.h"
+#include "Rose/Renderer/LODSelector.h"
+#include "Rose/Renderer/InstanceBatcher.h"
+#include "Rose/Scene/Scene.h"
+#include "Rose/Renderer/API/TextureCache.h"
+#include "Rose/Renderer/API/UploadManager.h"
+#include "Profiler.h"
+#include "JobSystem.h"
 #include "Skybox.h"
 
 #include <imgui/imgui.h>
@@ -62,24 +73,13 @@ namespace Rose
 
 
 
-	static glm::vec3 spherePos = { 0.0f, 150.0f, 0.0f };
-	//static glm::vec3 sphereRot = { -90.0f, 0.0f, 0.0f};
-	//static glm::vec3 spherePos = { 0.0f, 0.0f, 0.0f };
-	//static glm::vec3 spherePos = { 0.0f, 2.0f, 0.0f };
-	//static glm::vec3 sphereRot = { 0.0f, 0.0f, 0.0f };
-	//static glm::vec3 sphereRot = { 0.0f, 180.0f, 0.0f };
-	static glm::vec3 sphereRot = { 90.0f, 0.0, 180.0f };
-	static glm::vec3 sphereScale = { 1.0f, 1.0f, 1.0f };
-
-	static glm::vec4 DirLightDir = { 1.0f, 1.0f, 1.0f , 1.0f };
-	static glm::vec4 DirLightColor = { 1.0f, 1.0f, 1.0f, 1.0f };
-	static float DirLightIntensity = 1.0f;
 	static float EnviormentMapIntensity = 2.0f;
 
 
-	Application::Application()
+	Application::Application(VertexFormat geometryFormat)
 	{
 		s_INSTANCE = this;
+		JobSystem::Init();
 		m_ImguiLayer = new ImguiLayer;
 
 
@@ -88,9 +88,10 @@ namespace Rose
 		CreateVulkanInstance();
 
 		VKMemAllocator::Init();
-		//m_TestModel = std::make_shared<Model>("assets/models/sponza/sponza.gltf");
-		m_TestModel = std::make_shared<Model>("assets/models/used-stainless-steel/used-stainless-steel.fbx");
-		m_SphereModel = std::make_shared<Model>("assets/models/Cerberus_by_Andrew_Maximov/Cerberus_LP_mapped.fbx");
+		UploadManager::Init(64 * 1024 * 1024);
+		UniformRingBuffer::Init(64 * 1024, m_RenderingContext->GetLogicalDevice()->GetFramesInFlight());
+		GPUScene::Init(16 * 1024, 1024, m_RenderingContext->GetLogicalDevice()->GetFramesInFlight());
+		ClusterCuller::Init(256 * 1024, 1024, m_RenderingContext->GetLogicalDevice()->GetFramesInFlight());
 
 		
 		ShaderAttributeLayout layout =
@@ -99,7 +100,8 @@ namespace Rose
 		};
 
 
-		m_SkyboxShader = std::make_shared<Shader>("assets/shaders/skybox.shader", layout, true);
+		m_SkyboxMaterial.Name = "Skybox";
+		m_SkyboxMaterial.ShaderData = ShaderLibrary::Get("assets/shaders/skybox.shader", layout, true);
 
 		MaterialUniform diffuseUniform;
 
@@ -128,18 +130,24 @@ namespace Rose
 #endif
 		diffuseUniform.Texture3DCube = std::make_shared<TextureCube>(files);
 		diffuseUniform.TextureType = PBRTextureType::Rad;
-		m_SkyboxUniforms.push_back(diffuseUniform);
+		m_SkyboxMaterial.Uniforms.push_back(diffuseUniform);
+
+		m_SkyboxMaterial.CreateDescriptorSet();
 
-		m_SkyboxShader->CreatePipelineAndDescriptorPool(m_SkyboxUniforms);
-		
 		m_SkyboxVbo = std::make_shared<VertexBuffer>(skyboxV, sizeof(skyboxV));
 		m_SkyboxIbo = std::make_shared<IndexBuffer>(skyboxI, sizeof(skyboxI));
 
-
+		// Every texture and buffer upload so far was only recorded, the first frame is submitted after this on the same queue
+		UploadManager::Submit();
+		const auto& uploadStats = UploadManager::GetStats();
+		LOG("Uploads: %d batches submitted on the %s queue, %d fence waits, %d ownership transfers, %.2fMB staged\n",
+			uploadStats.Batches, UploadManager::UsesTransferQueue() ? "transfer" : "graphics", uploadStats.Waits, uploadStats.OwnershipTransfers,
+			(float)uploadStats.BytesStaged / (1024.0f * 1024.0f));
 
 		CreateGraphicsPipeline();
 		CreateFramebuffers();
 		CreateCommandPoolAndBuffer();
+		CreateGeometry(geometryFormat);
 
 
 	}
@@ -157,18 +165,18 @@ namespace Rose
 
 		m_Camera = std::make_shared<Rose::PerspectiveCameraController>(glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 10000.0f));
 		m_Camera->GetCam().SetPosition({ 0.0f, 0.0f, -10.0f });
-		UniformBufferData ubo;
-		
+		SceneUniformData ubo;
+
+		OnInit();
+		OnSceneLoaded();
+
 
 
-		ubo.Model = glm::mat4(1.0f);
 		while (!glfwWindowShouldClose(m_Window))
 		{
 			m_Camera->OnUpdate(0.016f);
+			OnUpdate(0.016f);
 
-			ubo.DirLightDir = DirLightDir;
-			ubo.DirLightCol = DirLightColor;
-			ubo.DirLightIntensity.x = DirLightIntensity;
 			ubo.EnivormentMapIntensity.x = EnviormentMapIntensity;
 
 			ubo.View = m_Camera->GetCam().GetView();
@@ -176,21 +184,8 @@ namespace Rose
 			ubo.ViewProj = m_Camera->GetCam().GetProjView();
 		
 			glfwPollEvents();
-			for (auto& mat : m_TestModel->GetMaterials())
-			{
-				ubo.Model = glm::mat4(1.0f);
-				mat.ShaderData->UpdateUniformBuffer(&ubo, sizeof(ubo), 0);
-			}
-
-			for (auto& mat : m_SphereModel->GetMaterials())
-			{
-				ubo.Model = glm::translate(glm::mat4(1.0f), spherePos) * glm::toMat4(glm::quat(glm::radians(sphereRot))) * glm::scale(glm::mat4(1.0f), sphereScale);
-				mat.ShaderData->UpdateUniformBuffer(&ubo, sizeof(ubo), 0);
-			}
-
-			ubo.Model = glm::mat4(1.0f);
-			m_SkyboxShader->UpdateUniformBuffer(&ubo, sizeof(ubo), 0);
-			DrawOntoScreen();
+			JobSystem::ProcessMainThreadJobs();
+			DrawOntoScreen(ubo);
 
 		}
 
@@ -318,7 +313,7 @@ namespace Rose
 
 			VkFramebufferCreateInfo framebufferInfo{};
 			framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-			framebufferInfo.renderPass = m_TestModel->GetMaterials()[0].ShaderData->GetRenderPass();
+			framebufferInfo.renderPass = GetRenderPass();
 			framebufferInfo.attachmentCount = attachments.size();
 			framebufferInfo.pAttachments = attachments.data();
 			framebufferInfo.width = m_SwapChain->GetExtent2D().width;
@@ -330,75 +325,73 @@ namespace Rose
 		}
 	}
 
-	void Application::CreateVertexBuffer()
+	void Application::CreateGeometry(VertexFormat format)
 	{
+		// Every model is loaded in one vertex format, so they share a pool. Plenty for what the sandbox loads
+		m_GeometryPool = std::make_shared<GeometryPool>(format, 1024 * 1024, 4 * 1024 * 1024);
+	}
 
-		for (auto& mesh : m_TestModel->GetMeshes())
-		{
-			auto& verticies = mesh.Verticies;
-
-			float size = sizeof(Vertex) * verticies.size();
-			m_VBOs.push_back(std::make_shared<Rose::VertexBuffer>(verticies.data(), size));
-		}
-
-		for (auto& mesh : m_SphereModel->GetMeshes())
-		{
-			auto& verticies = mesh.Verticies;
-
-			float size = sizeof(Vertex) * verticies.size();
-			m_SphereVbo.push_back(std::make_shared<Rose::VertexBuffer>(verticies.data(), size));
-		}
-
-
+	std::shared_ptr<Model> Application::LoadModel(const std::string& filepath, bool isStatic)
+	{
+		auto model = std::make_shared<Model>(filepath, m_GeometryPool->GetVertexFormat(), isStatic);
+		m_Scene.AddModel(*model, *m_GeometryPool);
+		m_Models.push_back(model);
+		return model;
 	}
 
-	void Application::CreateIndexBuffer()
+	void Application::OnSceneLoaded()
 	{
+		// The copies (and the texture and cluster uploads) were only recorded, the first frame is submitted after this on the same queue
+		UploadManager::Submit();
 
-		for (auto& mesh : m_TestModel->GetMeshes())
-		{
-			auto& indicies = mesh.Indicies;
-			m_IBOs.push_back(std::make_shared<Rose::IndexBuffer>(indicies.data(), sizeof(indicies[0]) * indicies.size()));
-		}
-		for (auto& mesh : m_SphereModel->GetMeshes())
+		LOG("Texture cache: %d unique textures loaded, %d duplicate loads avoided\n", TextureCache::GetMisses(), TextureCache::GetHits());
+
+		size_t fullSize = 0;
+		uint32_t meshCount = 0;
+		uint32_t materialCount = 1;
+		for (auto& model : m_Models)
 		{
-			auto& indicies = mesh.Indicies;
-			m_SphereIbo.push_back(std::make_shared<Rose::IndexBuffer>(indicies.data(), sizeof(indicies[0]) * indicies.size()));
+			for (const auto& mesh : model->GetMeshes())
+				fullSize += mesh.GetVertexCount() * sizeof(Vertex);
+			meshCount += (uint32_t)model->GetMeshes().size();
+			materialCount += (uint32_t)model->GetMaterials().size();
 		}
-
-		
+		LOG("%d materials share %d shader pipelines\n", materialCount, ShaderLibrary::GetShaderCount());
+
+		const auto& cacheStats = ShaderCache::GetStats();
+		LOG("Shader cache: %d hits, %d misses, %.2fms compiling, %.2fms loading, %.2fms saved\n",
+			cacheStats.Hits, cacheStats.Misses, cacheStats.CompileTimeMs, cacheStats.LoadTimeMs, cacheStats.TimeSavedMs);
+
+		VertexFormat format = m_GeometryPool->GetVertexFormat();
+		const auto& vertexAllocator = m_GeometryPool->GetVertexAllocator();
+		const auto& indexAllocator = m_GeometryPool->GetIndexAllocator();
+		uint32_t packedSize = vertexAllocator.GetUsed() * (VertexPacker::GetStride(format, VertexStream_Position) + VertexPacker::GetStride(format, VertexStream_Attributes));
+		LOG("Geometry pool: %d / %d vertices (%d KB, %d KB unpacked), %d / %d index words\n", vertexAllocator.GetUsed(), vertexAllocator.GetCapacity(),
+			packedSize / 1024, (uint32_t)(fullSize / 1024), indexAllocator.GetUsed(), indexAllocator.GetCapacity());
+		LOG("Cluster culler: %d clusters\n", ClusterCuller::GetClusterCount());
+		LOG("Scene: %d entities, %d placements of %d meshes\n", m_Scene.GetStats().Entities, GPUScene::GetObjectCount(), meshCount);
 	}
 
 	void Application::CreateCommandPoolAndBuffer()
 	{
 
-		CreateVertexBuffer();
-		CreateIndexBuffer();
-
-
-		VkCommandBufferAllocateInfo allocInfo{};
-		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-		allocInfo.commandPool = m_RenderingContext->GetLogicalDevice()->GetCommandPool();
-		allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-		allocInfo.commandBufferCount = 1;
-		vkAllocateCommandBuffers(m_RenderingContext->GetLogicalDevice()->GetDevice(), &allocInfo, &m_VKCommandBuffer);
-
-
-
 	}
 
 
-	void Application::RecordCommandBuffer(uint32_t imageIndex)
+	void Application::RecordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex)
 	{
 		VkCommandBufferBeginInfo beginInfo{};
 		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
 
 
-		vkBeginCommandBuffer(m_VKCommandBuffer, &beginInfo);
+		vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+		// Writes this frame's indirect commands, compute can't run inside the render pass
+		ClusterCuller::Dispatch(commandBuffer, m_RenderingContext->GetLogicalDevice()->GetCurrentFrameIndex(), m_ObjectBufferOffset);
 
 		VkRenderPassBeginInfo renderPassInfo{};
 		renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-		renderPassInfo.renderPass = m_TestModel->GetMaterials()[0].ShaderData->GetRenderPass();
+		renderPassInfo.renderPass = GetRenderPass();
 		renderPassInfo.framebuffer = m_Framebuffers[imageIndex];
 		renderPassInfo.renderArea.offset = { 0, 0 };
 		renderPassInfo.renderArea.extent = m_SwapChain->GetExtent2D();
@@ -411,58 +404,61 @@ namespace Rose
 		renderPassInfo.clearValueCount = clearValues.size();
 		renderPassInfo.pClearValues = clearValues.data();
 
-		vkCmdBeginRenderPass(m_VKCommandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+		vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
 
 		{
-			VkBuffer vbos[] = { m_SkyboxVbo->GetBufferID() };
-			VkDeviceSize offset[] = { 0 };
+			const auto& shader = m_SkyboxMaterial.ShaderData;
 
-			const auto& shader = m_SkyboxShader;
+			vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, shader->GetGrahpicsPipeline());
 
-			vkCmdBindPipeline(m_VKCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, shader->GetGrahpicsPipeline());
+			m_SkyboxVbo->BindStreams(commandBuffer);
+			vkCmdBindIndexBuffer(commandBuffer, m_SkyboxIbo->GetBufferID(), m_SkyboxIbo->GetOffset(), m_SkyboxIbo->GetIndexType());
 
-			vkCmdBindVertexBuffers(m_VKCommandBuffer, 0, 1, vbos, offset);
-			vkCmdBindIndexBuffer(m_VKCommandBuffer, m_SkyboxIbo->GetBufferID(), 0, VK_INDEX_TYPE_UINT32);
-
-			vkCmdBindDescriptorSets(m_VKCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, shader->GetPipelineLayout(), 0, 1, &shader->GetDescriptorSet(), 0, nullptr);
-			vkCmdDrawIndexed(m_VKCommandBuffer, 36, 1, 0, 0, 0);
-			//vkCmdDraw(m_VKCommandBuffer, 36, 1, 0, 0);
+			vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, shader->GetPipelineLayout(), 0, 1, &m_SkyboxMaterial.DescriptorSet, 1, &m_SceneUniformOffset);
+			vkCmdDrawIndexed(commandBuffer, 36, 1, 0, 0, 0);
+			//vkCmdDraw(commandBuffer, 36, 1, 0, 0);
 		}
 
 
-		for (int i = 0; i < m_VBOs.size(); i++)
-		{
-
-			VkBuffer vbos[] = { m_VBOs[i]->GetBufferID() };
-			VkDeviceSize offset[] = { 0 };
+		// Materials share pipelines, so only rebind when it actually changes
+		VkPipeline boundPipeline = m_SkyboxMaterial.ShaderData->GetGrahpicsPipeline();
 
-			const auto& shader = m_TestModel->GetMaterials()[i].ShaderData;
+		// Ordered by binding: scene data (0), object buffer (8), instance list (9), materials (10)
+		uint32_t dynamicOffsets[] = { m_SceneUniformOffset, m_ObjectBufferOffset, m_InstanceBufferOffset, 0 };
 
-			vkCmdBindPipeline(m_VKCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, shader->GetGrahpicsPipeline());
+		// Every mesh draws out of the same arenas, only the index type can change between draws
+		m_GeometryPool->BindVertexStreams(commandBuffer);
+		VkIndexType boundIndexType = VK_INDEX_TYPE_MAX_ENUM;
 
-			vkCmdBindVertexBuffers(m_VKCommandBuffer, 0, 1, vbos, offset);
-			vkCmdBindIndexBuffer(m_VKCommandBuffer, m_IBOs[i]->GetBufferID(), 0, VK_INDEX_TYPE_UINT32);
+		const Material* boundMaterial = nullptr;
 
-			vkCmdBindDescriptorSets(m_VKCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, shader->GetPipelineLayout(), 0, 1, &shader->GetDescriptorSet(), 0, nullptr);
-			vkCmdDrawIndexed(m_VKCommandBuffer, m_TestModel->GetMeshes()[i].Indicies.size(), 1, 0, 0, 0);
-
-		}
-		for (int i = 0; i < m_SphereVbo.size(); i++)
+		// Batches come sorted by pipeline and material, so most of these binds are skipped
+		for (const auto& batch : InstanceBatcher::GetBatches())
 		{
+			const auto& mesh = InstanceBatcher::GetMesh(batch.Mesh);
+			const auto& material = *mesh.MaterialData;
+			const auto& shader = material.ShaderData;
 
-			VkBuffer vbos[] = { m_SphereVbo[i]->GetBufferID() };
-			VkDeviceSize offset[] = { 0 };
-
-			const auto& shader = m_SphereModel->GetMaterials()[i].ShaderData;
-
-			vkCmdBindPipeline(m_VKCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, shader->GetGrahpicsPipeline());
+			if (boundPipeline != shader->GetGrahpicsPipeline())
+			{
+				boundPipeline = shader->GetGrahpicsPipeline();
+				vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, boundPipeline);
+			}
 
-			vkCmdBindVertexBuffers(m_VKCommandBuffer, 0, 1, vbos, offset);
-			vkCmdBindIndexBuffer(m_VKCommandBuffer, m_SphereIbo[i]->GetBufferID(), 0, VK_INDEX_TYPE_UINT32);
+			if (boundIndexType != mesh.Geometry.IndexType)
+			{
+				boundIndexType = mesh.Geometry.IndexType;
+				m_GeometryPool->BindIndexBuffer(commandBuffer, boundIndexType);
+			}
 
-			vkCmdBindDescriptorSets(m_VKCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, shader->GetPipelineLayout(), 0, 1, &shader->GetDescriptorSet(), 0, nullptr);
-			vkCmdDrawIndexed(m_VKCommandBuffer, m_SphereModel->GetMeshes()[i].Indicies.size(), 1, 0, 0, 0);
+			if (boundMaterial != &material)
+			{
+				boundMaterial = &material;
+				vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, shader->GetPipelineLayout(), 0, 1, &material.DescriptorSet, 4, dynamicOffsets);
+			}
 
+			vkCmdPushConstants(commandBuffer, shader->GetPipelineLayout(), VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(uint32_t), &batch.FirstInstance);
+			InstanceBatcher::Draw(commandBuffer, batch);
 		}
 
 		
@@ -470,21 +466,44 @@ namespace Rose
 		OnImguiRender();
 		m_ImguiLayer->End();
 
-		vkCmdEndRenderPass(m_VKCommandBuffer);
-		vkEndCommandBuffer(m_VKCommandBuffer);
+		vkCmdEndRenderPass(commandBuffer);
+		vkEndCommandBuffer(commandBuffer);
 
 
 	}
 
-	void Application::DrawOntoScreen()
+	void Application::DrawOntoScreen(const SceneUniformData& sceneData)
 	{
-		m_RenderingContext->GetLogicalDevice()->BeginCommand(m_VKCommandBuffer);
+		// Waits for the GPU to finish with this frame slot, only after that can its part of the uniform ring be written
+		VkCommandBuffer commandBuffer = m_RenderingContext->GetLogicalDevice()->BeginCommand();
+		UpdateUniformBuffers(sceneData);
+
 		m_ImguiLayer->Begin();
-		RecordCommandBuffer(m_RenderingContext->GetLogicalDevice()->GetImageIndex());
+		RecordCommandBuffer(commandBuffer, m_RenderingContext->GetLogicalDevice()->GetImageIndex());
+
 
+		m_RenderingContext->GetLogicalDevice()->FlushOntoScreen(commandBuffer);
 
-		m_RenderingContext->GetLogicalDevice()->FlushOntoScreen(m_VKCommandBuffer);
+	}
 
+	void Application::UpdateUniformBuffers(const SceneUniformData& sceneData)
+	{
+		UniformRingBuffer::BeginFrame(m_RenderingContext->GetLogicalDevice()->GetCurrentFrameIndex());
+
+		// The sun comes from the scene's light entity
+		SceneUniformData frameData = sceneData;
+		m_Scene.ApplyLights(frameData);
+		m_SceneUniformOffset = UniformRingBuffer::Push(frameData);
+		UniformRingBuffer::Flush();
+
+		// Only the subtrees the client moved are recomputed
+		m_Scene.UpdateTransforms();
+
+		m_ObjectBufferOffset = GPUScene::Update(m_RenderingContext->GetLogicalDevice()->GetCurrentFrameIndex());
+		ClusterCuller::BeginFrame(sceneData);
+		LODSelector::BeginFrame(sceneData.View, m_Camera->GetCam().GetProj(), (float)m_SwapChain->GetExtent2D().height);
+		m_Scene.CollectRenderItems(m_Camera->GetCam().GetFrustum());
+		m_InstanceBufferOffset = InstanceBatcher::Build(m_RenderingContext->GetLogicalDevice()->GetCurrentFrameIndex(), m_Scene.GetRenderItems());
 	}
 
 	
@@ -498,23 +517,7 @@ namespace Rose
 	void Application::CleanUp()
 	{
 
-		for (auto& vbo : m_VBOs)
-		{
-			vbo->FreeMemory();
-		}
-		for (auto& ibo : m_IBOs)
-		{
-			ibo->FreeMemory();
-		}
-
-		for (auto& vbo : m_SphereVbo)
-		{
-			vbo->FreeMemory();
-		}
-		for (auto& ibo : m_SphereIbo)
-		{
-			ibo->FreeMemory();
-		}
+		m_GeometryPool->FreeMemory();
 
 		m_SkyboxVbo->FreeMemory();
 		//m_SkyboxIbo->FreeMemory();
@@ -529,10 +532,21 @@ namespace Rose
 
 
 		m_ImguiLayer->Shutdown();
-		m_TestModel->CleanUp();
-
-		m_SkyboxShader->DestroyPipeline();
+		for (auto& model : m_Models)
+			model->CleanUp();
+
+		m_SkyboxMaterial.Destroy();
+		Material::ReleaseDefaultTextures();
+		EnviormentTexture::Shutdown();
+		TextureCache::Shutdown();
+		InstanceBatcher::Shutdown();
+		ClusterCuller::Shutdown();
+		ShaderLibrary::Shutdown();
+		UniformRingBuffer::Shutdown();
+		GPUScene::Shutdown();
+		UploadManager::Shutdown();
 		VKMemAllocator::Shutdown();
+		JobSystem::Shutdown();
 
 		m_RenderingContext->GetLogicalDevice()->Shutdown();
 		m_RenderingContext->Shutdown();
@@ -551,17 +565,52 @@ namespace Rose
 	{
 		ImGui::Begin("Test window!");
 		ImGui::Text("This is some text");
-		ImGui::DragFloat3("model pos", &spherePos.x);
-		ImGui::DragFloat3("model rot", &sphereRot.x);
-		ImGui::DragFloat3("model scale", &sphereScale.x);
+		ImGui::SliderFloat("EnviormentMapIntensity", &EnviormentMapIntensity, 0.0f, 5.0f);
 		ImGui::NewLine();
-		ImGui::SliderFloat3("Dir light Direction", &DirLightDir.x, -1.0f, 1.0f);
-		ImGui::ColorEdit3("Dir light Color", &DirLightColor.x);
-		ImGui::DragFloat("Dir light Intensity", &DirLightIntensity);
+
+		const auto& cacheStats = ShaderCache::GetStats();
+		ImGui::Text("Shader cache: %d hits / %d misses", cacheStats.Hits, cacheStats.Misses);
+		ImGui::Text("Shader cache time saved: %.2fms", cacheStats.TimeSavedMs);
+		ImGui::Text("Uniform ring: %d / %d bytes this frame", UniformRingBuffer::GetFrameUsage(), UniformRingBuffer::GetFrameSize());
+		ImGui::Text("GPU scene: %d objects, %d materials, %d uploaded this frame", GPUScene::GetObjectCount(), GPUScene::GetMaterialCount(), GPUScene::GetLastUploadCount());
+		ImGui::Text("Geometry pool: %d / %d vertices, %d / %d index words, %d free blocks", m_GeometryPool->GetVertexAllocator().GetUsed(), m_GeometryPool->GetVertexAllocator().GetCapacity(),
+			m_GeometryPool->GetIndexAllocator().GetUsed(), m_GeometryPool->GetIndexAllocator().GetCapacity(), m_GeometryPool->GetIndexAllocator().GetFreeBlockCount());
+		float lodError = LODSelector::GetErrorThreshold();
+		if (ImGui::SliderFloat("LOD error (pixels)", &lodError, 0.1f, 16.0f))
+			LODSelector::SetErrorThreshold(lodError);
+		const auto& lodStats = LODSelector::GetStats();
+		ImGui::Text("LODs: %d / %d / %d / %d / %d objects, %d culled", lodStats.Objects[0], lodStats.Objects[1], lodStats.Objects[2], lodStats.Objects[3], lodStats.Objects[4], lodStats.Culled);
+		const auto& sceneStats = m_Scene.GetStats();
+		ImGui::Text("Scene: %d entities in %d archetypes", sceneStats.Entities, sceneStats.Archetypes);
+		ImGui::Text("Frustum culling: %d / %d mesh renderers visible, %.3fms (%s)", sceneStats.VisibleItems, sceneStats.MeshRenderers, sceneStats.CullTimeMs,
+			FrustumCuller::UsesAVX2() ? "AVX2" : "SSE");
+		const auto& graphStats = m_Scene.GetSceneGraph().GetStats();
+		ImGui::Text("Scene graph: %d nodes in %d levels, %d updated", graphStats.Nodes, graphStats.Levels, graphStats.UpdatedNodes);
+		const auto& instanceStats = InstanceBatcher::GetStats();
+		ImGui::Text("Instancing: %d / %d render items drawn in %d draws", instanceStats.Instances, instanceStats.Items, instanceStats.Batches);
+		const char* cullModes[] = { "None", "CPU", "GPU" };
+		int cullMode = (int)ClusterCuller::GetMode();
+		if (ImGui::Combo("Cluster culling", &cullMode, cullModes, 3))
+			ClusterCuller::SetMode((ClusterCullMode)cullMode);
+		const auto& cullStats = ClusterCuller::GetStats();
+		if (ClusterCuller::GetMode() == ClusterCullMode::GPU)
+			ImGui::Text("Clusters: %d culled on the GPU, %d indirect draws", cullStats.Clusters, cullStats.DrawCalls);
+		else
+			ImGui::Text("Clusters: %d / %d visible, %d draws, %d sub meshes culled", cullStats.VisibleClusters, cullStats.Clusters, cullStats.DrawCalls, cullStats.CulledSubMeshes);
+		ImGui::Text("Texture cache: %d live textures, %d hits / %d misses", TextureCache::GetLiveCount(), TextureCache::GetHits(), TextureCache::GetMisses());
+		ImGui::Text("Jobs: %d workers, %d jobs run, %d stolen", JobSystem::GetWorkerCount(), JobSystem::GetJobCount(), JobSystem::GetStealCount());
+		ImGui::Text("Uploads: %d batches, %d fence waits (%s queue)", UploadManager::GetStats().Batches, UploadManager::GetStats().Waits,
+			UploadManager::UsesTransferQueue() ? "transfer" : "graphics");
 		ImGui::NewLine();
-		ImGui::SliderFloat("EnviormentMapIntensity", &EnviormentMapIntensity, 0.0f, 5.0f);
+
+		for (auto& result : Profiler::GetResults())
+		{
+			ImGui::Text("%s: %.3fms total (%d calls, last %.3fms)", result.Name.c_str(), result.TotalMs, result.Count, result.LastMs);
+		}
 
 		ImGui::End();
+
+		OnImguiDraw();
 	}
 
 }
\ No newline at end of file
@@ -17,6 +17,8 @@
 #include "Rose/Renderer/SwapChain.h"
 #include "Rose/Renderer/API/Texture.h"
 #include "Rose/Renderer/Model.h"
+#include "Rose/Renderer/GeometryPool.h"
+#include "Rose/Scene/Scene.h"
 
 #include "Rose/Editor/ImguiLayer.h"
 
@@ -37,8 +39,9 @@ namespace Rose
 	class Application
 	{
 		public :
-			Application();
-			~Application();
+			// Every model is loaded in the geometry pool's vertex format. Full keeps float vertices, the packed formats are opt in
+			Application(VertexFormat geometryFormat = VertexFormat::Full);
+			virtual ~Application();
 
 
 			void Run();
@@ -62,12 +65,25 @@ namespace Rose
 
 			const std::shared_ptr<RendererContext>& GetContext() const { return m_RenderingContext; }
 
-			std::shared_ptr<Model>& GetTestModel() { return m_TestModel; }
+			// Every shader's render pass is compatible with the one frames are recorded into
+			VkRenderPass GetRenderPass() const { return m_SkyboxMaterial.ShaderData->GetRenderPass(); }
 
-			VkCommandBuffer& GetCommandBuffer() { return m_VKCommandBuffer; }
+			VkCommandBuffer GetCommandBuffer() { return m_RenderingContext->GetLogicalDevice()->GetCurrentFrame().CommandBuffer; }
 
 			std::vector<VkFramebuffer>& GetFramebuffers() { return m_Framebuffers; }
 
+		protected :
+			// The client fills the scene in here, right before the first frame
+			virtual void OnInit() {}
+			// Every frame before the scene is updated and drawn
+			virtual void OnUpdate(float timestep) {}
+			// Inside the frame's ImGui pass, after the renderer's stats window
+			virtual void OnImguiDraw() {}
+
+			// Loads the model in the pool's vertex format and registers it with the scene, the application keeps it alive
+			std::shared_ptr<Model> LoadModel(const std::string& filepath, bool isStatic = true);
+			Scene& GetScene() { return m_Scene; }
+
 		public :
 
 			static Application& Get() {
@@ -83,15 +99,17 @@ namespace Rose
 			void CreateGraphicsPipeline();
 			void CreateFramebuffers();
 
-			void CreateVertexBuffer();
-			void CreateIndexBuffer();
+			void CreateGeometry(VertexFormat format);
+			// Submits what OnInit() recorded and logs what was loaded
+			void OnSceneLoaded();
 
 			void CreateCommandPoolAndBuffer();
 
-			void RecordCommandBuffer(uint32_t imageIndex);
+			void RecordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex);
 
 
-			void DrawOntoScreen();
+			void DrawOntoScreen(const SceneUniformData& sceneData);
+			void UpdateUniformBuffers(const SceneUniformData& sceneData);
 
 
 			void CreateWinGLFWSurface();
@@ -109,28 +127,28 @@ namespace Rose
 
 
 
-			std::vector<std::shared_ptr<Rose::VertexBuffer>> m_VBOs;
-			std::vector<std::shared_ptr<Rose::IndexBuffer>> m_IBOs;
-
-
-			std::vector<std::shared_ptr<Rose::VertexBuffer>> m_SphereVbo;
-			std::vector<std::shared_ptr<Rose::IndexBuffer>> m_SphereIbo;
+			// Every model mesh lives in the pool, one range per mesh
+			std::shared_ptr<Rose::GeometryPool> m_GeometryPool;
 
 			std::shared_ptr<Rose::VertexBuffer> m_SkyboxVbo;
 			std::shared_ptr<Rose::IndexBuffer> m_SkyboxIbo;
-			std::shared_ptr<Rose::Shader> m_SkyboxShader;
-			std::vector<MaterialUniform> m_SkyboxUniforms;
+			Material m_SkyboxMaterial;
+
+			// Dynamic offsets into the UniformRingBuffer and GPUScene for the frame being recorded
+			uint32_t m_SceneUniformOffset = 0;
+			uint32_t m_ObjectBufferOffset = 0;
+			uint32_t m_InstanceBufferOffset = 0;
 
+			// Everything drawn besides the skybox, filled in by the client
+			Scene m_Scene;
 
 			std::shared_ptr<Rose::PerspectiveCameraController> m_Camera;
 
 
 			std::vector<VkFramebuffer> m_Framebuffers;
 
-			VkCommandBuffer m_VKCommandBuffer;
-
-			std::shared_ptr<Model> m_TestModel;
-			std::shared_ptr<Model> m_SphereModel;
+			// Registered with the scene by LoadModel(), they have to outlive it
+			std::vector<std::shared_ptr<Model>> m_Models;
 
 
 			static Application* s_INSTANCE;
@@ -0,0 +1,106 @@
+#include "FreeListAllocator.h"
+
+#include "Log.h"
+
+namespace Rose
+{
+
+	FreeListAllocator::FreeListAllocator(uint32_t capacity)
+	{
+		Reset(capacity);
+	}
+
+	void FreeListAllocator::Reset(uint32_t capacity)
+	{
+		m_FreeByOffset.clear();
+		m_FreeBySize.clear();
+
+		m_Capacity = capacity;
+		m_Used = 0;
+		if (capacity)
+			AddFreeBlock(0, capacity);
+	}
+
+	bool FreeListAllocator::Allocate(uint32_t size, uint32_t& outOffset)
+	{
+		if (size == 0)
+		{
+			outOffset = 0;
+			return true;
+		}
+
+		auto fit = m_FreeBySize.lower_bound(size);
+		if (fit == m_FreeBySize.end())
+			return false;
+
+		uint32_t blockOffset = fit->second;
+		uint32_t blockSize = fit->first;
+		RemoveFreeBlock(m_FreeByOffset.find(blockOffset));
+
+		// The rest of the block stays free
+		if (blockSize > size)
+			AddFreeBlock(blockOffset + size, blockSize - size);
+
+		m_Used += size;
+		outOffset = blockOffset;
+		return true;
+	}
+
+	void FreeListAllocator::Free(uint32_t offset, uint32_t size)
+	{
+		if (size == 0)
+			return;
+
+		if (offset + size > m_Capacity)
+		{
+			LOG("Freeing a range outside of the allocator!\n");
+			ASSERT();
+			return;
+		}
+		m_Used -= size;
+
+		// Merge with the free block right after
+		auto next = m_FreeByOffset.lower_bound(offset);
+		if (next != m_FreeByOffset.end() && next->first == offset + size)
+		{
+			size += next->second;
+			RemoveFreeBlock(next);
+		}
+
+		// And the one right before
+		auto previous = m_FreeByOffset.lower_bound(offset);
+		if (previous != m_FreeByOffset.begin())
+		{
+			previous--;
+			if (previous->first + previous->second == offset)
+			{
+				offset = previous->first;
+				size += previous->second;
+				RemoveFreeBlock(previous);
+			}
+		}
+
+		AddFreeBlock(offset, size);
+	}
+
+	void FreeListAllocator::AddFreeBlock(uint32_t offset, uint32_t size)
+	{
+		m_FreeByOffset[offset] = size;
+		m_FreeBySize.insert({ size, offset });
+	}
+
+	void FreeListAllocator::RemoveFreeBlock(std::map<uint32_t, uint32_t>::iterator block)
+	{
+		auto range = m_FreeBySize.equal_range(block->second);
+		for (auto it = range.first; it != range.second; it++)
+		{
+			if (it->second == block->first)
+			{
+				m_FreeBySize.erase(it);
+				break;
+			}
+		}
+		m_FreeByOffset.erase(block);
+	}
+
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+
+namespace Rose
+{
+
+	// Hands out ranges of [0, capacity) in whatever unit the owner uses (bytes, vertices, ...). Only bookkeeping, never touches memory.
+	// Free blocks are kept by offset so freeing merges with both neighbours, and by size so allocating is a best fit lookup.
+	class FreeListAllocator
+	{
+		public :
+			FreeListAllocator(uint32_t capacity = 0);
+
+			// Forgets every allocation
+			void Reset(uint32_t capacity);
+
+			// False when no free block is big enough, which can happen before the allocator is full if it's fragmented
+			bool Allocate(uint32_t size, uint32_t& outOffset);
+			void Free(uint32_t offset, uint32_t size);
+
+			uint32_t GetCapacity() const { return m_Capacity; }
+			uint32_t GetUsed() const { return m_Used; }
+			uint32_t GetFreeBlockCount() const { return (uint32_t)m_FreeByOffset.size(); }
+			uint32_t GetLargestFreeBlock() const { return m_FreeBySize.empty() ? 0 : m_FreeBySize.rbegin()->first; }
+
+		private :
+			void AddFreeBlock(uint32_t offset, uint32_t size);
+			void RemoveFreeBlock(std::map<uint32_t, uint32_t>::iterator block);
+
+		private :
+			std::map<uint32_t, uint32_t> m_FreeByOffset; // Offset -> size
+			std::multimap<uint32_t, uint32_t> m_FreeBySize; // Size -> offset
+
+			uint32_t m_Capacity = 0;
+			uint32_t m_Used = 0;
+	};
+
+}
@@ -0,0 +1,269 @@
+#include "JobSystem.h"
+
+#include "Log.h"
+
+#include <algorithm>
+#include <deque>
+
+namespace Rose
+{
+
+	struct JobSystem::JobQueue
+	{
+		std::mutex Mutex;
+		std::deque<Job> Jobs;
+	};
+
+	std::vector<JobSystem::JobQueue*> JobSystem::s_Queues;
+	std::vector<std::thread> JobSystem::s_Workers;
+
+	std::mutex JobSystem::s_MainThreadMutex;
+	std::vector<Job> JobSystem::s_MainThreadJobs;
+
+	std::mutex JobSystem::s_SleepMutex;
+	std::condition_variable JobSystem::s_WakeCondition;
+	std::atomic<uint32_t> JobSystem::s_PendingJobs{ 0 };
+	std::atomic<bool> JobSystem::s_Running{ false };
+
+	std::atomic<uint32_t> JobSystem::s_Steals{ 0 };
+	std::atomic<uint32_t> JobSystem::s_JobsRun{ 0 };
+
+	static std::thread::id s_MainThreadID;
+	// Index of the deque owned by the calling thread, threads the system didn't create share the main thread's
+	static thread_local uint32_t s_QueueIndex = 0;
+
+
+	void JobSystem::Init(uint32_t workerCount)
+	{
+		s_MainThreadID = std::this_thread::get_id();
+		s_QueueIndex = 0;
+
+		if (!workerCount)
+		{
+			uint32_t hardwareThreads = std::thread::hardware_concurrency();
+			workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+		}
+
+		for (uint32_t i = 0; i < workerCount + 1; i++)
+			s_Queues.push_back(new JobQueue);
+
+		s_Running = true;
+		for (uint32_t i = 0; i < workerCount; i++)
+			s_Workers.emplace_back(&JobSystem::WorkerLoop, i + 1);
+
+		LOG("Job system started with %d worker threads\n", workerCount);
+	}
+
+	void JobSystem::Shutdown()
+	{
+		// Nothing is dropped, whatever is still queued runs before the workers go away
+		while (s_PendingJobs.load(std::memory_order_acquire))
+		{
+			if (!TryRunOne())
+				std::this_thread::yield();
+		}
+		ProcessMainThreadJobs();
+
+		{
+			std::lock_guard<std::mutex> lock(s_SleepMutex);
+			s_Running = false;
+		}
+		s_WakeCondition.notify_all();
+
+		for (auto& worker : s_Workers)
+			worker.join();
+		s_Workers.clear();
+
+		for (auto queue : s_Queues)
+			delete queue;
+		s_Queues.clear();
+	}
+
+	void JobSystem::Run(const JobFunction& function, JobCounter* counter)
+	{
+		if (counter)
+			counter->Value.fetch_add(1, std::memory_order_relaxed);
+
+		Schedule({ function, counter });
+	}
+
+	void JobSystem::RunAfter(JobCounter& dependency, const JobFunction& function, JobCounter* counter)
+	{
+		// Counted right away, so waiting on counter also covers jobs that aren't scheduled yet
+		if (counter)
+			counter->Value.fetch_add(1, std::memory_order_relaxed);
+
+		{
+			std::lock_guard<std::mutex> lock(dependency.m_Mutex);
+			if (!dependency.IsDone())
+			{
+				dependency.m_Dependents.push_back({ function, counter });
+				return;
+			}
+		}
+
+		Schedule({ function, counter });
+	}
+
+	void JobSystem::ParallelFor(uint32_t count, uint32_t batchSize, const std::function<void(uint32_t, uint32_t)>& function, JobCounter* counter)
+	{
+		if (!batchSize)
+			batchSize = 1;
+
+		for (uint32_t start = 0; start < count; start += batchSize)
+		{
+			uint32_t end = std::min(start + batchSize, count);
+			Run([function, start, end]() { function(start, end); }, counter);
+		}
+	}
+
+	void JobSystem::Wait(JobCounter& counter)
+	{
+		bool isMainThread = IsMainThread();
+		while (!counter.IsDone())
+		{
+			// The jobs we wait on may need the main thread
+			if (isMainThread)
+				ProcessMainThreadJobs();
+
+			if (!TryRunOne())
+				std::this_thread::yield();
+		}
+
+		std::lock_guard<std::mutex> lock(counter.m_Mutex);
+	}
+
+	void JobSystem::RunOnMainThread(const JobFunction& function, JobCounter* counter)
+	{
+		if (counter)
+			counter->Value.fetch_add(1, std::memory_order_relaxed);
+
+		std::lock_guard<std::mutex> lock(s_MainThreadMutex);
+		s_MainThreadJobs.push_back({ function, counter });
+	}
+
+	void JobSystem::ProcessMainThreadJobs()
+	{
+		std::vector<Job> jobs;
+		{
+			std::lock_guard<std::mutex> lock(s_MainThreadMutex);
+			jobs.swap(s_MainThreadJobs);
+		}
+
+		for (auto& job : jobs)
+			Execute(job);
+	}
+
+	bool JobSystem::IsMainThread()
+	{
+		return std::this_thread::get_id() == s_MainThreadID;
+	}
+
+	void JobSystem::Schedule(Job&& job)
+	{
+		// Before Init everything simply runs inline
+		if (s_Queues.empty())
+		{
+			Execute(job);
+			return;
+		}
+
+		// Counted before it is visible so the count never drops below the number of queued jobs
+		s_PendingJobs.fetch_add(1, std::memory_order_release);
+
+		JobQueue* queue = s_Queues[s_QueueIndex];
+		{
+			std::lock_guard<std::mutex> lock(queue->Mutex);
+			queue->Jobs.push_back(std::move(job));
+		}
+
+		// Taking the lock makes sure a worker can't miss the wake up between checking for work and going to sleep
+		{
+			std::lock_guard<std::mutex> lock(s_SleepMutex);
+		}
+		s_WakeCondition.notify_one();
+	}
+
+	bool JobSystem::TryRunOne()
+	{
+		if (s_Queues.empty())
+			return false;
+
+		Job job;
+		bool found = false;
+
+		// Own jobs first, newest first since their data is most likely still in cache
+		{
+			JobQueue* queue = s_Queues[s_QueueIndex];
+			std::lock_guard<std::mutex> lock(queue->Mutex);
+			if (!queue->Jobs.empty())
+			{
+				job = std::move(queue->Jobs.back());
+				queue->Jobs.pop_back();
+				found = true;
+			}
+		}
+
+		// Steal the oldest job of someone else, those tend to be the biggest chunks of work
+		for (uint32_t i = 1; i < s_Queues.size() && !found; i++)
+		{
+			JobQueue* queue = s_Queues[(s_QueueIndex + i) % s_Queues.size()];
+			std::lock_guard<std::mutex> lock(queue->Mutex);
+			if (!queue->Jobs.empty())
+			{
+				job = std::move(queue->Jobs.front());
+				queue->Jobs.pop_front();
+				found = true;
+				s_Steals.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+
+		if (!found)
+			return false;
+
+		s_PendingJobs.fetch_sub(1, std::memory_order_acq_rel);
+		Execute(job);
+		return true;
+	}
+
+	void JobSystem::Execute(Job& job)
+	{
+		job.Function();
+		s_JobsRun.fetch_add(1, std::memory_order_relaxed);
+
+		if (job.Counter)
+			ReleaseCounter(*job.Counter);
+	}
+
+	void JobSystem::ReleaseCounter(JobCounter& counter)
+	{
+		// The counter is only touched while its lock is held, Wait takes the same lock before returning so the waiter can't free it under us
+		std::vector<Job> dependents;
+		{
+			std::lock_guard<std::mutex> lock(counter.m_Mutex);
+			if (counter.Value.fetch_sub(1, std::memory_order_acq_rel) == 1)
+				dependents.swap(counter.m_Dependents);
+		}
+
+		for (auto& job : dependents)
+			Schedule(std::move(job));
+	}
+
+	void JobSystem::WorkerLoop(uint32_t queueIndex)
+	{
+		s_QueueIndex = queueIndex;
+
+		while (true)
+		{
+			if (TryRunOne())
+				continue;
+
+			std::unique_lock<std::mutex> lock(s_SleepMutex);
+			s_WakeCondition.wait(lock, []() { return s_PendingJobs.load(std::memory_order_acquire) > 0 || !s_Running; });
+
+			if (!s_Running && !s_PendingJobs.load(std::memory_order_acquire))
+				break;
+		}
+	}
+
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Rose
+{
+
+	using JobFunction = std::function<void()>;
+
+	struct JobCounter;
+
+	struct Job
+	{
+		JobFunction Function;
+		JobCounter* Counter = nullptr; // Decremented once the job has run, can be null
+	};
+
+	// Counts the jobs that are still queued or running. Jobs can be made to wait on a counter with JobSystem::RunAfter,
+	// and any thread can wait on it with JobSystem::Wait.
+	struct JobCounter
+	{
+		std::atomic<uint32_t> Value{ 0 };
+
+		bool IsDone() const { return Value.load(std::memory_order_acquire) == 0; }
+
+		private :
+			std::mutex m_Mutex;
+			std::vector<Job> m_Dependents; // Scheduled when Value reaches 0
+
+			friend class JobSystem;
+	};
+
+	// A work stealing scheduler. Every worker (and the main thread) owns a deque,
+	// it pushes and pops its own jobs at the back and steals from the front of the others when it runs dry.
+	// Vulkan calls that have to stay on the main thread go through RunOnMainThread and run in ProcessMainThreadJobs.
+	class JobSystem
+	{
+		public :
+			// 0 uses one worker per hardware thread minus the main thread
+			static void Init(uint32_t workerCount = 0);
+			static void Shutdown();
+
+			static void Run(const JobFunction& function, JobCounter* counter = nullptr);
+			// Runs the job once dependency reaches 0
+			static void RunAfter(JobCounter& dependency, const JobFunction& function, JobCounter* counter = nullptr);
+			// Splits [0, count) into jobs of at most batchSize, calls function(start, end) for each
+			static void ParallelFor(uint32_t count, uint32_t batchSize, const std::function<void(uint32_t, uint32_t)>& function, JobCounter* counter);
+
+			// Runs other jobs until the counter reaches 0, never just blocks
+			static void Wait(JobCounter& counter);
+
+			static void RunOnMainThread(const JobFunction& function, JobCounter* counter = nullptr);
+			// Runs everything queued with RunOnMainThread, only call from the main thread
+			static void ProcessMainThreadJobs();
+
+			static bool IsMainThread();
+			static uint32_t GetWorkerCount() { return (uint32_t)s_Workers.size(); }
+			static uint32_t GetStealCount() { return s_Steals.load(std::memory_order_relaxed); }
+			static uint32_t GetJobCount() { return s_JobsRun.load(std::memory_order_relaxed); }
+
+		private :
+			static void Schedule(Job&& job);
+			static bool TryRunOne();
+			static void Execute(Job& job);
+			static void WorkerLoop(uint32_t queueIndex);
+			static void ReleaseCounter(JobCounter& counter);
+
+		private :
+			struct JobQueue;
+
+			static std::vector<JobQueue*> s_Queues; // 0 belongs to the main thread
+			static std::vector<std::thread> s_Workers;
+
+			static std::mutex s_MainThreadMutex;
+			static std::vector<Job> s_MainThreadJobs;
+
+			static std::mutex s_SleepMutex;
+			static std::condition_variable s_WakeCondition;
+			static std::atomic<uint32_t> s_PendingJobs;
+			static std::atomic<bool> s_Running;
+
+			static std::atomic<uint32_t> s_Steals;
+			static std::atomic<uint32_t> s_JobsRun;
+	};
+
+}
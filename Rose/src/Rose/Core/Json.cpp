@@ -0,0 +1,318 @@
+#include "Json.h"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace Rose
+{
+
+	static const JsonValue s_NullValue;
+
+	// Recursive descent over the whole text, fails on the first malformed token
+	struct JsonParser
+	{
+		const char* Current;
+		const char* End;
+		uint32_t Depth = 0;
+
+		static const uint32_t MaxDepth = 256;
+
+		void SkipWhitespace()
+		{
+			while (Current < End && (*Current == ' ' || *Current == '\t' || *Current == '\n' || *Current == '\r'))
+				Current++;
+		}
+
+		bool Match(const char* literal)
+		{
+			size_t length = strlen(literal);
+			if ((size_t)(End - Current) < length || strncmp(Current, literal, length) != 0)
+				return false;
+
+			Current += length;
+			return true;
+		}
+
+		bool ParseValue(JsonValue& value)
+		{
+			SkipWhitespace();
+			if (Current >= End)
+				return false;
+
+			switch (*Current)
+			{
+				case '{': return ParseObject(value);
+				case '[': return ParseArray(value);
+				case '"': value.m_Type = JsonValue::Type::String; return ParseString(value.m_String);
+				case 't': value.m_Type = JsonValue::Type::Bool; value.m_Bool = true; return Match("true");
+				case 'f': value.m_Type = JsonValue::Type::Bool; value.m_Bool = false; return Match("false");
+				case 'n': value.m_Type = JsonValue::Type::Null; return Match("null");
+				default: return ParseNumber(value);
+			}
+		}
+
+		bool ParseNumber(JsonValue& value)
+		{
+			// strtod needs a terminator, numbers are short so a local copy is enough
+			char buffer[64];
+			size_t length = 0;
+			while (Current + length < End && length < sizeof(buffer) - 1 && strchr("+-0123456789.eE", Current[length]))
+				length++;
+
+			if (!length)
+				return false;
+
+			memcpy(buffer, Current, length);
+			buffer[length] = 0;
+
+			char* parsedEnd;
+			value.m_Type = JsonValue::Type::Number;
+			value.m_Number = strtod(buffer, &parsedEnd);
+			if (parsedEnd != buffer + length)
+				return false;
+
+			Current += length;
+			return true;
+		}
+
+		static void AppendUTF8(std::string& out, uint32_t codepoint)
+		{
+			if (codepoint < 0x80)
+			{
+				out += (char)codepoint;
+			}
+			else if (codepoint < 0x800)
+			{
+				out += (char)(0xC0 | (codepoint >> 6));
+				out += (char)(0x80 | (codepoint & 0x3F));
+			}
+			else if (codepoint < 0x10000)
+			{
+				out += (char)(0xE0 | (codepoint >> 12));
+				out += (char)(0x80 | ((codepoint >> 6) & 0x3F));
+				out += (char)(0x80 | (codepoint & 0x3F));
+			}
+			else
+			{
+				out += (char)(0xF0 | (codepoint >> 18));
+				out += (char)(0x80 | ((codepoint >> 12) & 0x3F));
+				out += (char)(0x80 | ((codepoint >> 6) & 0x3F));
+				out += (char)(0x80 | (codepoint & 0x3F));
+			}
+		}
+
+		bool ParseHex4(uint32_t& outValue)
+		{
+			if (End - Current < 4)
+				return false;
+
+			outValue = 0;
+			for (int i = 0; i < 4; i++)
+			{
+				char c = *Current++;
+				outValue <<= 4;
+				if (c >= '0' && c <= '9')
+					outValue |= c - '0';
+				else if (c >= 'a' && c <= 'f')
+					outValue |= c - 'a' + 10;
+				else if (c >= 'A' && c <= 'F')
+					outValue |= c - 'A' + 10;
+				else
+					return false;
+			}
+			return true;
+		}
+
+		bool ParseString(std::string& out)
+		{
+			Current++; // Opening quote
+			while (Current < End)
+			{
+				char c = *Current++;
+				if (c == '"')
+					return true;
+
+				if (c != '\\')
+				{
+					out += c;
+					continue;
+				}
+
+				if (Current >= End)
+					return false;
+
+				char escape = *Current++;
+				switch (escape)
+				{
+					case '"': out += '"'; break;
+					case '\\': out += '\\'; break;
+					case '/': out += '/'; break;
+					case 'b': out += '\b'; break;
+					case 'f': out += '\f'; break;
+					case 'n': out += '\n'; break;
+					case 'r': out += '\r'; break;
+					case 't': out += '\t'; break;
+					case 'u':
+					{
+						uint32_t codepoint;
+						if (!ParseHex4(codepoint))
+							return false;
+
+						// Surrogate pair
+						if (codepoint >= 0xD800 && codepoint < 0xDC00 && Match("\\u"))
+						{
+							uint32_t low;
+							if (!ParseHex4(low))
+								return false;
+							codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+						}
+
+						AppendUTF8(out, codepoint);
+						break;
+					}
+					default: return false;
+				}
+			}
+			return false;
+		}
+
+		bool ParseArray(JsonValue& value)
+		{
+			if (++Depth > MaxDepth)
+				return false;
+
+			Current++;
+			value.m_Type = JsonValue::Type::Array;
+
+			SkipWhitespace();
+			if (Current < End && *Current == ']')
+			{
+				Current++;
+				Depth--;
+				return true;
+			}
+
+			while (true)
+			{
+				value.m_Elements.emplace_back();
+				if (!ParseValue(value.m_Elements.back()))
+					return false;
+
+				SkipWhitespace();
+				if (Current >= End)
+					return false;
+
+				char c = *Current++;
+				if (c == ']')
+					break;
+				if (c != ',')
+					return false;
+			}
+
+			Depth--;
+			return true;
+		}
+
+		bool ParseObject(JsonValue& value)
+		{
+			if (++Depth > MaxDepth)
+				return false;
+
+			Current++;
+			value.m_Type = JsonValue::Type::Object;
+
+			SkipWhitespace();
+			if (Current < End && *Current == '}')
+			{
+				Current++;
+				Depth--;
+				return true;
+			}
+
+			while (true)
+			{
+				SkipWhitespace();
+				if (Current >= End || *Current != '"')
+					return false;
+
+				value.m_Members.emplace_back();
+				auto& member = value.m_Members.back();
+				if (!ParseString(member.first))
+					return false;
+
+				SkipWhitespace();
+				if (Current >= End || *Current++ != ':')
+					return false;
+
+				if (!ParseValue(member.second))
+					return false;
+
+				SkipWhitespace();
+				if (Current >= End)
+					return false;
+
+				char c = *Current++;
+				if (c == '}')
+					break;
+				if (c != ',')
+					return false;
+			}
+
+			Depth--;
+			return true;
+		}
+	};
+
+
+	bool JsonValue::Parse(const char* text, size_t size, JsonValue& outValue)
+	{
+		JsonParser parser = { text, text + size };
+
+		JsonValue value;
+		if (!parser.ParseValue(value))
+			return false;
+
+		parser.SkipWhitespace();
+		if (parser.Current != parser.End)
+			return false;
+
+		outValue = std::move(value);
+		return true;
+	}
+
+	size_t JsonValue::Size() const
+	{
+		if (m_Type == Type::Array)
+			return m_Elements.size();
+		if (m_Type == Type::Object)
+			return m_Members.size();
+		return 0;
+	}
+
+	bool JsonValue::Contains(const char* key) const
+	{
+		return &(*this)[key] != &s_NullValue;
+	}
+
+	const JsonValue& JsonValue::operator[](size_t index) const
+	{
+		if (m_Type != Type::Array || index >= m_Elements.size())
+			return s_NullValue;
+
+		return m_Elements[index];
+	}
+
+	const JsonValue& JsonValue::operator[](const char* key) const
+	{
+		if (m_Type != Type::Object)
+			return s_NullValue;
+
+		for (auto& member : m_Members)
+		{
+			if (member.first == key)
+				return member.second;
+		}
+		return s_NullValue;
+	}
+
+}
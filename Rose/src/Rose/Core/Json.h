@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <utility>
+
+namespace Rose
+{
+
+	// Minimal read only DOM, enough for asset formats like glTF. Missing keys and out of range indices return a null value
+	// so lookups can be chained without checking every step.
+	class JsonValue
+	{
+		public :
+			enum class Type
+			{
+				Null, Bool, Number, String, Array, Object
+			};
+
+			static bool Parse(const char* text, size_t size, JsonValue& outValue);
+
+			Type GetType() const { return m_Type; }
+			bool IsNull() const { return m_Type == Type::Null; }
+			bool IsArray() const { return m_Type == Type::Array; }
+			bool IsObject() const { return m_Type == Type::Object; }
+
+			bool AsBool(bool fallback = false) const { return m_Type == Type::Bool ? m_Bool : fallback; }
+			double AsNumber(double fallback = 0.0) const { return m_Type == Type::Number ? m_Number : fallback; }
+			float AsFloat(float fallback = 0.0f) const { return (float)AsNumber(fallback); }
+			uint32_t AsUInt(uint32_t fallback = 0) const { return m_Type == Type::Number ? (uint32_t)m_Number : fallback; }
+			const std::string& AsString() const { return m_String; }
+
+			// Elements of an array or members of an object
+			size_t Size() const;
+			bool Contains(const char* key) const;
+
+			const JsonValue& operator[](size_t index) const;
+			const JsonValue& operator[](const char* key) const;
+
+			const std::vector<std::pair<std::string, JsonValue>>& GetMembers() const { return m_Members; }
+
+		private :
+			Type m_Type = Type::Null;
+			bool m_Bool = false;
+			double m_Number = 0.0;
+			std::string m_String;
+			std::vector<JsonValue> m_Elements;
+			std::vector<std::pair<std::string, JsonValue>> m_Members;
+
+			friend struct JsonParser;
+	};
+
+}
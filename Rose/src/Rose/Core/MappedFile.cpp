@@ -0,0 +1,96 @@
+#include "MappedFile.h"
+
+#include "Log.h"
+
+#ifdef RS_PLATFORM_WINDOWS
+	#include <Windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+namespace Rose
+{
+
+#ifdef RS_PLATFORM_WINDOWS
+
+	MappedFile::MappedFile(const std::string& filepath)
+	{
+		HANDLE file = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+			return;
+
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+		{
+			CloseHandle(file);
+			return;
+		}
+
+		HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (!mapping)
+		{
+			CloseHandle(file);
+			return;
+		}
+
+		void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		if (!data)
+		{
+			CloseHandle(mapping);
+			CloseHandle(file);
+			return;
+		}
+
+		m_FileHandle = file;
+		m_MappingHandle = mapping;
+		m_Data = (const uint8_t*)data;
+		m_Size = (size_t)size.QuadPart;
+	}
+
+	MappedFile::~MappedFile()
+	{
+		if (m_Data)
+			UnmapViewOfFile(m_Data);
+		if (m_MappingHandle)
+			CloseHandle((HANDLE)m_MappingHandle);
+		if (m_FileHandle)
+			CloseHandle((HANDLE)m_FileHandle);
+	}
+
+#else
+
+	MappedFile::MappedFile(const std::string& filepath)
+	{
+		int file = open(filepath.c_str(), O_RDONLY);
+		if (file < 0)
+			return;
+
+		struct stat info;
+		if (fstat(file, &info) != 0 || info.st_size == 0)
+		{
+			close(file);
+			return;
+		}
+
+		void* data = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+		// The mapping keeps the file alive on its own
+		close(file);
+		if (data == MAP_FAILED)
+			return;
+
+		m_Data = (const uint8_t*)data;
+		m_Size = (size_t)info.st_size;
+	}
+
+	MappedFile::~MappedFile()
+	{
+		if (m_Data)
+			munmap((void*)m_Data, m_Size);
+	}
+
+#endif
+
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+
+namespace Rose
+{
+
+	// Read only memory mapping of a whole file, unmapped when it goes out of scope
+	class MappedFile
+	{
+		public :
+			MappedFile(const std::string& filepath);
+			~MappedFile();
+
+			MappedFile(const MappedFile&) = delete;
+			MappedFile& operator=(const MappedFile&) = delete;
+
+			bool IsValid() const { return m_Data != nullptr; }
+			const uint8_t* GetData() const { return m_Data; }
+			size_t GetSize() const { return m_Size; }
+
+		private :
+			const uint8_t* m_Data = nullptr;
+			size_t m_Size = 0;
+
+			void* m_FileHandle = nullptr;
+			void* m_MappingHandle = nullptr;
+	};
+
+}
@@ -0,0 +1,25 @@
+#include "Profiler.h"
+
+namespace Rose
+{
+
+	std::vector<ProfileResult> Profiler::s_Results;
+
+
+	void Profiler::Record(const std::string& name, float ms)
+	{
+		for (auto& result : s_Results)
+		{
+			if (result.Name == name)
+			{
+				result.TotalMs += ms;
+				result.LastMs = ms;
+				result.Count++;
+				return;
+			}
+		}
+
+		s_Results.push_back({ name, ms, ms, 1 });
+	}
+
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Timer.h"
+
+namespace Rose
+{
+
+	struct ProfileResult
+	{
+		std::string Name;
+		float TotalMs = 0.0f;
+		float LastMs = 0.0f;
+		uint32_t Count = 0;
+	};
+
+	// Accumulates named timings so they can be inspected from the debug window.
+	// Not thread safe, only record from the main thread.
+	class Profiler
+	{
+		public :
+			static void Record(const std::string& name, float ms);
+
+			static const std::vector<ProfileResult>& GetResults() { return s_Results; }
+
+		private :
+			static std::vector<ProfileResult> s_Results;
+	};
+
+
+	class ScopedProfile
+	{
+		public :
+			ScopedProfile(const std::string& name) : m_Name(name) {}
+			~ScopedProfile() { Profiler::Record(m_Name, m_Timer.ElapsedMillis()); }
+
+		private :
+			std::string m_Name;
+			Timer m_Timer;
+	};
+
+}
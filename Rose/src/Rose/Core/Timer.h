@@ -0,0 +1,24 @@
+#pragma once
+
+#include <chrono>
+
+namespace Rose
+{
+
+	class Timer
+	{
+		public :
+			Timer() { Reset(); }
+
+			void Reset() { m_Start = std::chrono::high_resolution_clock::now(); }
+
+			float ElapsedMillis() const
+			{
+				return std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - m_Start).count();
+			}
+
+		private :
+			std::chrono::time_point<std::chrono::high_resolution_clock> m_Start;
+	};
+
+}
@@ -85,7 +85,7 @@ namespace Rose
 		init_info.Device = context->GetLogicalDevice()->GetDevice();
 		init_info.QueueFamily = context->GetPhysicalDevice()->GetQueueFamily().Graphics;
 		init_info.Queue = context->GetLogicalDevice()->GetQueue();
-		init_info.PipelineCache = nullptr;
+		init_info.PipelineCache = context->GetLogicalDevice()->GetPipelineCache();
 		init_info.DescriptorPool = descriptorPool;
 		init_info.Subpass = 0;
 		init_info.MinImageCount = 2;
@@ -93,13 +93,13 @@ namespace Rose
 		init_info.MSAASamples = context->GetPhysicalDevice()->GetMSAASampleCount();
 		init_info.Allocator = nullptr;
 		init_info.CheckVkResultFn = check_vk_result;
-		ImGui_ImplVulkan_Init(&init_info, Application::Get().GetTestModel()->GetMaterials()[0].ShaderData->GetRenderPass());
+		ImGui_ImplVulkan_Init(&init_info, Application::Get().GetRenderPass());
 
 
 		// Upload Fonts
 		{
 			// Use any command queue
-			VkCommandPool command_pool = Application::Get().GetContext()->GetLogicalDevice()->GetCommandPool();
+			VkCommandPool command_pool = Application::Get().GetContext()->GetLogicalDevice()->GetCurrentFrame().CommandPool;
 			VkCommandBuffer command_buffer = Application::Get().GetCommandBuffer();
 
 			vkResetCommandPool(Application::Get().GetContext()->GetLogicalDevice()->GetDevice(), command_pool, 0);
@@ -3,6 +3,7 @@
 
 #include "Rose/Core/Log.h"
 #include "Rose/Core/Application.h"
+#include "UploadManager.h"
 
 namespace Rose
 {
@@ -73,22 +74,8 @@ namespace Rose
 
 	void Image::TransitionLayout(VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, bool cube)
 	{
-		
-		auto& device = Application::Get().GetContext()->GetLogicalDevice();
-		VkCommandBufferAllocateInfo allocInfo{};
-		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-		allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-		allocInfo.commandPool = device->GetCommandPool();
-		allocInfo.commandBufferCount = 1;
-
-		VkCommandBuffer commandBuffer;
-		vkAllocateCommandBuffers(device->GetDevice(), &allocInfo, &commandBuffer);
-
-		VkCommandBufferBeginInfo beginInfo{};
-		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-
-		vkBeginCommandBuffer(commandBuffer, &beginInfo);
+		// Recorded into the current upload batch, the UploadManager submits it
+		VkCommandBuffer commandBuffer = UploadManager::GetCommandBuffer();
 
 
 		VkImageMemoryBarrier barrier{};
@@ -143,44 +130,16 @@ namespace Rose
 
 		vkCmdPipelineBarrier(commandBuffer, sourceStage, destinationStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
 
-
-		vkEndCommandBuffer(commandBuffer);
-
-		VkSubmitInfo submitInfo{};
-		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-		submitInfo.commandBufferCount = 1;
-		submitInfo.pCommandBuffers = &commandBuffer;
-
-		vkQueueSubmit(device->GetQueue(), 1, &submitInfo, VK_NULL_HANDLE);
-		vkQueueWaitIdle(device->GetQueue());
-
-		vkFreeCommandBuffers(device->GetDevice(), device->GetCommandPool(), 1, &commandBuffer);
-
-
 	}
 
-	void Image::CopyBufferToImage(VkBuffer srcBuffer, int width, int height)
+	void Image::CopyBufferToImage(VkBuffer srcBuffer, int width, int height, VkDeviceSize bufferOffset)
 	{
 
-		auto& device = Application::Get().GetContext()->GetLogicalDevice();
-		VkCommandBufferAllocateInfo allocInfo{};
-		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-		allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-		allocInfo.commandPool = device->GetCommandPool();
-		allocInfo.commandBufferCount = 1;
-
-		VkCommandBuffer commandBuffer;
-		vkAllocateCommandBuffers(device->GetDevice(), &allocInfo, &commandBuffer);
-
-		VkCommandBufferBeginInfo beginInfo{};
-		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-
-		vkBeginCommandBuffer(commandBuffer, &beginInfo);
+		VkCommandBuffer commandBuffer = UploadManager::GetCommandBuffer();
 
 
 		VkBufferImageCopy region{};
-		region.bufferOffset = 0;
+		region.bufferOffset = bufferOffset;
 		region.bufferRowLength = 0;
 		region.bufferImageHeight = 0;
 
@@ -199,19 +158,6 @@ namespace Rose
 
 		vkCmdCopyBufferToImage(commandBuffer, srcBuffer, m_BufferID, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
 
-
-		vkEndCommandBuffer(commandBuffer);
-
-		VkSubmitInfo submitInfo{};
-		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-		submitInfo.commandBufferCount = 1;
-		submitInfo.pCommandBuffers = &commandBuffer;
-
-		vkQueueSubmit(device->GetQueue(), 1, &submitInfo, VK_NULL_HANDLE);
-		vkQueueWaitIdle(device->GetQueue());
-
-		vkFreeCommandBuffers(device->GetDevice(), device->GetCommandPool(), 1, &commandBuffer);
-
 	}
 
 	void Image::CreateImageViews(VkFormat format, uint32_t amount)
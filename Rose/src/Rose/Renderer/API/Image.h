@@ -20,8 +20,9 @@ namespace Rose
 			const VkImage& GetImageBuffer() const { return m_BufferID; }
 			VkImage& GetImageBuffer() { return m_BufferID; }
 
+			// Both are recorded into the current UploadManager batch, they don't wait for the GPU
 			void TransitionLayout(VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, bool cube = false);
-			void CopyBufferToImage(VkBuffer srcBuffer, int width, int height);
+			void CopyBufferToImage(VkBuffer srcBuffer, int width, int height, VkDeviceSize bufferOffset = 0);
 
 			void CreateImageViews(VkFormat format, uint32_t amount = 1); // TODO: mulitple views could have different formats?
 
@@ -1,20 +1,21 @@
 #include "IndexBuffer.h"
+#include "UploadManager.h"
 #include "Rose/Core/Application.h"
 
 
 namespace Rose
 {
 
-	IndexBuffer::IndexBuffer(void* data, uint32_t size) 
-		: m_Size(size)
+	IndexBuffer::IndexBuffer(void* data, uint32_t size, VkIndexType indexType, BufferUsage usage) 
+		: m_Size(size), m_IndexType(indexType), m_Usage(usage)
 	{
 		RecreateBuffer();
 		Bind();
 		SetData(data, size);
 	}
 
-	IndexBuffer::IndexBuffer(uint32_t size)
-		: m_Size(size)
+	IndexBuffer::IndexBuffer(uint32_t size, BufferUsage usage)
+		: m_Size(size), m_Usage(usage)
 	{
 		RecreateBuffer();
 	}
@@ -31,34 +32,79 @@ namespace Rose
 		//vmaBindBufferMemory(VKMemAllocator::GetVMAAllocator(), m_MemoryAllocation, m_BufferID);
 	}
 
-	void IndexBuffer::SetData(void* data, uint32_t size)
+	void IndexBuffer::SetData(void* data, uint32_t size, uint32_t offset)
 	{
-		m_Size = size;
+		if (m_Usage == BufferUsage::Static)
+		{
+			StagingRegion staging = UploadManager::Stage(data, size);
 
-		void* temp = nullptr;
-		vmaMapMemory(VKMemAllocator::GetVMAAllocator(), m_MemoryAllocation, &temp);
-		memcpy(temp, data, size);
-		vmaUnmapMemory(VKMemAllocator::GetVMAAllocator(), m_MemoryAllocation);
+			VkBufferCopy copy{};
+			copy.srcOffset = staging.Offset;
+			copy.dstOffset = offset;
+			copy.size = size;
+			vkCmdCopyBuffer(UploadManager::GetCommandBuffer(), staging.Buffer, m_BufferID, 1, &copy);
+
+			UploadManager::TransferOwnership(m_BufferID, offset, size, VK_ACCESS_INDEX_READ_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT);
+			return;
+		}
+
+		// Frames still in flight keep reading their own region
+		m_RegionOffset = (VkDeviceSize)m_Size * Application::Get().GetContext()->GetLogicalDevice()->GetCurrentFrameIndex();
+
+		memcpy(m_Shadow.data() + offset, data, size);
+		if (m_RegionOffset != m_WrittenRegion)
+		{
+			// The region was last written frames ago (or never), bring all of it up to date, not just the part that changed
+			m_WrittenRegion = m_RegionOffset;
+			memcpy(m_MappedData + m_RegionOffset, m_Shadow.data(), m_Size);
+			vmaFlushAllocation(VKMemAllocator::GetVMAAllocator(), m_MemoryAllocation, m_RegionOffset, m_Size);
+			return;
+		}
+
+		memcpy(m_MappedData + m_RegionOffset + offset, data, size);
+		vmaFlushAllocation(VKMemAllocator::GetVMAAllocator(), m_MemoryAllocation, m_RegionOffset + offset, size);
 	}
 
 	void IndexBuffer::FreeMemory()
 	{
 		m_IsFreed = true;
 		VKMemAllocator allocator;
+		if (m_MappedData)
+		{
+			allocator.UnMap(m_MemoryAllocation);
+			m_MappedData = nullptr;
+		}
 		allocator.Free(m_MemoryAllocation, m_BufferID);
 	}
 
 	void IndexBuffer::RecreateBuffer()
 	{
 		m_IsFreed = false;
+		m_RegionOffset = 0;
+
 		VkBufferCreateInfo bufferInfo{};
 		bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
 		bufferInfo.size = m_Size;
 		bufferInfo.usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
 
 		VKMemAllocator allocator;
+		if (m_Usage == BufferUsage::Static)
+		{
+			bufferInfo.usage |= VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+			m_MemoryAllocation = allocator.AllocateBuffer(bufferInfo, VMA_MEMORY_USAGE_GPU_ONLY, &m_BufferID);
+			return;
+		}
+
+		bufferInfo.size = (VkDeviceSize)m_Size * Application::Get().GetContext()->GetLogicalDevice()->GetFramesInFlight();
 		m_MemoryAllocation = allocator.AllocateBuffer(bufferInfo, VMA_MEMORY_USAGE_CPU_TO_GPU, &m_BufferID);
 
+		void* data = nullptr;
+		allocator.Map(m_MemoryAllocation, &data);
+		m_MappedData = (uint8_t*)data;
+
+		m_Shadow.assign(m_Size, 0);
+		m_WrittenRegion = UINT64_MAX;
+
 	}
 
 }
\ No newline at end of file
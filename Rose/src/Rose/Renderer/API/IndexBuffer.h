@@ -3,6 +3,8 @@
 #include <vulkan1.2.182.0/include/Vulkan/vulkan/vulkan.h>
 #include "VKMemAllocator.h"
 
+#include <vector>
+
 namespace Rose
 {
 	class IndexBuffer
@@ -10,17 +12,22 @@ namespace Rose
 
 		public:
 	
-			IndexBuffer(void* data, uint32_t size);
-			IndexBuffer(uint32_t size);
+			IndexBuffer(void* data, uint32_t size, VkIndexType indexType = VK_INDEX_TYPE_UINT32, BufferUsage usage = BufferUsage::Static);
+			IndexBuffer(uint32_t size, BufferUsage usage = BufferUsage::Dynamic);
 	
 			~IndexBuffer();
 	
 			void Bind();
-			void SetData(void* data, uint32_t size);
+			// Same rules as VertexBuffer::SetData
+			void SetData(void* data, uint32_t size, uint32_t offset = 0);
 	
 			void FreeMemory();
 	
 			const VkBuffer& GetBufferID() const { return m_BufferID; }
+			VkIndexType GetIndexType() const { return m_IndexType; }
+			// Where the data the GPU should read this frame starts, always 0 for static buffers
+			VkDeviceSize GetOffset() const { return m_RegionOffset; }
+			BufferUsage GetUsage() const { return m_Usage; }
 	
 		private:
 			void RecreateBuffer();
@@ -30,6 +37,13 @@ namespace Rose
 	
 			uint32_t m_Size = 0;
 			bool m_IsFreed = false;
+			VkIndexType m_IndexType = VK_INDEX_TYPE_UINT32;
+
+			BufferUsage m_Usage = BufferUsage::Static;
+			uint8_t* m_MappedData = nullptr; // Dynamic only, mapped for the lifetime of the buffer
+			VkDeviceSize m_RegionOffset = 0;
+			std::vector<uint8_t> m_Shadow; // Dynamic only, the latest contents, copied into a region the first time a frame writes it
+			VkDeviceSize m_WrittenRegion = UINT64_MAX;
 
 	};
 
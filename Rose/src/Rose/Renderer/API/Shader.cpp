@@ -12,6 +12,9 @@
 
 #include <tuple>
 #include "Rose/Core/Application.h"
+#include "Rose/Core/Timer.h"
+#include "Rose/Core/Profiler.h"
+#include "ShaderCache.h"
 
 
 namespace Rose
@@ -26,6 +29,7 @@ namespace Rose
 			{
 			case Rose::ShaderModuleTypes::Vertex: return shaderc_glsl_vertex_shader;
 			case Rose::ShaderModuleTypes::Pixel: return shaderc_glsl_fragment_shader;
+			case Rose::ShaderModuleTypes::Compute: return shaderc_glsl_compute_shader;
 			}
 		}
 
@@ -35,6 +39,7 @@ namespace Rose
 			{
 			case Rose::ShaderModuleTypes::Vertex: return VK_SHADER_STAGE_VERTEX_BIT;
 			case Rose::ShaderModuleTypes::Pixel:return VK_SHADER_STAGE_FRAGMENT_BIT;
+			case Rose::ShaderModuleTypes::Compute: return VK_SHADER_STAGE_COMPUTE_BIT;
 			}
 		}
 
@@ -44,6 +49,7 @@ namespace Rose
 			{
 				case Rose::ShaderModuleTypes::Vertex: return "vertex";
 				case Rose::ShaderModuleTypes::Pixel: return "pixel";
+				case Rose::ShaderModuleTypes::Compute: return "compute";
 			}
 		}
 
@@ -60,6 +66,9 @@ namespace Rose
 				case Rose::ShaderMemberType::Bool: return "Bool";
 				case Rose::ShaderMemberType::Mat4: return "Mat4";
 				case Rose::ShaderMemberType::SampledImage: return "SampledImage";
+				case Rose::ShaderMemberType::Short2Norm: return "Short2Norm";
+				case Rose::ShaderMemberType::UShort4Norm: return "UShort4Norm";
+				case Rose::ShaderMemberType::Half2: return "Half2";
 				default: return "Not listed!";
 			}
 		}
@@ -98,10 +107,21 @@ namespace Rose
 			m_ShaderModules[type] = CreateModule(compiledSources);
 		}
 
-		CreateUniformBuffers();
 		CreateDiscriptorSetLayout();
+		CreatePipelineLayout();
+		if (m_IsCompute)
+			CreateComputePipeline();
+		else
+			CreateShaderStagePipeline();
 
-		
+
+		const VkDevice& device = Application::Get().GetContext()->GetLogicalDevice()->GetDevice();
+
+		for (auto&& [type, module] : m_ShaderModules)
+		{
+			vkDestroyShaderModule(device, module, nullptr);
+		}
+		m_ShaderModules.clear();
 	}
 
 	Shader::~Shader()
@@ -114,19 +134,12 @@ namespace Rose
 
 		const VkDevice& device = Application::Get().GetContext()->GetLogicalDevice()->GetDevice();
 
-		for (auto& ubo : m_UniformBuffers)
-		{
-			vkDestroyBuffer(device, ubo.Buffer, nullptr);
-			vkFreeMemory(device, ubo.DeviceMemory, nullptr);
-		}
-
-
 		vkDestroyDescriptorSetLayout(device, m_DescriptorSetLayout, nullptr);
-		vkDestroyDescriptorPool(device, m_DescriptorPool, nullptr);
 
 
 
 		vkDestroyPipeline(device, m_GraphicsPipeline, nullptr);
+		vkDestroyPipeline(device, m_ComputePipeline, nullptr);
 		vkDestroyPipelineLayout(device, m_PipelineLayout, nullptr);
 		vkDestroyRenderPass(device, m_RenderPass, nullptr);
 	}
@@ -136,7 +149,8 @@ namespace Rose
 
 		std::ifstream file(filepath, std::ios::in, std::ios::binary);
 	
-		std::vector<std::pair<ShaderModuleTypes, std::stringstream>> shaderSources(2);
+		std::vector<std::pair<ShaderModuleTypes, std::stringstream>> shaderSources(3);
+		std::vector<bool> declared(3, false);
 		
 		ShaderModuleTypes currentShaderType = ShaderModuleTypes::Vertex;
 		std::string line;
@@ -158,6 +172,11 @@ namespace Rose
 				{
 					currentShaderType = ShaderModuleTypes::Pixel;
 				}
+				else if (line.find("compute") != std::string::npos)
+				{
+					currentShaderType = ShaderModuleTypes::Compute;
+				}
+				declared[(int)currentShaderType] = true;
 			}
 			else
 			{
@@ -165,14 +184,16 @@ namespace Rose
 				shaderSources[(int)currentShaderType].second << line << "\n";
 			}
 		}
-		for (auto& sources : shaderSources)
+		for (int i = 0; i < shaderSources.size(); i++)
 		{
-			const auto& srcType = sources.first;
-			const auto& source  = sources.second;
-
-			m_UncompiledShaderSources[srcType] = source.str();
+			// Stages the file never declared would be compiled from an empty source
+			if (!declared[i])
+				continue;
 
+			m_UncompiledShaderSources[(ShaderModuleTypes)i] = shaderSources[i].second.str();
 		}
+
+		m_IsCompute = m_UncompiledShaderSources.count(ShaderModuleTypes::Compute) != 0;
 	}
 
 
@@ -184,24 +205,40 @@ namespace Rose
 		options.SetTargetEnvironment(shaderc_target_env_vulkan, shaderc_env_version_vulkan_1_2);
 		options.SetOptimizationLevel(shaderc_optimization_level_performance);
 
+		// Part of the cache key, must change whenever the way we invoke shaderc does
+		std::string optionsSignature = "glsl|default";
+		for (auto& define : m_AttributeLayout.Defines)
+		{
+			options.AddMacroDefinition(define);
+			optionsSignature += "|" + define;
+		}
+
 		
 		for (auto&& [type, source] : m_UncompiledShaderSources)
 		{
+			uint64_t cacheKey = ShaderCache::ComputeKey(source, type, optionsSignature);
 
+			ShaderResource cachedResource;
+			if (ShaderCache::Load(m_Name, type, cacheKey, m_CompiledShaderSources[type], cachedResource))
+			{
+				m_Resources.push_back(cachedResource);
+				continue;
+			}
 
+			Timer timer;
 			shaderc::SpvCompilationResult results = compiler.CompileGlslToSpv(source, Utils::FromVKShaderTypeToSPIRV(type), m_Name.c_str());
 
-			if (results.GetCompilationStatus() != shaderc_compilation_status_success)
+			bool compiled = results.GetCompilationStatus() == shaderc_compilation_status_success;
+			if (!compiled)
 			{
 				LOG("%s\n", results.GetErrorMessage().c_str());
 			}
 
 			m_CompiledShaderSources[type] = std::vector<uint32_t>(results.cbegin(), results.cend());
-		}
+			Reflect(type, m_CompiledShaderSources[type], true);
 
-		for (auto& [type, data] : m_CompiledShaderSources)
-		{
-			Reflect(type, data, true);
+			if (compiled)
+				ShaderCache::Store(m_Name, type, cacheKey, m_CompiledShaderSources[type], m_Resources.back(), timer.ElapsedMillis());
 		}
 
 	}
@@ -223,6 +260,56 @@ namespace Rose
 		return result;
 	}
 
+	void Shader::CreatePipelineLayout()
+	{
+		const VkDevice& device = Application::Get().GetContext()->GetLogicalDevice()->GetDevice();
+
+		std::vector<VkPushConstantRange> pushConstantRanges;
+		for (auto& resource : m_Resources)
+		{
+			if (resource.PushConstantSize)
+			{
+				VkPushConstantRange range{};
+				range.stageFlags = Utils::DeduceShaderStageFromType(resource.Type);
+				range.offset = 0;
+				range.size = resource.PushConstantSize;
+				pushConstantRanges.push_back(range);
+			}
+		}
+
+		VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		pipelineLayoutInfo.setLayoutCount = 1;
+		pipelineLayoutInfo.pSetLayouts = &m_DescriptorSetLayout;
+		pipelineLayoutInfo.pushConstantRangeCount = (uint32_t)pushConstantRanges.size();
+		pipelineLayoutInfo.pPushConstantRanges = pushConstantRanges.data();
+
+		vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &m_PipelineLayout);
+	}
+
+	void Shader::CreateComputePipeline()
+	{
+		const VkDevice& device = Application::Get().GetContext()->GetLogicalDevice()->GetDevice();
+
+		VkPipelineShaderStageCreateInfo stageInfo{};
+		stageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		stageInfo.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+		stageInfo.pName = "main";
+		stageInfo.module = m_ShaderModules[ShaderModuleTypes::Compute];
+
+		VkComputePipelineCreateInfo pipelineInfo{};
+		pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+		pipelineInfo.stage = stageInfo;
+		pipelineInfo.layout = m_PipelineLayout;
+		pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+
+		const auto& logicalDevice = Application::Get().GetContext()->GetLogicalDevice();
+
+		Timer timer;
+		vkCreateComputePipelines(device, logicalDevice->GetPipelineCache(), 1, &pipelineInfo, nullptr, &m_ComputePipeline);
+		Profiler::Record(logicalDevice->IsPipelineCacheWarm() ? "Pipeline creation (warm cache)" : "Pipeline creation (cold cache)", timer.ElapsedMillis());
+	}
+
 	void Shader::CreateShaderStagePipeline()
 	{
 
@@ -242,14 +329,14 @@ namespace Rose
 
 		
 
-		auto bindingDesc = m_AttributeLayout.BindingDescription;
+		auto bindingDesc = m_AttributeLayout.BindingDescriptions;
 		auto attributeDesc = m_AttributeLayout.ReturnVKAttribues();
 		
 
 		VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
 		vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-		vertexInputInfo.vertexBindingDescriptionCount = 1;
-		vertexInputInfo.pVertexBindingDescriptions = &bindingDesc;
+		vertexInputInfo.vertexBindingDescriptionCount = bindingDesc.size();
+		vertexInputInfo.pVertexBindingDescriptions = bindingDesc.data();
 		vertexInputInfo.vertexAttributeDescriptionCount = attributeDesc.size();
 		vertexInputInfo.pVertexAttributeDescriptions = attributeDesc.data(); 
 
@@ -355,13 +442,6 @@ namespace Rose
 		dynamicState.pDynamicStates = dynamicStates.data();
 
 
-		VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
-		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-		pipelineLayoutInfo.setLayoutCount = 1;
-		pipelineLayoutInfo.pSetLayouts = &m_DescriptorSetLayout;
-
-		vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &m_PipelineLayout);
-		
 		VkAttachmentDescription colorAttachment{};
 		colorAttachment.format = Application::Get().GetSwapChain()->GetColorFormat();
 		colorAttachment.samples = Application::Get().GetContext()->GetPhysicalDevice()->GetMSAASampleCount();
@@ -452,7 +532,11 @@ namespace Rose
 		pipelineInfo.subpass = 0;
 		pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
 
-		vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_GraphicsPipeline);
+		const auto& logicalDevice = Application::Get().GetContext()->GetLogicalDevice();
+
+		Timer timer;
+		vkCreateGraphicsPipelines(device, logicalDevice->GetPipelineCache(), 1, &pipelineInfo, nullptr, &m_GraphicsPipeline);
+		Profiler::Record(logicalDevice->IsPipelineCacheWarm() ? "Pipeline creation (warm cache)" : "Pipeline creation (cold cache)", timer.ElapsedMillis());
 	}
 
 	
@@ -476,7 +560,7 @@ namespace Rose
 
 					binding.binding = ubo.Binding;
 					binding.descriptorCount = 1;
-					binding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+					binding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
 					binding.pImmutableSamplers = nullptr;
 					binding.stageFlags = stageFlag;
 
@@ -485,6 +569,23 @@ namespace Rose
 
 			}
 
+			if (resource.StorageBufferSize)
+			{
+				auto stageFlag = Utils::DeduceShaderStageFromType(resource.Type);
+				for (auto& ssbo : resource.ReflectedSSBOs)
+				{
+					VkDescriptorSetLayoutBinding binding{};
+
+					binding.binding = ssbo.Binding;
+					binding.descriptorCount = 1;
+					binding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+					binding.pImmutableSamplers = nullptr;
+					binding.stageFlags = stageFlag;
+
+					bindings.push_back(binding);
+				}
+			}
+
 			if (resource.ImageBufferSize)
 			{
 				auto stageFlag = Utils::DeduceShaderStageFromType(resource.Type);
@@ -515,84 +616,7 @@ namespace Rose
 		vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &m_DescriptorSetLayout);
 	}
 
-	void Shader::CreateUniformBuffers()
-	{
-		for (auto& resources : m_Resources)
-		{
-			int i = 0;
-			for (auto& reflectedUBO : resources.ReflectedUBOs)
-			{
-				VkBuffer buffer;
-				VkDeviceMemory deviceMemory;
-
-
-				VkBufferCreateInfo bufferInfo{};
-				bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-				bufferInfo.size = reflectedUBO.BufferSize;
-				bufferInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
-				bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-				const auto& VKLogicalDevice = Application::Get().GetContext()->GetLogicalDevice()->GetDevice();
-
-				vkCreateBuffer(VKLogicalDevice, &bufferInfo, nullptr, &buffer);
-
-
-				VkMemoryRequirements memRequirements;
-				vkGetBufferMemoryRequirements(VKLogicalDevice, buffer, &memRequirements);
-
-
-				VkPhysicalDeviceMemoryProperties memProperties;
-				vkGetPhysicalDeviceMemoryProperties(Application::Get().GetContext()->GetPhysicalDevice()->GetDevice(), &memProperties);
-
-				uint32_t memTypeIndex = 0;
-				uint32_t propFilter = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
-				for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++) {
-					if ((memRequirements.memoryTypeBits & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags & propFilter) == propFilter)
-					{
-						memTypeIndex = i;
-						break;
-					}
-				}
-
-				VkMemoryAllocateInfo allocInfo{};
-				allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-				allocInfo.allocationSize = memRequirements.size;
-				allocInfo.memoryTypeIndex = memTypeIndex;
-
-				if (vkAllocateMemory(VKLogicalDevice, &allocInfo, nullptr, &deviceMemory) != VK_SUCCESS)
-					ASSERT();
-
-				vkBindBufferMemory(VKLogicalDevice, buffer, deviceMemory, 0);
-
-				i++;
-
-				m_UniformBuffers.push_back({ buffer, deviceMemory });
-			}
-		}
-		
-
-	}
-
-
-	void Shader::UpdateUniformBuffer(void* data, uint32_t size, uint32_t binding)
-	{
-		const auto& device = Application::Get().GetContext()->GetLogicalDevice()->GetDevice();
-
-		if (binding < 0 || binding > m_UniformBuffers.size())
-		{
-			LOG("Could not update UBO at binding '%d'! It may not exist or is 0!\n");
-			return;
-		}
-		auto& memory = m_UniformBuffers[binding].DeviceMemory;
-
-
-		void* temp;
-		vkMapMemory(device, memory, 0, size, 0, &temp);
-		memcpy(temp, data, size);
-		vkUnmapMemory(device, memory);
-
-	}
-
-	void Shader::CreateDescriptorPool(const std::vector< MaterialUniform>& matUniforms)
+	void Shader::CreateDescriptorPool(VkDescriptorPool& outPool, uint32_t setCount)
 	{
 
 
@@ -607,13 +631,22 @@ namespace Rose
 				for (auto& ubo : resource.ReflectedUBOs)
 				{
 					VkDescriptorPoolSize result;
-					result.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-					result.descriptorCount = 1;
+					result.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+					result.descriptorCount = setCount;
 
 					poolSizes.push_back(result);
 				}
 			}
 
+			for (auto& ssbo : resource.ReflectedSSBOs)
+			{
+				VkDescriptorPoolSize result;
+				result.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+				result.descriptorCount = setCount;
+
+				poolSizes.push_back(result);
+			}
+
 			if (resource.ImageBufferSize)
 			{
 				for (auto& image : resource.ReflectedMembers)
@@ -622,7 +655,7 @@ namespace Rose
 					{
 						VkDescriptorPoolSize result;
 						result.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-						result.descriptorCount = 1;
+						result.descriptorCount = setCount;
 
 						poolSizes.push_back(result);
 					}
@@ -636,27 +669,34 @@ namespace Rose
 		poolInfo.poolSizeCount = poolSizes.size();
 		poolInfo.pPoolSizes = poolSizes.data();
 
-		poolInfo.maxSets = 1;
+		poolInfo.maxSets = setCount;
 
-		vkCreateDescriptorPool(device, &poolInfo, nullptr, &m_DescriptorPool);
+		vkCreateDescriptorPool(device, &poolInfo, nullptr, &outPool);
 	}
 
-	void Shader::CreateDescriptorSets(const std::vector< MaterialUniform>& matUniforms)
+	void Shader::CreateDescriptorSet(const std::vector< MaterialUniform>& matUniforms, VkBuffer uniformBuffer, const std::unordered_map<uint32_t, VkDescriptorBufferInfo>& storageBuffers, VkDescriptorPool pool, VkDescriptorSet& outSet)
 	{
 		const auto& device = Application::Get().GetContext()->GetLogicalDevice()->GetDevice();
 
-		std::vector<VkDescriptorSetLayout> layouts(1, m_DescriptorSetLayout); // TODO: multiple frames in flight
+		std::vector<VkDescriptorSetLayout> layouts(1, m_DescriptorSetLayout);
 		VkDescriptorSetAllocateInfo allocInfo{};
 		allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-		allocInfo.descriptorPool = m_DescriptorPool;
+		allocInfo.descriptorPool = pool;
 		allocInfo.descriptorSetCount = 1;
 		allocInfo.pSetLayouts = layouts.data();
-		VkResult result = vkAllocateDescriptorSets(device, &allocInfo, &m_DescriptorSet);
+		VkResult result = vkAllocateDescriptorSets(device, &allocInfo, &outSet);
 
 
 		std::vector<VkWriteDescriptorSet> descWrites{};
+		std::vector<VkDescriptorBufferInfo> bufferInfos{};
 		std::vector<VkDescriptorImageInfo> imgInfos{};
 
+		// The writes point into these, so they can't reallocate while we fill them in
+		size_t uboCount = 0;
+		for (auto& resource : m_Resources)
+			uboCount += resource.ReflectedUBOs.size() + resource.ReflectedSSBOs.size();
+		bufferInfos.reserve(uboCount);
+
 		for (auto& resource : m_Resources)
 		{
 			if (resource.UniformBufferSize)
@@ -665,19 +705,20 @@ namespace Rose
 				for (auto& ubo : resource.ReflectedUBOs)
 				{
 
-					VkDescriptorBufferInfo bufferInfo{};
+					VkDescriptorBufferInfo& bufferInfo = bufferInfos.emplace_back();
 
-					bufferInfo.buffer = m_UniformBuffers[ubo.Binding].Buffer;
+					// The actual offset into the ring is supplied as a dynamic offset when binding
+					bufferInfo.buffer = uniformBuffer;
 					bufferInfo.range = ubo.BufferSize;
 					bufferInfo.offset = 0;
 
 					VkWriteDescriptorSet bufferDescWrite{};
 
 					bufferDescWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-					bufferDescWrite.dstSet = m_DescriptorSet;
+					bufferDescWrite.dstSet = outSet;
 					bufferDescWrite.dstBinding = ubo.Binding;
 					bufferDescWrite.dstArrayElement = 0;
-					bufferDescWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+					bufferDescWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
 					bufferDescWrite.descriptorCount = 1;
 					bufferDescWrite.pBufferInfo = &bufferInfo;
 					
@@ -686,6 +727,31 @@ namespace Rose
 				}
 			}
 
+			for (auto& ssbo : resource.ReflectedSSBOs)
+			{
+				auto storageBuffer = storageBuffers.find(ssbo.Binding);
+				if (storageBuffer == storageBuffers.end())
+				{
+					LOG("%s: nothing to bind to buffer binding %d!\n", m_Name.c_str(), ssbo.Binding);
+					continue;
+				}
+
+				// Same as the UBOs, the frame's copy of the buffer is picked with a dynamic offset
+				VkDescriptorBufferInfo& bufferInfo = bufferInfos.emplace_back(storageBuffer->second);
+
+				VkWriteDescriptorSet bufferDescWrite{};
+
+				bufferDescWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+				bufferDescWrite.dstSet = outSet;
+				bufferDescWrite.dstBinding = ssbo.Binding;
+				bufferDescWrite.dstArrayElement = 0;
+				bufferDescWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+				bufferDescWrite.descriptorCount = 1;
+				bufferDescWrite.pBufferInfo = &bufferInfo;
+
+				descWrites.push_back(bufferDescWrite);
+			}
+
 			if (resource.ImageBufferSize)
 			{
 
@@ -728,7 +794,7 @@ namespace Rose
 						VkWriteDescriptorSet imageDescWrite{};
 
 						imageDescWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-						imageDescWrite.dstSet = m_DescriptorSet;
+						imageDescWrite.dstSet = outSet;
 						imageDescWrite.dstBinding = image.Binding;
 						imageDescWrite.dstArrayElement = 0;
 						imageDescWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
@@ -750,22 +816,48 @@ namespace Rose
 
 	}
 
-	void Shader::CreatePipelineAndDescriptorPool(const std::vector< MaterialUniform>& matUniforms)
+	void Shader::CreateBufferDescriptorSet(const std::unordered_map<uint32_t, VkDescriptorBufferInfo>& buffers, VkDescriptorPool pool, VkDescriptorSet& outSet)
 	{
-		CreateDescriptorPool(matUniforms);
-		CreateDescriptorSets(matUniforms);
+		const auto& device = Application::Get().GetContext()->GetLogicalDevice()->GetDevice();
 
-		CreateShaderStagePipeline();
+		VkDescriptorSetAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		allocInfo.descriptorPool = pool;
+		allocInfo.descriptorSetCount = 1;
+		allocInfo.pSetLayouts = &m_DescriptorSetLayout;
+		vkAllocateDescriptorSets(device, &allocInfo, &outSet);
 
+		std::vector<VkWriteDescriptorSet> descWrites{};
+		auto addWrite = [&](uint32_t binding, VkDescriptorType type)
+		{
+			auto buffer = buffers.find(binding);
+			if (buffer == buffers.end())
+			{
+				LOG("%s: nothing to bind to buffer binding %d!\n", m_Name.c_str(), binding);
+				return;
+			}
 
+			VkWriteDescriptorSet bufferDescWrite{};
+			bufferDescWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			bufferDescWrite.dstSet = outSet;
+			bufferDescWrite.dstBinding = binding;
+			bufferDescWrite.dstArrayElement = 0;
+			bufferDescWrite.descriptorType = type;
+			bufferDescWrite.descriptorCount = 1;
+			bufferDescWrite.pBufferInfo = &buffer->second;
 
-		const VkDevice& device = Application::Get().GetContext()->GetLogicalDevice()->GetDevice();
+			descWrites.push_back(bufferDescWrite);
+		};
 
-		for (auto&& [type, module] : m_ShaderModules)
+		for (auto& resource : m_Resources)
 		{
-			vkDestroyShaderModule(device, module, nullptr);
+			for (auto& ubo : resource.ReflectedUBOs)
+				addWrite(ubo.Binding, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC);
+			for (auto& ssbo : resource.ReflectedSSBOs)
+				addWrite(ssbo.Binding, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC);
 		}
 
+		vkUpdateDescriptorSets(device, descWrites.size(), descWrites.data(), 0, nullptr);
 	}
 
 	void Shader::Reflect(ShaderModuleTypes type, const std::vector<uint32_t>& data, bool logInfo)
@@ -834,12 +926,32 @@ namespace Rose
 
 		}
 
+		shaderResource.StorageBufferSize = resources.storage_buffers.size();
+		for (auto& resource : resources.storage_buffers)
+		{
+			ShaderUniformBuffer storage;
+			auto& id = compiler.get_type(resource.base_type_id);
+			storage.BufferSize = compiler.get_declared_struct_size(id);
+			storage.Binding = compiler.get_decoration(resource.id, spv::Decoration::DecorationBinding);
+			storage.MemberSize = id.member_types.size();
+
+			shaderResource.ReflectedSSBOs.push_back(storage);
+		}
+
+		for (auto& resource : resources.push_constant_buffers)
+		{
+			auto& id = compiler.get_type(resource.base_type_id);
+			shaderResource.PushConstantSize = std::max(shaderResource.PushConstantSize, (uint32_t)compiler.get_declared_struct_size(id));
+		}
+
 		if (logInfo)
 		{
 
 			LOG("\n\nShader resource: (%s::%s)\n", shaderResource.Name.c_str(), Utils::FromShaderTypeToString(shaderResource.Type).c_str());
 			LOG("Uniform buffers: (%d)\n", shaderResource.UniformBufferSize);
 			LOG("Image buffers: (%d)\n", shaderResource.ImageBufferSize);
+			LOG("Storage buffers: (%d)\n", shaderResource.StorageBufferSize);
+			LOG("Push constant size: (%d)\n", shaderResource.PushConstantSize);
 			LOG("Reflected UBOs: (count: %d)\n", shaderResource.ReflectedUBOs.size());
 			for (auto& ubo : shaderResource.ReflectedUBOs)
 			{
@@ -866,4 +978,35 @@ namespace Rose
 
 	}
 
+
+	//////////////////////////////////////////////////////////////////////////
+	//////////////////////////// ShaderLibrary ///////////////////////////////
+	//////////////////////////////////////////////////////////////////////////
+
+	std::unordered_map<std::string, std::shared_ptr<Shader>> ShaderLibrary::s_Shaders;
+
+
+	std::shared_ptr<Shader> ShaderLibrary::Get(const std::string& filepath, const ShaderAttributeLayout& layout, bool isSkybox)
+	{
+		std::string key = filepath + "|" + layout.GetSignature() + "|" + (isSkybox ? "skybox" : "default");
+
+		auto it = s_Shaders.find(key);
+		if (it != s_Shaders.end())
+			return it->second;
+
+		auto shader = std::make_shared<Shader>(filepath, layout, isSkybox);
+		s_Shaders[key] = shader;
+		LOG("ShaderLibrary: created '%s' (unique shaders: %d)\n", filepath.c_str(), (uint32_t)s_Shaders.size());
+		return shader;
+	}
+
+	void ShaderLibrary::Shutdown()
+	{
+		for (auto&& [key, shader] : s_Shaders)
+		{
+			shader->DestroyPipeline();
+		}
+		s_Shaders.clear();
+	}
+
 }
@@ -3,6 +3,7 @@
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include <memory>
 
 #include <vulkan1.2.182.0/include/Vulkan/vulkan/vulkan.h>
 #include <glm/glm.hpp>
@@ -23,13 +24,18 @@ namespace Rose
 		Float4,
 		Bool,
 		Mat4,
-		SampledImage
+		SampledImage,
+
+		// Vertex attribute formats only, the shader sees them as floats
+		Short2Norm, // 2x snorm16
+		UShort4Norm, // 4x unorm16
+		Half2 // 2x float16
 	};
 
 
 	enum class ShaderModuleTypes
 	{
-		Vertex, Pixel
+		Vertex, Pixel, Compute
 	};
 
 
@@ -57,6 +63,9 @@ namespace Rose
 				case ShaderMemberType::Float3: return 4 + 4 + 4;
 				case ShaderMemberType::Float4: return 4 + 4 + 4 + 4;
 				case ShaderMemberType::Mat4: return 4 * 4 * 4;
+				case ShaderMemberType::Short2Norm: return 2 + 2;
+				case ShaderMemberType::UShort4Norm: return 2 + 2 + 2 + 2;
+				case ShaderMemberType::Half2: return 2 + 2;
 			}
 		}
 	};
@@ -79,14 +88,17 @@ namespace Rose
 
 		uint32_t UniformBufferSize;
 		uint32_t ImageBufferSize;
+		uint32_t StorageBufferSize = 0;
+		uint32_t PushConstantSize = 0; // In bytes, 0 if the stage has no push constant block
 
 		std::vector<ShaderUniformBuffer> ReflectedUBOs;
+		std::vector<ShaderUniformBuffer> ReflectedSSBOs; // Members aren't reflected, BufferSize excludes runtime arrays
 		std::vector<ShaderMember> ReflectedMembers;
 	};
 
-	struct UniformBufferData
+	// Written once per frame, binding 0 in every shader
+	struct SceneUniformData
 	{
-		glm::mat4 Model =  glm::mat4(1.0f);
 		glm::mat4 View = glm::mat4(1.0f);
 		glm::mat4 Proj = glm::mat4(1.0f);
 		glm::mat4 ViewProj = glm::mat4(1.0f);
@@ -99,11 +111,6 @@ namespace Rose
 
 	};
 
-	struct VKUniformBuffer
-	{
-		VkBuffer Buffer;
-		VkDeviceMemory DeviceMemory;
-	};
 
 
 	struct ShaderAttribute 
@@ -116,8 +123,8 @@ namespace Rose
 		uint32_t Binding = 0;
 		VkVertexInputAttributeDescription VKDescription;
 
-		ShaderAttribute(const std::string& name, uint32_t location, ShaderMemberType format) 
-			: Name(name), Location(location), Format(format)
+		ShaderAttribute(const std::string& name, uint32_t location, ShaderMemberType format, uint32_t binding = 0) 
+			: Name(name), Location(location), Format(format), Binding(binding)
 		{
 			Size = ShaderMember::ShaderTypeToBytes(Format);
 
@@ -142,6 +149,9 @@ namespace Rose
 				case ShaderMemberType::Float3: return  VK_FORMAT_R32G32B32_SFLOAT;
 				case ShaderMemberType::Float4: return  VK_FORMAT_R32G32B32A32_SFLOAT;
 				case ShaderMemberType::Bool: return VK_FORMAT_R8_UINT;
+				case ShaderMemberType::Short2Norm: return VK_FORMAT_R16G16_SNORM;
+				case ShaderMemberType::UShort4Norm: return VK_FORMAT_R16G16B16A16_UNORM;
+				case ShaderMemberType::Half2: return VK_FORMAT_R16G16_SFLOAT;
 				case ShaderMemberType::Mat4: ASSERT();
 				case ShaderMemberType::SampledImage: ASSERT();
 			}
@@ -153,25 +163,38 @@ namespace Rose
 	{
 
 
-		VkVertexInputBindingDescription BindingDescription{};
+		// One per vertex buffer binding, attributes of a binding are packed in the order they're declared
+		std::vector<VkVertexInputBindingDescription> BindingDescriptions;
 
+		// No vertex input, for compute shaders
+		ShaderAttributeLayout() = default;
 		
 		ShaderAttributeLayout(const std::initializer_list<ShaderAttribute>& attributes)
 			: Attributes(attributes)
 		{
 
-			uint32_t stride = 0;
 			for (auto& attribute : Attributes)
 			{
-				attribute.VKDescription.offset = stride;
-				stride += attribute.Size;
+				if (attribute.Binding >= BindingDescriptions.size())
+				{
+					size_t first = BindingDescriptions.size();
+					BindingDescriptions.resize(attribute.Binding + 1);
+					for (size_t i = first; i < BindingDescriptions.size(); i++)
+					{
+						BindingDescriptions[i].binding = (uint32_t)i;
+						BindingDescriptions[i].stride = 0;
+						BindingDescriptions[i].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+					}
+				}
+
+				auto& binding = BindingDescriptions[attribute.Binding];
+				attribute.VKDescription.offset = binding.stride;
+				binding.stride += attribute.Size;
 			}
-
-			BindingDescription.binding = 0;
-			BindingDescription.stride = stride;
-			BindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
 		}
 
+		uint32_t GetBindingCount() const { return (uint32_t)BindingDescriptions.size(); }
+
 		std::vector<VkVertexInputAttributeDescription> ReturnVKAttribues()
 		{
 			std::vector< VkVertexInputAttributeDescription> result;
@@ -183,12 +206,35 @@ namespace Rose
 			return result;
 		}
 
+		// Used to tell apart pipelines that share a shader file but not a vertex layout
+		std::string GetSignature() const
+		{
+			std::string result;
+			for (auto& attribute : Attributes)
+			{
+				result += std::to_string(attribute.Location) + ":" + std::to_string((int)attribute.Format) + "@" + std::to_string(attribute.Binding) + ";";
+			}
+			for (auto& binding : BindingDescriptions)
+				result += std::to_string(binding.stride) + ";";
+			for (auto& define : Defines)
+				result += "|" + define;
+			return result;
+		}
+
 		std::vector<ShaderAttribute> Attributes;
+		// Macros the shader needs to decode this layout, defined for every stage
+		std::vector<std::string> Defines;
 	};
 
 
 
 	struct MaterialUniform;
+
+	// A shader only owns what every material using it can share: the modules, the reflection data, the layouts and the pipeline.
+	// Descriptor sets are owned by each Material. Use the ShaderLibrary to get one.
+	// Every uniform buffer is bound as VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC into the UniformRingBuffer,
+	// every storage buffer as VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC into the GPUScene buffer with its binding.
+	// A file with a single "#type compute" stage builds a compute pipeline instead, its buffers are bound with CreateBufferDescriptorSet.
 	class Shader
 	{
 
@@ -197,42 +243,39 @@ namespace Rose
 			~Shader();
 
 			void DestroyPipeline();
-			void CreateUniformBuffers();
 
-
-			void UpdateUniformBuffer(void* data, uint32_t size, uint32_t binding);
+			void CreateDescriptorPool(VkDescriptorPool& outPool, uint32_t setCount = 1);
+			void CreateDescriptorSet(const std::vector< MaterialUniform>& matUniforms, VkBuffer uniformBuffer, const std::unordered_map<uint32_t, VkDescriptorBufferInfo>& storageBuffers, VkDescriptorPool pool, VkDescriptorSet& outSet);
+			// Every reflected uniform and storage buffer is written from the entry with its binding, offsets are still supplied as dynamic offsets
+			void CreateBufferDescriptorSet(const std::unordered_map<uint32_t, VkDescriptorBufferInfo>& buffers, VkDescriptorPool pool, VkDescriptorSet& outSet);
 
 
 			const VkPipeline& GetGrahpicsPipeline() const { return m_GraphicsPipeline; }
 			VkPipeline& GetGrahpicsPipeline() { return m_GraphicsPipeline; }
 
+			const VkPipeline& GetComputePipeline() const { return m_ComputePipeline; }
+			bool IsCompute() const { return m_IsCompute; }
+
 			VkPipelineLayout& GetPipelineLayout() { return m_PipelineLayout; }
 			const VkPipelineLayout& GetPipelineLayout() const { return m_PipelineLayout; }
 
 			const VkRenderPass& GetRenderPass() const { return m_RenderPass; }
 			VkRenderPass& GetRenderPass() { return m_RenderPass; }
 
-			VkDescriptorSet& GetDescriptorSet() { return m_DescriptorSet; }
-			const VkDescriptorSet& GetDescriptorSet() const { return m_DescriptorSet; }
+			const VkDescriptorSetLayout& GetDescriptorSetLayout() const { return m_DescriptorSetLayout; }
 
-
-			VkDescriptorPool& GetDescriptorPool() { return m_DescriptorPool; }
-
-			void CreateDiscriptorSetLayout();
-
-			void CreateDescriptorPool(const std::vector< MaterialUniform>& matUniforms);
-			void CreateDescriptorSets(const std::vector< MaterialUniform>& matUniforms);
-
-
-			void CreatePipelineAndDescriptorPool(const std::vector< MaterialUniform>& matUniforms);
+			const std::string& GetFilepath() const { return m_Filepath; }
 
 		private :
+			void CreateDiscriptorSetLayout();
 			void ParseShaders(const std::string& filepath);
 
 			void CompileShadersIntoSPIRV();
 			VkShaderModule CreateModule(const std::vector<uint32_t>& sprvCode);
 
+			void CreatePipelineLayout();
 			void CreateShaderStagePipeline();
+			void CreateComputePipeline();
 			void Reflect(ShaderModuleTypes type, const std::vector<uint32_t>& data, bool logInfo);
 
 		private :
@@ -244,21 +287,33 @@ namespace Rose
 			std::unordered_map <ShaderModuleTypes, VkShaderModule> m_ShaderModules;
 
 			std::vector<ShaderResource> m_Resources;
-			std::vector<VKUniformBuffer> m_UniformBuffers;
 
 
-			VkPipeline m_GraphicsPipeline;
+			VkPipeline m_GraphicsPipeline = VK_NULL_HANDLE;
+			VkPipeline m_ComputePipeline = VK_NULL_HANDLE;
 			VkDescriptorSetLayout m_DescriptorSetLayout;
 			VkPipelineLayout m_PipelineLayout;
-			VkRenderPass m_RenderPass;
-
-
-			VkDescriptorPool m_DescriptorPool;
-			VkDescriptorSet m_DescriptorSet;
+			VkRenderPass m_RenderPass = VK_NULL_HANDLE;
 
 			ShaderAttributeLayout m_AttributeLayout;
 			bool m_IsSkybox = false; // TODO: Proper graphics pipelines needed!
+			bool m_IsCompute = false;
+
+	};
+
+
+	// Caches one Shader per (shader file, vertex layout, render state) so materials don't each compile and build their own pipeline.
+	class ShaderLibrary
+	{
+		public :
+			static std::shared_ptr<Shader> Get(const std::string& filepath, const ShaderAttributeLayout& layout, bool isSkybox = false);
+
+			static uint32_t GetShaderCount() { return (uint32_t)s_Shaders.size(); }
 
+			static void Shutdown();
+
+		private :
+			static std::unordered_map<std::string, std::shared_ptr<Shader>> s_Shaders;
 	};
 
 }
\ No newline at end of file
@@ -0,0 +1,281 @@
+#include "ShaderCache.h"
+#include "Rose/Core/Log.h"
+#include "Rose/Core/Timer.h"
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#include <vulkan1.2.182.0/include/Vulkan/shaderc/shaderc.h>
+
+#ifdef RS_PLATFORM_WINDOWS
+	#include <Windows.h>
+#endif
+
+namespace Rose
+{
+
+	static const char* s_CacheDirectory = "assets/cache/shaders";
+	static const uint32_t s_CacheMagic = 0x43535352; // "RSSC"
+	static const uint32_t s_CacheVersion = 2;
+
+#ifdef RS_DEBUG
+	static const char* s_CompilerLibrary = "shaderc_sharedd.dll";
+#else
+	static const char* s_CompilerLibrary = "shaderc_shared.dll";
+#endif
+
+	ShaderCacheStats ShaderCache::s_Stats;
+
+
+	namespace Utils {
+
+		static uint64_t HashFNV1a(const void* data, size_t size, uint64_t hash = 14695981039346656037ull)
+		{
+			const uint8_t* bytes = (const uint8_t*)data;
+			for (size_t i = 0; i < size; i++)
+			{
+				hash ^= bytes[i];
+				hash *= 1099511628211ull;
+			}
+			return hash;
+		}
+
+		template<typename T>
+		static void Write(std::ostream& stream, const T& value)
+		{
+			stream.write((const char*)&value, sizeof(T));
+		}
+
+		template<typename T>
+		static bool Read(std::istream& stream, T& value)
+		{
+			stream.read((char*)&value, sizeof(T));
+			return (bool)stream;
+		}
+
+		static void WriteString(std::ostream& stream, const std::string& value)
+		{
+			Write(stream, (uint32_t)value.size());
+			stream.write(value.data(), value.size());
+		}
+
+		static bool ReadString(std::istream& stream, std::string& value)
+		{
+			uint32_t size;
+			if (!Read(stream, size))
+				return false;
+
+			value.resize(size);
+			stream.read(value.data(), size);
+			return (bool)stream;
+		}
+
+		// shaderc has no version string, so the compiler is identified by the SDK it ships with and the build of the library that got loaded
+		static const std::string& GetCompilerIdentifier()
+		{
+			static std::string identifier;
+			if (!identifier.empty())
+				return identifier;
+
+			unsigned int spvVersion = 0, spvRevision = 0;
+			shaderc_get_spv_version(&spvVersion, &spvRevision);
+
+			std::stringstream ss;
+			ss << "sdk " << VK_HEADER_VERSION_COMPLETE << ", spv " << spvVersion << "." << spvRevision;
+
+#ifdef RS_PLATFORM_WINDOWS
+			char path[MAX_PATH];
+			HMODULE library = GetModuleHandleA(s_CompilerLibrary);
+			if (library && GetModuleFileNameA(library, path, MAX_PATH))
+			{
+				std::error_code error;
+				uintmax_t size = std::filesystem::file_size(path, error);
+				auto time = std::filesystem::last_write_time(path, error);
+				if (!error)
+					ss << ", " << s_CompilerLibrary << " " << size << " " << time.time_since_epoch().count();
+			}
+#endif
+
+			identifier = ss.str();
+			LOG("Shader cache: compiler %s\n", identifier.c_str());
+			return identifier;
+		}
+
+		static void WriteMember(std::ostream& stream, const ShaderMember& member)
+		{
+			WriteString(stream, member.Name);
+			Write(stream, member.Size);
+			Write(stream, member.Offset);
+			Write(stream, member.Binding);
+			Write(stream, member.Type);
+		}
+
+		static bool ReadMember(std::istream& stream, ShaderMember& member)
+		{
+			return ReadString(stream, member.Name) && Read(stream, member.Size) && Read(stream, member.Offset)
+				&& Read(stream, member.Binding) && Read(stream, member.Type);
+		}
+
+	}
+
+
+	uint64_t ShaderCache::ComputeKey(const std::string& source, ShaderModuleTypes type, const std::string& optionsSignature)
+	{
+		const std::string& compiler = Utils::GetCompilerIdentifier();
+
+		uint64_t hash = Utils::HashFNV1a(source.data(), source.size());
+		hash = Utils::HashFNV1a(&type, sizeof(type), hash);
+		hash = Utils::HashFNV1a(optionsSignature.data(), optionsSignature.size(), hash);
+		hash = Utils::HashFNV1a(compiler.data(), compiler.size(), hash);
+		hash = Utils::HashFNV1a(&s_CacheVersion, sizeof(s_CacheVersion), hash);
+		return hash;
+	}
+
+	std::string ShaderCache::GetEntryPath(const std::string& name, ShaderModuleTypes type, uint64_t key)
+	{
+		std::stringstream ss;
+		ss << s_CacheDirectory << "/" << name << (type == ShaderModuleTypes::Vertex ? ".vert." : type == ShaderModuleTypes::Compute ? ".comp." : ".frag.") << std::hex << key << ".spvc";
+		return ss.str();
+	}
+
+	bool ShaderCache::Load(const std::string& name, ShaderModuleTypes type, uint64_t key, std::vector<uint32_t>& outSpirv, ShaderResource& outResource)
+	{
+		Timer timer;
+
+		std::ifstream file(GetEntryPath(name, type, key), std::ios::in | std::ios::binary);
+		if (!file)
+		{
+			s_Stats.Misses++;
+			return false;
+		}
+
+		uint32_t magic, version;
+		uint64_t storedKey;
+		float compileTimeMs;
+		if (!Utils::Read(file, magic) || !Utils::Read(file, version) || !Utils::Read(file, storedKey) || !Utils::Read(file, compileTimeMs)
+			|| magic != s_CacheMagic || version != s_CacheVersion || storedKey != key)
+		{
+			LOG("Shader cache entry for '%s' is stale or corrupt, recompiling\n", name.c_str());
+			s_Stats.Misses++;
+			return false;
+		}
+
+		uint32_t wordCount;
+		bool valid = Utils::Read(file, wordCount);
+		if (valid)
+		{
+			outSpirv.resize(wordCount);
+			file.read((char*)outSpirv.data(), wordCount * sizeof(uint32_t));
+			valid = (bool)file;
+		}
+
+		ShaderResource resource;
+		uint32_t uboCount = 0, ssboCount = 0, memberCount = 0;
+		valid = valid && Utils::ReadString(file, resource.Name) && Utils::Read(file, resource.Type)
+			&& Utils::Read(file, resource.UniformBufferSize) && Utils::Read(file, resource.ImageBufferSize)
+			&& Utils::Read(file, resource.StorageBufferSize) && Utils::Read(file, resource.PushConstantSize)
+			&& Utils::Read(file, uboCount);
+
+		for (uint32_t i = 0; valid && i < uboCount; i++)
+		{
+			ShaderUniformBuffer& ubo = resource.ReflectedUBOs.emplace_back();
+			uint32_t uboMemberCount = 0;
+			valid = Utils::Read(file, ubo.BufferSize) && Utils::Read(file, ubo.Binding) && Utils::Read(file, ubo.MemberSize)
+				&& Utils::Read(file, uboMemberCount);
+
+			for (uint32_t j = 0; valid && j < uboMemberCount; j++)
+				valid = Utils::ReadMember(file, ubo.Members.emplace_back());
+		}
+
+		valid = valid && Utils::Read(file, ssboCount);
+		for (uint32_t i = 0; valid && i < ssboCount; i++)
+		{
+			ShaderUniformBuffer& ssbo = resource.ReflectedSSBOs.emplace_back();
+			valid = Utils::Read(file, ssbo.BufferSize) && Utils::Read(file, ssbo.Binding) && Utils::Read(file, ssbo.MemberSize);
+		}
+
+		valid = valid && Utils::Read(file, memberCount);
+		for (uint32_t i = 0; valid && i < memberCount; i++)
+			valid = Utils::ReadMember(file, resource.ReflectedMembers.emplace_back());
+
+		if (!valid)
+		{
+			LOG("Shader cache entry for '%s' is truncated, recompiling\n", name.c_str());
+			outSpirv.clear();
+			s_Stats.Misses++;
+			return false;
+		}
+
+		outResource = resource;
+
+		float loadTimeMs = timer.ElapsedMillis();
+		s_Stats.Hits++;
+		s_Stats.LoadTimeMs += loadTimeMs;
+		s_Stats.TimeSavedMs += compileTimeMs - loadTimeMs;
+		return true;
+	}
+
+	void ShaderCache::Store(const std::string& name, ShaderModuleTypes type, uint64_t key, const std::vector<uint32_t>& spirv, const ShaderResource& resource, float compileTimeMs)
+	{
+		s_Stats.CompileTimeMs += compileTimeMs;
+
+		std::error_code error;
+		std::filesystem::create_directories(s_CacheDirectory, error);
+
+		// Write to a temp file first so a crash mid write can never leave a half written entry behind
+		std::string path = GetEntryPath(name, type, key);
+		std::string tempPath = path + ".tmp";
+		{
+			std::ofstream file(tempPath, std::ios::out | std::ios::binary | std::ios::trunc);
+			if (!file)
+			{
+				LOG("Could not write shader cache entry '%s'\n", path.c_str());
+				return;
+			}
+
+			Utils::Write(file, s_CacheMagic);
+			Utils::Write(file, s_CacheVersion);
+			Utils::Write(file, key);
+			Utils::Write(file, compileTimeMs);
+
+			Utils::Write(file, (uint32_t)spirv.size());
+			file.write((const char*)spirv.data(), spirv.size() * sizeof(uint32_t));
+
+			Utils::WriteString(file, resource.Name);
+			Utils::Write(file, resource.Type);
+			Utils::Write(file, resource.UniformBufferSize);
+			Utils::Write(file, resource.ImageBufferSize);
+			Utils::Write(file, resource.StorageBufferSize);
+			Utils::Write(file, resource.PushConstantSize);
+
+			Utils::Write(file, (uint32_t)resource.ReflectedUBOs.size());
+			for (auto& ubo : resource.ReflectedUBOs)
+			{
+				Utils::Write(file, ubo.BufferSize);
+				Utils::Write(file, ubo.Binding);
+				Utils::Write(file, ubo.MemberSize);
+				Utils::Write(file, (uint32_t)ubo.Members.size());
+				for (auto& member : ubo.Members)
+					Utils::WriteMember(file, member);
+			}
+
+			Utils::Write(file, (uint32_t)resource.ReflectedSSBOs.size());
+			for (auto& ssbo : resource.ReflectedSSBOs)
+			{
+				Utils::Write(file, ssbo.BufferSize);
+				Utils::Write(file, ssbo.Binding);
+				Utils::Write(file, ssbo.MemberSize);
+			}
+
+			Utils::Write(file, (uint32_t)resource.ReflectedMembers.size());
+			for (auto& member : resource.ReflectedMembers)
+				Utils::WriteMember(file, member);
+		}
+
+		std::filesystem::rename(tempPath, path, error);
+		if (error)
+			LOG("Could not write shader cache entry '%s'\n", path.c_str());
+	}
+
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Shader.h"
+
+namespace Rose
+{
+
+	struct ShaderCacheStats
+	{
+		uint32_t Hits = 0;
+		uint32_t Misses = 0;
+
+		float CompileTimeMs = 0.0f; // Time spent in shaderc + spirv_cross on misses
+		float LoadTimeMs = 0.0f; // Time spent reading cache entries on hits
+		float TimeSavedMs = 0.0f; // Recorded compile time of every hit minus what it took to load it
+	};
+
+	// Content addressed on disk cache of compiled SPIR-V and the reflected ShaderResource for a single stage.
+	// Entries are keyed by the stage source, the stage, the compile options and the shaderc build (SDK version and library file)
+	// so any change to one of those simply misses and writes a new entry.
+	class ShaderCache
+	{
+		public :
+			static uint64_t ComputeKey(const std::string& source, ShaderModuleTypes type, const std::string& optionsSignature);
+
+			static bool Load(const std::string& name, ShaderModuleTypes type, uint64_t key, std::vector<uint32_t>& outSpirv, ShaderResource& outResource);
+			static void Store(const std::string& name, ShaderModuleTypes type, uint64_t key, const std::vector<uint32_t>& spirv, const ShaderResource& resource, float compileTimeMs);
+
+			static const ShaderCacheStats& GetStats() { return s_Stats; }
+
+		private :
+			static std::string GetEntryPath(const std::string& name, ShaderModuleTypes type, uint64_t key);
+
+		private :
+			static ShaderCacheStats s_Stats;
+	};
+
+}
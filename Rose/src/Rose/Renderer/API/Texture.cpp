@@ -6,6 +6,7 @@
 
 #include "Rose/Core/Application.h"
 #include "Rose/Core/Skybox.h"
+#include "UploadManager.h"
 
 
 namespace Rose
@@ -44,21 +45,8 @@ namespace Rose
 			return;
 		}
 
-		VKMemAllocator allocator;
-
-		VkBuffer tempBuffer;
-		VkBufferCreateInfo bufferInfo{};
-		bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-		bufferInfo.size = size;
-		bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-
-		VmaAllocation tempAllocation =  allocator.AllocateBuffer(bufferInfo, VMA_MEMORY_USAGE_CPU_TO_GPU, &tempBuffer);
-
-
-		void* temp;
-		allocator.Map(tempAllocation, &temp);
-		memcpy(temp, textureBuffer, size);
-		allocator.UnMap(tempAllocation);
+		// Staged before anything is recorded for this texture, staging can submit the current batch when the ring is full
+		StagingRegion staging = UploadManager::Stage(textureBuffer, size);
 
 		VkFormat imgFormat = VK_FORMAT_R8G8B8A8_SRGB;
 		if(m_Props.IsNormalMap)
@@ -72,10 +60,18 @@ namespace Rose
 
 
 		m_Image->TransitionLayout(imgFormat, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-		m_Image->CopyBufferToImage(tempBuffer, m_Width, m_Height);
+		m_Image->CopyBufferToImage(staging.Buffer, m_Width, m_Height, staging.Offset);
+
+		// Every level was transitioned by the copy queue, the graphics queue generates the mips from here
+		VkImageSubresourceRange ownershipRange{};
+		ownershipRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		ownershipRange.baseMipLevel = 0;
+		ownershipRange.levelCount = m_MipLevel;
+		ownershipRange.baseArrayLayer = 0;
+		ownershipRange.layerCount = 1;
+		UploadManager::TransferOwnership(m_Image->GetImageBuffer(), ownershipRange, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
 		//m_Image->TransitionLayout(imgFormat, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
 
-		allocator.Free(tempAllocation, tempBuffer);
 		stbi_image_free(textureBuffer);
 
 
@@ -96,6 +92,10 @@ namespace Rose
 
 	void Texture2D::Destroy()
 	{
+		// Textures are shared between materials, so this can be reached more than once
+		if (m_IsFreed)
+			return;
+
 		m_IsFreed = true;
 		auto& device = Application::Get().GetContext()->GetLogicalDevice()->GetDevice();
 
@@ -141,7 +141,6 @@ namespace Rose
 	void Texture2D::GenerateMips(VkFormat imageFormat)
 	{
 
-		auto& device = Application::Get().GetContext()->GetLogicalDevice();
 		auto& physicalDevice = Application::Get().GetContext()->GetPhysicalDevice();
 
 		VkFormatProperties formatProperties;
@@ -154,20 +153,8 @@ namespace Rose
 
 
 
-		VkCommandBufferAllocateInfo allocInfo{};
-		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-		allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-		allocInfo.commandPool = device->GetCommandPool();
-		allocInfo.commandBufferCount = 1;
-
-		VkCommandBuffer commandBuffer;
-		vkAllocateCommandBuffers(device->GetDevice(), &allocInfo, &commandBuffer);
-
-		VkCommandBufferBeginInfo beginInfo{};
-		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-
-		vkBeginCommandBuffer(commandBuffer, &beginInfo);
+		// Blits need the graphics queue, this half of the batch runs once the copy is done
+		VkCommandBuffer commandBuffer = UploadManager::GetGraphicsCommandBuffer();
 
 
 		auto& image = m_Image->GetImageBuffer();
@@ -250,17 +237,6 @@ namespace Rose
 
 
 
-		vkEndCommandBuffer(commandBuffer);
-
-		VkSubmitInfo submitInfo{};
-		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-		submitInfo.commandBufferCount = 1;
-		submitInfo.pCommandBuffers = &commandBuffer;
-
-		vkQueueSubmit(device->GetQueue(), 1, &submitInfo, VK_NULL_HANDLE);
-		vkQueueWaitIdle(device->GetQueue());
-
-		vkFreeCommandBuffers(device->GetDevice(), device->GetCommandPool(), 1, &commandBuffer);
 
 
 	}
@@ -315,12 +291,6 @@ namespace Rose
 		m_MipLevel = (uint32_t)std::floor(std::log2(std::max(m_Width, m_Height))) + 1;
 
 
-	
-
-		
-		auto& device = Application::Get().GetContext()->GetLogicalDevice();
-
-
 		uint32_t layerSize = size / 6;
 		VkFormat imgFormat = VK_FORMAT_R8G8B8A8_UNORM;
 		if (isHDRI)
@@ -344,39 +314,14 @@ namespace Rose
 		imageCreateInfo.flags = VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT;
 		m_ImageMemoryAllocation = allocator.AllocateImage(imageCreateInfo, VMA_MEMORY_USAGE_GPU_ONLY, &m_Image);
 
-		VkBufferCreateInfo bufferCreateInfo{};
-		bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-		bufferCreateInfo.size = size;
-		bufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-		bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-		VkBuffer stagingBuffer;
-		VmaAllocation  tempAllocation = allocator.AllocateBuffer(bufferCreateInfo, VMA_MEMORY_USAGE_CPU_TO_GPU, &stagingBuffer);
-
-
-		uint8_t* temp;
-		vmaMapMemory(VKMemAllocator::GetVMAAllocator(), tempAllocation, (void**)&temp);
+		StagingRegion staging = UploadManager::AllocateStaging(size);
 		for(int i = 0; i < textureBuffers.size(); i++)
 		{
-			memcpy(temp + (layerSize * i), textureBuffers[i], layerSize);
+			memcpy(staging.Data + (layerSize * i), textureBuffers[i], layerSize);
 		}
-		
-		vmaUnmapMemory(VKMemAllocator::GetVMAAllocator(), tempAllocation);
-
-
-		VkCommandBufferAllocateInfo allocInfo{};
-		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-		allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-		allocInfo.commandPool = device->GetCommandPool();
-		allocInfo.commandBufferCount = 1;
 
-		VkCommandBuffer commandBuffer;
-		vkAllocateCommandBuffers(device->GetDevice(), &allocInfo, &commandBuffer);
 
-		VkCommandBufferBeginInfo beginInfo{};
-		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-
-		vkBeginCommandBuffer(commandBuffer, &beginInfo);
+		VkCommandBuffer commandBuffer = UploadManager::GetCommandBuffer();
 
 		VkImageSubresourceRange subresourceRange = {};
 		subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
@@ -412,99 +357,24 @@ namespace Rose
 		bufferCopyRegion.imageExtent.width = m_Width;
 		bufferCopyRegion.imageExtent.height = m_Height;
 		bufferCopyRegion.imageExtent.depth = 1;
-		bufferCopyRegion.bufferOffset = 0;
+		bufferCopyRegion.bufferOffset = staging.Offset;
 
 		vkCmdCopyBufferToImage(
 			commandBuffer,
-			stagingBuffer,
+			staging.Buffer,
 			m_Image,
 			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
 			1,
 			&bufferCopyRegion);
 
-		VkImageMemoryBarrier imageMemoryBarrier2{};
-		imageMemoryBarrier2.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-		imageMemoryBarrier2.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-		imageMemoryBarrier2.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-
-		imageMemoryBarrier2.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-		imageMemoryBarrier2.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-		imageMemoryBarrier2.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-		imageMemoryBarrier2.newLayout = VK_IMAGE_LAYOUT_GENERAL;
-		imageMemoryBarrier2.image = m_Image;
-		imageMemoryBarrier2.subresourceRange = subresourceRange;
-
-		vkCmdPipelineBarrier(
-			commandBuffer,
-			VK_PIPELINE_STAGE_TRANSFER_BIT,
-			VK_PIPELINE_STAGE_TRANSFER_BIT,
-			0,
-			0, nullptr,
-			0, nullptr,
-			1, &imageMemoryBarrier2);
+		// Mips are generated on the graphics queue
+		UploadManager::TransferOwnership(m_Image, subresourceRange, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_GENERAL);
 		
-		vkEndCommandBuffer(commandBuffer);
-
-		VkSubmitInfo submitInfo{};
-		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-		submitInfo.commandBufferCount = 1;
-		submitInfo.pCommandBuffers = &commandBuffer;
-
-		vkQueueSubmit(device->GetQueue(), 1, &submitInfo, VK_NULL_HANDLE);
-		vkQueueWaitIdle(device->GetQueue());
-
-		vkFreeCommandBuffers(device->GetDevice(), device->GetCommandPool(), 1, &commandBuffer);
 
 		for (auto& buffer : textureBuffers)
 		{
 			stbi_image_free(buffer);
 		}
-		allocator.Free(tempAllocation, stagingBuffer);
-
-
-
-		VkCommandBufferAllocateInfo allocInfo2{};
-		allocInfo2.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-		allocInfo2.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-		allocInfo2.commandPool = device->GetCommandPool();
-		allocInfo2.commandBufferCount = 1;
-
-		VkCommandBuffer layoutCommand;
-		vkAllocateCommandBuffers(device->GetDevice(), &allocInfo2, &layoutCommand);
-
-		VkCommandBufferBeginInfo beginInfo2{};
-		beginInfo2.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-		beginInfo2.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-
-		vkBeginCommandBuffer(layoutCommand, &beginInfo2);
-
-		VkImageSubresourceRange subresourceRange2 = {};
-		subresourceRange2.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-		subresourceRange2.baseMipLevel = 0;
-		subresourceRange2.levelCount = m_MipLevel;
-		subresourceRange2.layerCount = 6;
-
-
-		VkImageMemoryBarrier imageMemoryBarrier3 = {};
-		imageMemoryBarrier3.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-		imageMemoryBarrier3.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-		imageMemoryBarrier3.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-		imageMemoryBarrier3.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-		imageMemoryBarrier3.newLayout = VK_IMAGE_LAYOUT_GENERAL;
-		imageMemoryBarrier3.image = m_Image;
-		imageMemoryBarrier3.subresourceRange = subresourceRange2;
-		imageMemoryBarrier3.srcAccessMask = 0;
-
-		vkCmdPipelineBarrier(
-			layoutCommand,
-			VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
-			VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
-			0,
-			0, nullptr,
-			0, nullptr,
-			1, &imageMemoryBarrier3);
-
-
 
 
 		CreateSampler();
@@ -538,6 +408,9 @@ namespace Rose
 
 	void TextureCube::Destroy()
 	{
+		if (m_IsFreed)
+			return;
+
 		m_IsFreed = true;
 		auto& device = Application::Get().GetContext()->GetLogicalDevice()->GetDevice();
 
@@ -575,7 +448,6 @@ namespace Rose
 
 	void TextureCube::GenerateMips(VkFormat imageFormat)
 	{
-		auto& device = Application::Get().GetContext()->GetLogicalDevice();
 		auto& physicalDevice = Application::Get().GetContext()->GetPhysicalDevice();
 
 		VkFormatProperties formatProperties;
@@ -588,20 +460,8 @@ namespace Rose
 
 
 
-		VkCommandBufferAllocateInfo allocInfo{};
-		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-		allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-		allocInfo.commandPool = device->GetCommandPool();
-		allocInfo.commandBufferCount = 1;
-
-		VkCommandBuffer commandBuffer;
-		vkAllocateCommandBuffers(device->GetDevice(), &allocInfo, &commandBuffer);
-
-		VkCommandBufferBeginInfo beginInfo{};
-		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-
-		vkBeginCommandBuffer(commandBuffer, &beginInfo);
+		// Blits need the graphics queue, this half of the batch runs once the copy is done
+		VkCommandBuffer commandBuffer = UploadManager::GetGraphicsCommandBuffer();
 
 
 
@@ -753,17 +613,6 @@ namespace Rose
 			1, &imageMemoryBarrier3);
 
 
-		vkEndCommandBuffer(commandBuffer);
-
-		VkSubmitInfo submitInfo{};
-		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-		submitInfo.commandBufferCount = 1;
-		submitInfo.pCommandBuffers = &commandBuffer;
-
-		vkQueueSubmit(device->GetQueue(), 1, &submitInfo, VK_NULL_HANDLE);
-		vkQueueWaitIdle(device->GetQueue());
-
-		vkFreeCommandBuffers(device->GetDevice(), device->GetCommandPool(), 1, &commandBuffer);
 
 
 	}
@@ -774,8 +623,15 @@ namespace Rose
 
 
 
+	std::shared_ptr<TextureCube> EnviormentTexture::s_IrradianceMap;
+	std::shared_ptr<TextureCube> EnviormentTexture::s_RadienceMap;
+	std::shared_ptr<Texture2D> EnviormentTexture::s_SpecularBRDF;
+
 	std::shared_ptr<TextureCube> EnviormentTexture::GetIrradianceMap()
 	{
+		if (s_IrradianceMap)
+			return s_IrradianceMap;
+
 #if USESKY2
 
 		TextureCubeFiles files =
@@ -800,12 +656,15 @@ namespace Rose
 		};
 #endif
 
-		static std::shared_ptr<TextureCube> Instance = std::make_shared<TextureCube>(files);
-		return Instance;
+		s_IrradianceMap = std::make_shared<TextureCube>(files);
+		return s_IrradianceMap;
 	}
 
 	std::shared_ptr<TextureCube> EnviormentTexture::GetRadienceMap()
 	{
+		if (s_RadienceMap)
+			return s_RadienceMap;
+
 #if USESKY2
 
  		TextureCubeFiles files =
@@ -829,15 +688,25 @@ namespace Rose
 			"assets/textures/skybox/sky1/rad/output_pmrem_negz_0_256x256.tga",
 		};
 #endif
-		static std::shared_ptr<TextureCube> Instance = std::make_shared<TextureCube>(files);
-		return Instance;
+		s_RadienceMap = std::make_shared<TextureCube>(files);
+		return s_RadienceMap;
 	}
 
 	std::shared_ptr<Texture2D> EnviormentTexture::GetSpecularBRDF()
 	{
+		if (s_SpecularBRDF)
+			return s_SpecularBRDF;
+
 		TextureProperties props = { false };
-		static std::shared_ptr<Texture2D> Instance = std::make_shared<Texture2D>("assets/textures/specularBRDF.png", props);
-		return Instance;
+		s_SpecularBRDF = std::make_shared<Texture2D>("assets/textures/specularBRDF.png", props);
+		return s_SpecularBRDF;
+	}
+
+	void EnviormentTexture::Shutdown()
+	{
+		s_IrradianceMap.reset();
+		s_RadienceMap.reset();
+		s_SpecularBRDF.reset();
 	}
 
 	
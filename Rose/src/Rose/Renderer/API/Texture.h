@@ -93,7 +93,13 @@ namespace Rose
 			static std::shared_ptr<TextureCube> GetIrradianceMap();
 			static std::shared_ptr<TextureCube> GetRadienceMap();
 			static std::shared_ptr<Texture2D> GetSpecularBRDF();
-			
+			// Drops the engine's references on shutdown, each texture goes with the last material using it
+			static void Shutdown();
+
+		private :
+			static std::shared_ptr<TextureCube> s_IrradianceMap;
+			static std::shared_ptr<TextureCube> s_RadienceMap;
+			static std::shared_ptr<Texture2D> s_SpecularBRDF;
 	};
 
 }
\ No newline at end of file
@@ -0,0 +1,72 @@
+#include "TextureCache.h"
+#include "Rose/Core/Log.h"
+
+#include <filesystem>
+
+namespace Rose
+{
+
+	std::unordered_map<std::string, std::weak_ptr<Texture2D>> TextureCache::s_Textures;
+	uint32_t TextureCache::s_Hits = 0;
+	uint32_t TextureCache::s_Misses = 0;
+
+
+	std::string TextureCache::MakeKey(const std::string& filepath, const TextureProperties& props)
+	{
+		// Models reference the same file through different relative paths ("./a/../b.png", "b.png")
+		std::error_code error;
+		std::filesystem::path canonical = std::filesystem::weakly_canonical(filepath, error);
+		std::string path = error ? std::filesystem::path(filepath).lexically_normal().generic_string() : canonical.generic_string();
+
+		return path + (props.IsNormalMap ? "|normal" : "|color");
+	}
+
+	std::shared_ptr<Texture2D> TextureCache::Get(const std::string& filepath, const TextureProperties& props)
+	{
+		std::string key = MakeKey(filepath, props);
+
+		auto it = s_Textures.find(key);
+		if (it != s_Textures.end())
+		{
+			if (auto texture = it->second.lock())
+			{
+				s_Hits++;
+				return texture;
+			}
+		}
+
+		s_Misses++;
+		auto texture = std::make_shared<Texture2D>(filepath, props);
+		s_Textures[key] = texture;
+		return texture;
+	}
+
+	void TextureCache::Evict()
+	{
+		for (auto it = s_Textures.begin(); it != s_Textures.end();)
+		{
+			if (it->second.expired())
+				it = s_Textures.erase(it);
+			else
+				it++;
+		}
+	}
+
+	void TextureCache::Shutdown()
+	{
+		LOG("Texture cache: %d hits, %d misses, %d textures still alive\n", s_Hits, s_Misses, GetLiveCount());
+		s_Textures.clear();
+	}
+
+	uint32_t TextureCache::GetLiveCount()
+	{
+		uint32_t count = 0;
+		for (auto& [key, texture] : s_Textures)
+		{
+			if (!texture.expired())
+				count++;
+		}
+		return count;
+	}
+
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <string>
+#include <memory>
+#include <unordered_map>
+
+#include "Texture.h"
+
+namespace Rose
+{
+
+	// Hands out shared textures keyed by canonical path and TextureProperties so the same file is only decoded and uploaded once.
+	// Only weak handles are kept, a texture is destroyed as soon as the last material using it lets go.
+	class TextureCache
+	{
+		public :
+			static std::shared_ptr<Texture2D> Get(const std::string& filepath, const TextureProperties& props = TextureProperties());
+
+			// Drops entries whose texture has already been destroyed, models call it once they let go of theirs
+			static void Evict();
+			static void Shutdown();
+
+			static uint32_t GetHits() { return s_Hits; }
+			static uint32_t GetMisses() { return s_Misses; }
+			static uint32_t GetLiveCount();
+
+		private :
+			static std::string MakeKey(const std::string& filepath, const TextureProperties& props);
+
+		private :
+			static std::unordered_map<std::string, std::weak_ptr<Texture2D>> s_Textures;
+			static uint32_t s_Hits, s_Misses;
+	};
+
+}
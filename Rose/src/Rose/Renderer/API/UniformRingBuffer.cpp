@@ -0,0 +1,89 @@
+#include "UniformRingBuffer.h"
+
+#include "Rose/Core/Application.h"
+#include "Rose/Core/Log.h"
+
+#include <cstring>
+
+namespace Rose
+{
+
+	VkBuffer UniformRingBuffer::s_Buffer = VK_NULL_HANDLE;
+	VmaAllocation UniformRingBuffer::s_Allocation = nullptr;
+	uint8_t* UniformRingBuffer::s_MappedData = nullptr;
+
+	uint32_t UniformRingBuffer::s_FrameSize = 0;
+	uint32_t UniformRingBuffer::s_FrameStart = 0;
+	uint32_t UniformRingBuffer::s_Head = 0;
+	uint32_t UniformRingBuffer::s_Alignment = 256;
+
+
+	void UniformRingBuffer::Init(uint32_t frameSize, uint32_t framesInFlight)
+	{
+		const auto& props = Application::Get().GetContext()->GetPhysicalDevice()->GetProperties();
+		s_Alignment = (uint32_t)props.limits.minUniformBufferOffsetAlignment;
+		if (!s_Alignment)
+			s_Alignment = 1;
+
+		s_FrameSize = (frameSize + s_Alignment - 1) & ~(s_Alignment - 1);
+
+		VkBufferCreateInfo bufferInfo{};
+		bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		bufferInfo.size = (VkDeviceSize)s_FrameSize * framesInFlight;
+		bufferInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+		bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+		VKMemAllocator allocator;
+		s_Allocation = allocator.AllocateBuffer(bufferInfo, VMA_MEMORY_USAGE_CPU_TO_GPU, &s_Buffer);
+
+		// Stays mapped for the lifetime of the buffer, writing is just a memcpy
+		void* data = nullptr;
+		allocator.Map(s_Allocation, &data);
+		s_MappedData = (uint8_t*)data;
+
+		s_FrameStart = 0;
+		s_Head = 0;
+	}
+
+	void UniformRingBuffer::Shutdown()
+	{
+		VKMemAllocator allocator;
+		allocator.UnMap(s_Allocation);
+		allocator.Free(s_Allocation, s_Buffer);
+
+		s_MappedData = nullptr;
+		s_Buffer = VK_NULL_HANDLE;
+	}
+
+	void UniformRingBuffer::BeginFrame(uint32_t frameIndex)
+	{
+		s_FrameStart = frameIndex * s_FrameSize;
+		s_Head = s_FrameStart;
+	}
+
+	uint32_t UniformRingBuffer::Push(const void* data, uint32_t size)
+	{
+		uint32_t alignedSize = (size + s_Alignment - 1) & ~(s_Alignment - 1);
+
+		if (s_Head + alignedSize > s_FrameStart + s_FrameSize)
+		{
+			LOG("Uniform ring buffer is out of space! (frame size: %d, requested: %d)\n", s_FrameSize, size);
+			ASSERT();
+			return s_FrameStart;
+		}
+
+		uint32_t offset = s_Head;
+		memcpy(s_MappedData + offset, data, size);
+		s_Head += alignedSize;
+
+		return offset;
+	}
+
+	void UniformRingBuffer::Flush()
+	{
+		// CPU_TO_GPU memory isn't guaranteed to be host coherent, this is a no-op when it is
+		if (s_Head > s_FrameStart)
+			vmaFlushAllocation(VKMemAllocator::GetVMAAllocator(), s_Allocation, s_FrameStart, s_Head - s_FrameStart);
+	}
+
+}
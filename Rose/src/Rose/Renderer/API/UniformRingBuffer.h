@@ -0,0 +1,44 @@
+#pragma once
+
+#include <vulkan1.2.182.0/include/Vulkan/vulkan/vulkan.h>
+#include "VKMemAllocator.h"
+
+namespace Rose
+{
+
+	// One persistently mapped uniform buffer split into a region per frame in flight.
+	// Every frame the region of the current frame is reset and uniform data is linearly sub allocated from it,
+	// the returned offsets are meant to be used as dynamic offsets (VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC).
+	class UniformRingBuffer
+	{
+		public :
+			static void Init(uint32_t frameSize, uint32_t framesInFlight);
+			static void Shutdown();
+
+			static void BeginFrame(uint32_t frameIndex);
+
+			// Copies the data into the current frame's region and returns its offset from the start of the buffer
+			static uint32_t Push(const void* data, uint32_t size);
+
+			template<typename T>
+			static uint32_t Push(const T& data) { return Push(&data, sizeof(T)); }
+
+			// Must be called once everything for the frame is pushed, before the frame is submitted
+			static void Flush();
+
+			static VkBuffer GetBuffer() { return s_Buffer; }
+			static uint32_t GetFrameUsage() { return s_Head - s_FrameStart; }
+			static uint32_t GetFrameSize() { return s_FrameSize; }
+
+		private :
+			static VkBuffer s_Buffer;
+			static VmaAllocation s_Allocation;
+			static uint8_t* s_MappedData;
+
+			static uint32_t s_FrameSize;
+			static uint32_t s_FrameStart;
+			static uint32_t s_Head;
+			static uint32_t s_Alignment;
+	};
+
+}
@@ -0,0 +1,473 @@
+#include "UploadManager.h"
+
+#include "Rose/Core/Application.h"
+#include "Rose/Core/Log.h"
+
+#include <cstring>
+
+namespace Rose
+{
+
+	bool UploadManager::s_SeparateQueues = false;
+	VkCommandPool UploadManager::s_TransferCommandPool = VK_NULL_HANDLE;
+	VkCommandPool UploadManager::s_GraphicsCommandPool = VK_NULL_HANDLE;
+
+	VkSemaphore UploadManager::s_Timeline = VK_NULL_HANDLE;
+	uint64_t UploadManager::s_TimelineValue = 0;
+
+	VkBuffer UploadManager::s_StagingBuffer = VK_NULL_HANDLE;
+	VmaAllocation UploadManager::s_StagingAllocation = nullptr;
+	uint8_t* UploadManager::s_MappedData = nullptr;
+
+	VkDeviceSize UploadManager::s_StagingSize = 0;
+	VkDeviceSize UploadManager::s_Head = 0;
+	VkDeviceSize UploadManager::s_Tail = 0;
+
+	bool UploadManager::s_Recording = false;
+	UploadManager::UploadBatch UploadManager::s_Current;
+	std::deque<UploadManager::UploadBatch> UploadManager::s_InFlight;
+	std::vector<UploadManager::UploadBatch> UploadManager::s_FreeBatches;
+
+	UploadStats UploadManager::s_Stats;
+
+	// Covers the texel size of every format we upload (RGBA32F is 16 bytes) and the 4 byte copy offset rule
+	static constexpr VkDeviceSize s_StagingAlignment = 16;
+	// The graphics half waits on the copies here, and every acquire barrier starts from it. Textures, vertex input and compute
+	// all read what was uploaded, so the wait covers every stage rather than just the first one that happens to consume it
+	static constexpr VkPipelineStageFlags s_AcquireWaitStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+
+
+	void UploadManager::Init(VkDeviceSize stagingSize)
+	{
+		auto& context = Application::Get().GetContext();
+		auto& device = context->GetLogicalDevice()->GetDevice();
+
+		const auto& families = context->GetPhysicalDevice()->GetQueueFamily();
+		s_SeparateQueues = context->GetLogicalDevice()->HasDedicatedTransferQueue();
+
+		VkCommandPoolCreateInfo poolInfo{};
+		poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+		poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT | VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+		poolInfo.queueFamilyIndex = families.Transfer;
+		vkCreateCommandPool(device, &poolInfo, nullptr, &s_TransferCommandPool);
+
+		if (s_SeparateQueues)
+		{
+			poolInfo.queueFamilyIndex = families.Graphics;
+			vkCreateCommandPool(device, &poolInfo, nullptr, &s_GraphicsCommandPool);
+		}
+		else
+			s_GraphicsCommandPool = s_TransferCommandPool;
+
+		VkSemaphoreTypeCreateInfo timelineInfo{};
+		timelineInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+		timelineInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+		timelineInfo.initialValue = 0;
+
+		VkSemaphoreCreateInfo semaphoreInfo{};
+		semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+		semaphoreInfo.pNext = &timelineInfo;
+		vkCreateSemaphore(device, &semaphoreInfo, nullptr, &s_Timeline);
+		s_TimelineValue = 0;
+
+		s_StagingSize = (stagingSize + s_StagingAlignment - 1) & ~(s_StagingAlignment - 1);
+
+		VkBufferCreateInfo bufferInfo{};
+		bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		bufferInfo.size = s_StagingSize;
+		bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+		bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+		VKMemAllocator allocator;
+		s_StagingAllocation = allocator.AllocateBuffer(bufferInfo, VMA_MEMORY_USAGE_CPU_TO_GPU, &s_StagingBuffer);
+
+		void* data = nullptr;
+		allocator.Map(s_StagingAllocation, &data);
+		s_MappedData = (uint8_t*)data;
+
+		s_Head = 0;
+		s_Tail = 0;
+		s_Recording = false;
+		s_Stats = UploadStats();
+	}
+
+	void UploadManager::Shutdown()
+	{
+		WaitIdle();
+
+		auto& device = Application::Get().GetContext()->GetLogicalDevice()->GetDevice();
+		for (auto& batch : s_FreeBatches)
+		{
+			vkDestroyFence(device, batch.Fence, nullptr);
+		}
+		s_FreeBatches.clear();
+
+		// Frees every command buffer that was allocated from them
+		vkDestroyCommandPool(device, s_TransferCommandPool, nullptr);
+		if (s_SeparateQueues)
+			vkDestroyCommandPool(device, s_GraphicsCommandPool, nullptr);
+		s_TransferCommandPool = VK_NULL_HANDLE;
+		s_GraphicsCommandPool = VK_NULL_HANDLE;
+
+		vkDestroySemaphore(device, s_Timeline, nullptr);
+		s_Timeline = VK_NULL_HANDLE;
+
+		VKMemAllocator allocator;
+		allocator.UnMap(s_StagingAllocation);
+		allocator.Free(s_StagingAllocation, s_StagingBuffer);
+
+		s_MappedData = nullptr;
+		s_StagingBuffer = VK_NULL_HANDLE;
+	}
+
+	VkCommandBuffer UploadManager::GetCommandBuffer()
+	{
+		if (!s_Recording)
+			BeginBatch();
+
+		return s_Current.CommandBuffer;
+	}
+
+	VkCommandBuffer UploadManager::GetGraphicsCommandBuffer()
+	{
+		if (!s_Recording)
+			BeginBatch();
+
+		return s_Current.GraphicsCommandBuffer;
+	}
+
+	void UploadManager::TransferOwnership(VkImage image, const VkImageSubresourceRange& range, VkImageLayout oldLayout, VkImageLayout newLayout)
+	{
+		const auto& families = Application::Get().GetContext()->GetPhysicalDevice()->GetQueueFamily();
+
+		VkImageMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		barrier.image = image;
+		barrier.subresourceRange = range;
+		barrier.oldLayout = oldLayout;
+		barrier.newLayout = newLayout;
+
+		if (!s_SeparateQueues)
+		{
+			barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+
+			vkCmdPipelineBarrier(GetCommandBuffer(), VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+			return;
+		}
+
+		// Both barriers have to match exactly, the layout transition happens once between the release and the acquire
+		barrier.srcQueueFamilyIndex = families.Transfer;
+		barrier.dstQueueFamilyIndex = families.Graphics;
+
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = 0;
+		vkCmdPipelineBarrier(GetCommandBuffer(), VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+		// Its source scope has to be the stage the graphics half waits on the timeline at, otherwise the acquire isn't chained to the wait
+		barrier.srcAccessMask = 0;
+		barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+		vkCmdPipelineBarrier(GetGraphicsCommandBuffer(), s_AcquireWaitStage, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+		s_Stats.OwnershipTransfers++;
+	}
+
+	void UploadManager::TransferOwnership(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size, VkAccessFlags dstAccess, VkPipelineStageFlags dstStage)
+	{
+		const auto& families = Application::Get().GetContext()->GetPhysicalDevice()->GetQueueFamily();
+
+		VkBufferMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+		barrier.buffer = buffer;
+		barrier.offset = offset;
+		barrier.size = size;
+
+		if (!s_SeparateQueues)
+		{
+			barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			barrier.dstAccessMask = dstAccess;
+
+			vkCmdPipelineBarrier(GetCommandBuffer(), VK_PIPELINE_STAGE_TRANSFER_BIT, dstStage, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+			return;
+		}
+
+		barrier.srcQueueFamilyIndex = families.Transfer;
+		barrier.dstQueueFamilyIndex = families.Graphics;
+
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = 0;
+		vkCmdPipelineBarrier(GetCommandBuffer(), VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+
+		// Same as for images, starting from the wait stage is what orders vertex input and compute reads after the copy
+		barrier.srcAccessMask = 0;
+		barrier.dstAccessMask = dstAccess;
+		vkCmdPipelineBarrier(GetGraphicsCommandBuffer(), s_AcquireWaitStage, dstStage, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+
+		s_Stats.OwnershipTransfers++;
+	}
+
+	StagingRegion UploadManager::AllocateStaging(VkDeviceSize size)
+	{
+		// The region has to belong to the batch the caller records into next
+		GetCommandBuffer();
+
+		StagingRegion region;
+		if (size > s_StagingSize)
+		{
+			// Too big for the ring, give it its own buffer which is freed together with the batch
+			VkBufferCreateInfo bufferInfo{};
+			bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+			bufferInfo.size = size;
+			bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+			bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+			VKMemAllocator allocator;
+			VkBuffer buffer;
+			VmaAllocation allocation = allocator.AllocateBuffer(bufferInfo, VMA_MEMORY_USAGE_CPU_TO_GPU, &buffer);
+
+			void* data = nullptr;
+			allocator.Map(allocation, &data);
+
+			s_Current.DedicatedBuffers.push_back({ buffer, allocation });
+			s_Stats.DedicatedStagingBuffers++;
+			s_Stats.BytesStaged += size;
+
+			region.Buffer = buffer;
+			region.Offset = 0;
+			region.Data = (uint8_t*)data;
+			return region;
+		}
+
+		VkDeviceSize offset = 0;
+		while (!TryAllocate(size, offset))
+		{
+			// Whatever the current batch staged can only be reclaimed once it's submitted
+			if (s_Recording)
+				Submit();
+
+			if (s_InFlight.empty())
+			{
+				LOG("Upload manager could not allocate %d bytes of staging memory!\n", (uint32_t)size);
+				ASSERT();
+				break;
+			}
+
+			RetireOldest();
+		}
+
+		// Submitting may have closed the batch, the region belongs to the next one
+		GetCommandBuffer();
+
+		s_Stats.BytesStaged += size;
+
+		region.Buffer = s_StagingBuffer;
+		region.Offset = offset;
+		region.Data = s_MappedData + offset;
+		return region;
+	}
+
+	StagingRegion UploadManager::Stage(const void* data, VkDeviceSize size)
+	{
+		StagingRegion region = AllocateStaging(size);
+		memcpy(region.Data, data, size);
+		return region;
+	}
+
+	uint64_t UploadManager::Submit()
+	{
+		if (!s_Recording)
+			return s_TimelineValue;
+
+		auto& logicalDevice = Application::Get().GetContext()->GetLogicalDevice();
+
+		vkEndCommandBuffer(s_Current.CommandBuffer);
+		if (s_SeparateQueues)
+			vkEndCommandBuffer(s_Current.GraphicsCommandBuffer);
+
+		// CPU_TO_GPU memory isn't guaranteed to be host coherent, this is a no-op when it is
+		vmaFlushAllocation(VKMemAllocator::GetVMAAllocator(), s_StagingAllocation, 0, VK_WHOLE_SIZE);
+		for (auto& [buffer, allocation] : s_Current.DedicatedBuffers)
+		{
+			vmaFlushAllocation(VKMemAllocator::GetVMAAllocator(), allocation, 0, VK_WHOLE_SIZE);
+		}
+
+		s_Current.TimelineValue = ++s_TimelineValue;
+
+		VkTimelineSemaphoreSubmitInfo signalInfo{};
+		signalInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+		signalInfo.signalSemaphoreValueCount = 1;
+		signalInfo.pSignalSemaphoreValues = &s_Current.TimelineValue;
+
+		VkSubmitInfo submitInfo{};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.pNext = &signalInfo;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &s_Current.CommandBuffer;
+		submitInfo.signalSemaphoreCount = 1;
+		submitInfo.pSignalSemaphores = &s_Timeline;
+
+		if (s_SeparateQueues)
+		{
+			vkQueueSubmit(logicalDevice->GetTransferQueue(), 1, &submitInfo, VK_NULL_HANDLE);
+
+			// Acquire barriers start at the same stage, so whatever they make available is ordered after the copies.
+			// Rendering submitted before the graphics half keeps going, the wait only holds back what comes after it
+			VkTimelineSemaphoreSubmitInfo waitInfo{};
+			waitInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+			waitInfo.waitSemaphoreValueCount = 1;
+			waitInfo.pWaitSemaphoreValues = &s_Current.TimelineValue;
+
+			VkPipelineStageFlags waitStage = s_AcquireWaitStage;
+
+			VkSubmitInfo graphicsSubmitInfo{};
+			graphicsSubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+			graphicsSubmitInfo.pNext = &waitInfo;
+			graphicsSubmitInfo.waitSemaphoreCount = 1;
+			graphicsSubmitInfo.pWaitSemaphores = &s_Timeline;
+			graphicsSubmitInfo.pWaitDstStageMask = &waitStage;
+			graphicsSubmitInfo.commandBufferCount = 1;
+			graphicsSubmitInfo.pCommandBuffers = &s_Current.GraphicsCommandBuffer;
+
+			vkQueueSubmit(logicalDevice->GetQueue(), 1, &graphicsSubmitInfo, s_Current.Fence);
+		}
+		else
+			vkQueueSubmit(logicalDevice->GetQueue(), 1, &submitInfo, s_Current.Fence);
+
+		s_Current.StagingEnd = s_Head;
+		s_InFlight.push_back(std::move(s_Current));
+		s_Current = UploadBatch();
+		s_Recording = false;
+
+		s_Stats.Batches++;
+		return s_TimelineValue;
+	}
+
+	bool UploadManager::IsTransferComplete(uint64_t value)
+	{
+		uint64_t completed = 0;
+		vkGetSemaphoreCounterValue(Application::Get().GetContext()->GetLogicalDevice()->GetDevice(), s_Timeline, &completed);
+		return completed >= value;
+	}
+
+	void UploadManager::WaitIdle()
+	{
+		Submit();
+
+		while (!s_InFlight.empty())
+			RetireOldest();
+	}
+
+	bool UploadManager::TryAllocate(VkDeviceSize size, VkDeviceSize& outOffset)
+	{
+		// head == tail only ever means the ring is empty, allocations never fill it up to the tail
+		if (s_Head == s_Tail)
+		{
+			s_Head = 0;
+			s_Tail = 0;
+		}
+
+		VkDeviceSize alignedHead = (s_Head + s_StagingAlignment - 1) & ~(s_StagingAlignment - 1);
+
+		if (s_Head >= s_Tail)
+		{
+			// Free space is [head, end) and [0, tail)
+			if (alignedHead + size <= s_StagingSize)
+			{
+				outOffset = alignedHead;
+				s_Head = alignedHead + size;
+				return true;
+			}
+
+			if (size < s_Tail)
+			{
+				outOffset = 0;
+				s_Head = size;
+				return true;
+			}
+		}
+		else if (alignedHead + size < s_Tail)
+		{
+			outOffset = alignedHead;
+			s_Head = alignedHead + size;
+			return true;
+		}
+
+		return false;
+	}
+
+	void UploadManager::BeginBatch()
+	{
+		auto& device = Application::Get().GetContext()->GetLogicalDevice()->GetDevice();
+
+		// Recycle batches the GPU is already done with, never blocks
+		while (!s_InFlight.empty() && vkGetFenceStatus(device, s_InFlight.front().Fence) == VK_SUCCESS)
+			RetireOldest();
+
+		if (!s_FreeBatches.empty())
+		{
+			s_Current = std::move(s_FreeBatches.back());
+			s_FreeBatches.pop_back();
+			vkResetFences(device, 1, &s_Current.Fence);
+		}
+		else
+		{
+			VkCommandBufferAllocateInfo allocInfo{};
+			allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+			allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+			allocInfo.commandPool = s_TransferCommandPool;
+			allocInfo.commandBufferCount = 1;
+			vkAllocateCommandBuffers(device, &allocInfo, &s_Current.CommandBuffer);
+
+			if (s_SeparateQueues)
+			{
+				allocInfo.commandPool = s_GraphicsCommandPool;
+				vkAllocateCommandBuffers(device, &allocInfo, &s_Current.GraphicsCommandBuffer);
+			}
+			else
+				s_Current.GraphicsCommandBuffer = s_Current.CommandBuffer;
+
+			VkFenceCreateInfo fenceInfo{};
+			fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+			vkCreateFence(device, &fenceInfo, nullptr, &s_Current.Fence);
+		}
+
+		VkCommandBufferBeginInfo beginInfo{};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+		vkBeginCommandBuffer(s_Current.CommandBuffer, &beginInfo);
+		if (s_SeparateQueues)
+			vkBeginCommandBuffer(s_Current.GraphicsCommandBuffer, &beginInfo);
+
+		s_Recording = true;
+	}
+
+	void UploadManager::RetireOldest()
+	{
+		auto& device = Application::Get().GetContext()->GetLogicalDevice()->GetDevice();
+
+		UploadBatch batch = std::move(s_InFlight.front());
+		s_InFlight.pop_front();
+
+		if (vkGetFenceStatus(device, batch.Fence) != VK_SUCCESS)
+		{
+			vkWaitForFences(device, 1, &batch.Fence, VK_TRUE, UINT64_MAX);
+			s_Stats.Waits++;
+		}
+
+		VKMemAllocator allocator;
+		for (auto& [buffer, allocation] : batch.DedicatedBuffers)
+		{
+			allocator.UnMap(allocation);
+			allocator.Free(allocation, buffer);
+		}
+		batch.DedicatedBuffers.clear();
+
+		s_Tail = batch.StagingEnd;
+		s_FreeBatches.push_back(std::move(batch));
+	}
+
+}
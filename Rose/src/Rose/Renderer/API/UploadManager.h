@@ -0,0 +1,108 @@
+#pragma once
+
+#include <vulkan1.2.182.0/include/Vulkan/vulkan/vulkan.h>
+#include "VKMemAllocator.h"
+
+#include <vector>
+#include <deque>
+
+namespace Rose
+{
+
+	struct StagingRegion
+	{
+		VkBuffer Buffer = VK_NULL_HANDLE;
+		VkDeviceSize Offset = 0;
+		uint8_t* Data = nullptr; // Mapped pointer to the start of the region
+	};
+
+	struct UploadStats
+	{
+		uint32_t Batches = 0; // Submits done by the manager
+		uint32_t Waits = 0; // Times the CPU had to wait on a batch fence
+		uint32_t DedicatedStagingBuffers = 0; // Uploads too big for the ring
+		uint32_t OwnershipTransfers = 0; // Queue family release/acquire pairs
+		VkDeviceSize BytesStaged = 0;
+	};
+
+	// Records texture and buffer uploads (copies, layout transitions and mip generation) into one batch that is submitted at once.
+	// Staging memory comes from a persistently mapped ring, a batch only gives its part of the ring back once its fence is signaled.
+	//
+	// A batch has two halves. Copies are recorded into GetCommandBuffer() and run on the transfer queue,
+	// everything that needs the graphics queue (blits for mips, transitions into shader read) goes into GetGraphicsCommandBuffer().
+	// TransferOwnership() hands an image or buffer from one half to the other, the graphics half waits on the transfer half through a timeline semaphore.
+	// Without a separate transfer family both halves are the same command buffer on the graphics queue.
+	class UploadManager
+	{
+		public :
+			static void Init(VkDeviceSize stagingSize);
+			static void Shutdown();
+
+			// Copies and the transitions they need, starts a new batch if needed
+			static VkCommandBuffer GetCommandBuffer();
+			// Executes after every command of the transfer half of the same batch
+			static VkCommandBuffer GetGraphicsCommandBuffer();
+
+			// Releases the image from the transfer queue and acquires it on the graphics queue, changing its layout on the way.
+			// Only a barrier when both halves share a queue.
+			static void TransferOwnership(VkImage image, const VkImageSubresourceRange& range, VkImageLayout oldLayout, VkImageLayout newLayout);
+			// Same for a buffer range written by the transfer half, dstAccess and dstStage are how the graphics queue reads it next
+			static void TransferOwnership(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size, VkAccessFlags dstAccess, VkPipelineStageFlags dstStage);
+
+			// Reserves staging memory that stays valid until the batch that is currently recorded has finished executing.
+			// Submits the current batch and waits on older ones when the ring is full, so call it before recording anything that uses it.
+			static StagingRegion AllocateStaging(VkDeviceSize size);
+			static StagingRegion Stage(const void* data, VkDeviceSize size);
+
+			// Submits the current batch (if anything was recorded) without waiting on it, returns its timeline value
+			static uint64_t Submit();
+			// True once the transfer half of the batch with this timeline value has finished
+			static bool IsTransferComplete(uint64_t value);
+			// Submits the current batch and waits until every batch has finished
+			static void WaitIdle();
+
+			static bool UsesTransferQueue() { return s_SeparateQueues; }
+			static const UploadStats& GetStats() { return s_Stats; }
+			static VkDeviceSize GetStagingSize() { return s_StagingSize; }
+
+		private :
+			struct UploadBatch
+			{
+				VkCommandBuffer CommandBuffer = VK_NULL_HANDLE;
+				VkCommandBuffer GraphicsCommandBuffer = VK_NULL_HANDLE; // Same as CommandBuffer without a separate transfer queue
+				VkFence Fence = VK_NULL_HANDLE;
+				uint64_t TimelineValue = 0;
+				VkDeviceSize StagingEnd = 0; // Ring head once the batch was closed, the tail moves here when it retires
+
+				std::vector<std::pair<VkBuffer, VmaAllocation>> DedicatedBuffers;
+			};
+
+			static bool TryAllocate(VkDeviceSize size, VkDeviceSize& outOffset);
+			static void BeginBatch();
+			static void RetireOldest();
+
+		private :
+			static bool s_SeparateQueues;
+			static VkCommandPool s_TransferCommandPool;
+			static VkCommandPool s_GraphicsCommandPool;
+
+			static VkSemaphore s_Timeline;
+			static uint64_t s_TimelineValue;
+
+			static VkBuffer s_StagingBuffer;
+			static VmaAllocation s_StagingAllocation;
+			static uint8_t* s_MappedData;
+
+			static VkDeviceSize s_StagingSize;
+			static VkDeviceSize s_Head;
+			static VkDeviceSize s_Tail;
+
+			static bool s_Recording;
+			static UploadBatch s_Current;
+			static std::deque<UploadBatch> s_InFlight;
+			static std::vector<UploadBatch> s_FreeBatches;
+
+			static UploadStats s_Stats;
+	};
+
+}
@@ -5,6 +5,13 @@
 namespace Rose
 {
 
+	// How often a vertex or index buffer's contents change
+	enum class BufferUsage
+	{
+		Static, // Written once, lives in device local memory and is filled through the UploadManager
+		Dynamic // Rewritten every frame it's used in, persistently mapped with a region per frame in flight
+	};
+
 	struct VKMemAllocations
 	{
 		uint32_t BufferAllocs = 0;
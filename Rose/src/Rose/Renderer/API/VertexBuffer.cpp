@@ -1,25 +1,49 @@
 #include "VertexBuffer.h"
+#include "UploadManager.h"
 #include "Rose/Core/Application.h"
 
+#include <algorithm>
+
 
 namespace Rose
 {
 
-	VertexBuffer::VertexBuffer(void* data, uint32_t size )
-		: m_Size(size)
+	VertexBuffer::VertexBuffer(void* data, uint32_t size, BufferUsage usage)
+		: m_Size(size), m_Usage(usage)
 	{
 		RecreateBuffer();
 		Bind();
 		SetData(data, size);
 	}
 
-	VertexBuffer::VertexBuffer(uint32_t size) 
-		: m_Size(size)
+	VertexBuffer::VertexBuffer(uint32_t size, BufferUsage usage)
+		: m_Size(size), m_Usage(usage)
 	{
-		
+
 		RecreateBuffer();
 	}
 
+	VertexBuffer::VertexBuffer(const std::vector<std::vector<uint8_t>>& streams, BufferUsage usage)
+		: m_Usage(usage)
+	{
+		// Each stream starts aligned so every attribute fetch stays aligned to its component size
+		const VkDeviceSize alignment = 16;
+
+		m_StreamOffsets.clear();
+		VkDeviceSize size = 0;
+		for (auto& stream : streams)
+		{
+			m_StreamOffsets.push_back(size);
+			size = (size + stream.size() + alignment - 1) & ~(alignment - 1);
+		}
+		m_Size = (uint32_t)size;
+
+		RecreateBuffer();
+
+		for (size_t i = 0; i < streams.size(); i++)
+			SetData((void*)streams[i].data(), (uint32_t)streams[i].size(), (uint32_t)m_StreamOffsets[i]);
+	}
+
 	VertexBuffer::~VertexBuffer()
 	{
 		if(!m_IsFreed)
@@ -31,29 +55,67 @@ namespace Rose
 		//vmaBindBufferMemory(VKMemAllocator::GetVMAAllocator(), m_MemoryAllocation, m_BufferID);
 	}
 
-	void VertexBuffer::SetData(void* data, uint32_t size)
+	void VertexBuffer::BindStreams(VkCommandBuffer commandBuffer, uint32_t streamCount) const
 	{
+		streamCount = std::min(streamCount, (uint32_t)m_StreamOffsets.size());
 
-		m_Size = size;
-
-		void* temp = nullptr;
-		vmaMapMemory(VKMemAllocator::GetVMAAllocator(), m_MemoryAllocation, &temp);
-		memcpy(temp, data, size);
-		vmaUnmapMemory(VKMemAllocator::GetVMAAllocator(), m_MemoryAllocation);
+		std::vector<VkBuffer> buffers(streamCount, m_BufferID);
+		std::vector<VkDeviceSize> offsets(streamCount);
+		for (uint32_t i = 0; i < streamCount; i++)
+			offsets[i] = m_RegionOffset + m_StreamOffsets[i];
 
+		vkCmdBindVertexBuffers(commandBuffer, 0, streamCount, buffers.data(), offsets.data());
+	}
 
+	void VertexBuffer::SetData(void* data, uint32_t size, uint32_t offset)
+	{
+		if (m_Usage == BufferUsage::Static)
+		{
+			StagingRegion staging = UploadManager::Stage(data, size);
+
+			VkBufferCopy copy{};
+			copy.srcOffset = staging.Offset;
+			copy.dstOffset = offset;
+			copy.size = size;
+			vkCmdCopyBuffer(UploadManager::GetCommandBuffer(), staging.Buffer, m_BufferID, 1, &copy);
+
+			UploadManager::TransferOwnership(m_BufferID, offset, size, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT);
+			return;
+		}
+
+		// Frames still in flight keep reading their own region
+		m_RegionOffset = (VkDeviceSize)m_Size * Application::Get().GetContext()->GetLogicalDevice()->GetCurrentFrameIndex();
+
+		memcpy(m_Shadow.data() + offset, data, size);
+		if (m_RegionOffset != m_WrittenRegion)
+		{
+			// The region was last written frames ago (or never), bring all of it up to date, not just the part that changed
+			m_WrittenRegion = m_RegionOffset;
+			memcpy(m_MappedData + m_RegionOffset, m_Shadow.data(), m_Size);
+			vmaFlushAllocation(VKMemAllocator::GetVMAAllocator(), m_MemoryAllocation, m_RegionOffset, m_Size);
+			return;
+		}
+
+		memcpy(m_MappedData + m_RegionOffset + offset, data, size);
+		vmaFlushAllocation(VKMemAllocator::GetVMAAllocator(), m_MemoryAllocation, m_RegionOffset + offset, size);
 	}
 
 	void VertexBuffer::FreeMemory()
 	{
 		m_IsFreed = true;
 		VKMemAllocator allocator;
+		if (m_MappedData)
+		{
+			allocator.UnMap(m_MemoryAllocation);
+			m_MappedData = nullptr;
+		}
 		allocator.Free(m_MemoryAllocation, m_BufferID);
 	}
 
 	void VertexBuffer::RecreateBuffer()
 	{
 		m_IsFreed = false;
+		m_RegionOffset = 0;
 
 		VkBufferCreateInfo bufferInfo{};
 		bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -61,7 +123,22 @@ namespace Rose
 		bufferInfo.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
 
 		VKMemAllocator allocator;
+		if (m_Usage == BufferUsage::Static)
+		{
+			bufferInfo.usage |= VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+			m_MemoryAllocation = allocator.AllocateBuffer(bufferInfo, VMA_MEMORY_USAGE_GPU_ONLY, &m_BufferID);
+			return;
+		}
+
+		bufferInfo.size = (VkDeviceSize)m_Size * Application::Get().GetContext()->GetLogicalDevice()->GetFramesInFlight();
 		m_MemoryAllocation = allocator.AllocateBuffer(bufferInfo, VMA_MEMORY_USAGE_CPU_TO_GPU, &m_BufferID);
+
+		void* data = nullptr;
+		allocator.Map(m_MemoryAllocation, &data);
+		m_MappedData = (uint8_t*)data;
+
+		m_Shadow.assign(m_Size, 0);
+		m_WrittenRegion = UINT64_MAX;
 	}
 
-}
\ No newline at end of file
+}
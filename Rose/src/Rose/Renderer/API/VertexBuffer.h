@@ -4,6 +4,8 @@
 #include <vulkan1.2.182.0/include/Vulkan/vulkan/vulkan.h>
 #include "VKMemAllocator.h"
 
+#include <vector>
+
 
 namespace Rose
 {
@@ -12,28 +14,48 @@ namespace Rose
 	{
 
 		public:
-	
-			VertexBuffer(void* data, uint32_t size);
-			VertexBuffer(uint32_t size);
-	
+
+			VertexBuffer(void* data, uint32_t size, BufferUsage usage = BufferUsage::Static);
+			VertexBuffer(uint32_t size, BufferUsage usage = BufferUsage::Dynamic);
+			// One allocation holding every stream back to back, stream i is bound to binding i
+			VertexBuffer(const std::vector<std::vector<uint8_t>>& streams, BufferUsage usage = BufferUsage::Static);
+
 			~VertexBuffer();
-	
+
 			void Bind();
-			void SetData(void* data, uint32_t size);
+			// Binds the first streamCount streams starting at binding 0, passes that only need positions bind just the first
+			void BindStreams(VkCommandBuffer commandBuffer, uint32_t streamCount = UINT32_MAX) const;
+			// Static buffers record a staged copy, the GPU must be done with the old contents.
+			// Dynamic buffers write into the current frame's region, which is what gets bound until the next SetData.
+			// Partial updates are fine, the rest of the region is carried over from the last write
+			void SetData(void* data, uint32_t size, uint32_t offset = 0);
 
 			void FreeMemory();
 
 			const VkBuffer& GetBufferID() const { return m_BufferID; }
-	
+			// Where the data the GPU should read this frame starts, always 0 for static buffers
+			VkDeviceSize GetOffset() const { return m_RegionOffset; }
+			BufferUsage GetUsage() const { return m_Usage; }
+			uint32_t GetStreamCount() const { return (uint32_t)m_StreamOffsets.size(); }
+			VkDeviceSize GetStreamOffset(uint32_t stream) const { return m_RegionOffset + m_StreamOffsets[stream]; }
+
 		private :
 			void RecreateBuffer();
 		private:
 			VkBuffer m_BufferID;
 			VmaAllocation m_MemoryAllocation;
-	
+
 			uint32_t m_Size = 0;
 			bool m_IsFreed = false;
-	
+
+			BufferUsage m_Usage = BufferUsage::Static;
+			uint8_t* m_MappedData = nullptr; // Dynamic only, mapped for the lifetime of the buffer
+			VkDeviceSize m_RegionOffset = 0;
+			std::vector<uint8_t> m_Shadow; // Dynamic only, the latest contents, copied into a region the first time a frame writes it
+			VkDeviceSize m_WrittenRegion = UINT64_MAX;
+
+			std::vector<VkDeviceSize> m_StreamOffsets = { 0 };
+
 	};
 
-}
\ No newline at end of file
+}
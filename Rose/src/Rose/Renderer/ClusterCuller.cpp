@@ -0,0 +1,330 @@
+#include "ClusterCuller.h"
+
+#include "API/UploadManager.h"
+#include "Rose/Core/Application.h"
+#include "Rose/Core/Log.h"
+
+#include <algorithm>
+
+namespace Rose
+{
+
+	std::vector<ClusterRecord> ClusterCuller::s_Clusters;
+	std::vector<ClusterGroup> ClusterCuller::s_Groups;
+	std::vector<ClusterCuller::ClusterSubMesh> ClusterCuller::s_SubMeshes;
+
+	std::shared_ptr<Shader> ClusterCuller::s_CullShader;
+	VkDescriptorPool ClusterCuller::s_DescriptorPool = VK_NULL_HANDLE;
+	VkDescriptorSet ClusterCuller::s_DescriptorSet = VK_NULL_HANDLE;
+
+	VkBuffer ClusterCuller::s_ClusterBuffer = VK_NULL_HANDLE;
+	VmaAllocation ClusterCuller::s_ClusterAllocation = nullptr;
+	VkBuffer ClusterCuller::s_CommandBuffer = VK_NULL_HANDLE;
+	VmaAllocation ClusterCuller::s_CommandAllocation = nullptr;
+	VkBuffer ClusterCuller::s_CountBuffer = VK_NULL_HANDLE;
+	VmaAllocation ClusterCuller::s_CountAllocation = nullptr;
+
+	uint32_t ClusterCuller::s_MaxClusters = 0;
+	uint32_t ClusterCuller::s_MaxGroups = 0;
+	uint32_t ClusterCuller::s_FramesInFlight = 1;
+	uint32_t ClusterCuller::s_CommandFrameSize = 0;
+	uint32_t ClusterCuller::s_CountFrameSize = 0;
+	uint32_t ClusterCuller::s_FrameIndex = 0;
+
+	ClusterCuller::CullConstants ClusterCuller::s_Constants;
+	ClusterCullMode ClusterCuller::s_Mode = ClusterCullMode::GPU;
+	ClusterCullStats ClusterCuller::s_Stats;
+	Frustum ClusterCuller::s_Frustum;
+
+
+	namespace Utils {
+
+		static uint32_t AlignTo(uint32_t size, uint32_t alignment)
+		{
+			return (size + alignment - 1) & ~(alignment - 1);
+		}
+	}
+
+
+	void ClusterCuller::Init(uint32_t maxClusters, uint32_t maxGroups, uint32_t framesInFlight)
+	{
+		s_MaxClusters = maxClusters;
+		s_MaxGroups = maxGroups;
+		s_FramesInFlight = framesInFlight ? framesInFlight : 1;
+
+		const auto& props = Application::Get().GetContext()->GetPhysicalDevice()->GetProperties();
+		uint32_t alignment = (uint32_t)props.limits.minStorageBufferOffsetAlignment;
+		if (!alignment)
+			alignment = 1;
+
+		s_CommandFrameSize = Utils::AlignTo(maxClusters * sizeof(VkDrawIndexedIndirectCommand), alignment);
+		s_CountFrameSize = Utils::AlignTo(maxGroups * sizeof(uint32_t), alignment);
+
+		VKMemAllocator allocator;
+
+		VkBufferCreateInfo bufferInfo{};
+		bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		bufferInfo.size = (VkDeviceSize)maxClusters * sizeof(ClusterRecord);
+		bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+		bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		s_ClusterAllocation = allocator.AllocateBuffer(bufferInfo, VMA_MEMORY_USAGE_GPU_ONLY, &s_ClusterBuffer);
+
+		bufferInfo.size = (VkDeviceSize)s_CommandFrameSize * s_FramesInFlight;
+		bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
+		s_CommandAllocation = allocator.AllocateBuffer(bufferInfo, VMA_MEMORY_USAGE_GPU_ONLY, &s_CommandBuffer);
+
+		// Counts are cleared with vkCmdFillBuffer every frame
+		bufferInfo.size = (VkDeviceSize)s_CountFrameSize * s_FramesInFlight;
+		bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+		s_CountAllocation = allocator.AllocateBuffer(bufferInfo, VMA_MEMORY_USAGE_GPU_ONLY, &s_CountBuffer);
+
+		s_CullShader = ShaderLibrary::Get("assets/shaders/cull.shader", ShaderAttributeLayout());
+		s_CullShader->CreateDescriptorPool(s_DescriptorPool);
+
+		// Ranges are a single frame's region, which region is read or written is picked with the dynamic offsets
+		std::unordered_map<uint32_t, VkDescriptorBufferInfo> buffers;
+		buffers[0] = { s_ClusterBuffer, 0, VK_WHOLE_SIZE };
+		buffers[1] = { GPUScene::GetBuffer(), 0, GPUScene::GetFrameRange() };
+		buffers[2] = { s_CommandBuffer, 0, s_CommandFrameSize };
+		buffers[3] = { s_CountBuffer, 0, s_CountFrameSize };
+		s_CullShader->CreateBufferDescriptorSet(buffers, s_DescriptorPool, s_DescriptorSet);
+
+		s_Clusters.reserve(maxClusters);
+		s_Groups.reserve(maxGroups);
+
+		if (!Application::Get().GetContext()->GetPhysicalDevice()->SupportsDrawIndirectCount())
+			LOG("ClusterCuller: drawIndirectCount isn't supported, clusters are culled on the CPU\n");
+	}
+
+	void ClusterCuller::Shutdown()
+	{
+		const auto& device = Application::Get().GetContext()->GetLogicalDevice()->GetDevice();
+		vkDestroyDescriptorPool(device, s_DescriptorPool, nullptr);
+		s_DescriptorPool = VK_NULL_HANDLE;
+		s_CullShader.reset();
+
+		VKMemAllocator allocator;
+		allocator.Free(s_ClusterAllocation, s_ClusterBuffer);
+		allocator.Free(s_CommandAllocation, s_CommandBuffer);
+		allocator.Free(s_CountAllocation, s_CountBuffer);
+
+		s_Clusters.clear();
+		s_Groups.clear();
+		s_SubMeshes.clear();
+	}
+
+	uint32_t ClusterCuller::AddMesh(const Mesh& mesh, const GeometryAllocation& allocation, uint32_t objectIndex)
+	{
+		if (s_Groups.size() >= s_MaxGroups || s_Clusters.size() + mesh.Meshlets.size() > s_MaxClusters)
+		{
+			LOG("ClusterCuller is full! (max clusters: %d, max groups: %d)\n", s_MaxClusters, s_MaxGroups);
+			ASSERT();
+			return 0;
+		}
+
+		ClusterGroup group;
+		group.FirstCluster = (uint32_t)s_Clusters.size();
+		group.ClusterCount = (uint32_t)mesh.Meshlets.size();
+		group.ObjectIndex = objectIndex;
+		group.FirstIndex = allocation.FirstIndex;
+		group.IndexCount = mesh.GetLOD(0).IndexCount;
+		group.VertexOffset = (int32_t)allocation.VertexOffset;
+
+		// MeshletBuilder starts a new meshlet for every sub mesh, so each one owns a run of clusters
+		group.FirstSubMesh = (uint32_t)s_SubMeshes.size();
+		if (mesh.SubMeshes.empty())
+		{
+			s_SubMeshes.push_back({ mesh.BoundingSphere, group.FirstCluster, group.ClusterCount });
+		}
+		else
+		{
+			uint32_t meshlet = 0;
+			for (auto& subMesh : mesh.SubMeshes)
+			{
+				ClusterSubMesh range = { subMesh.BoundingSphere, group.FirstCluster + meshlet, 0 };
+				while (meshlet < mesh.Meshlets.size() && mesh.Meshlets[meshlet].FirstIndex < subMesh.FirstIndex + subMesh.IndexCount)
+				{
+					range.ClusterCount++;
+					meshlet++;
+				}
+				s_SubMeshes.push_back(range);
+			}
+		}
+		group.SubMeshCount = (uint32_t)s_SubMeshes.size() - group.FirstSubMesh;
+
+		uint32_t groupIndex = (uint32_t)s_Groups.size();
+		s_Groups.push_back(group);
+
+		if (!group.ClusterCount)
+			return groupIndex;
+
+		for (auto& meshlet : mesh.Meshlets)
+		{
+			ClusterRecord cluster;
+			cluster.BoundingSphere = meshlet.BoundingSphere;
+			cluster.Cone = meshlet.Cone;
+			cluster.FirstIndex = allocation.FirstIndex + meshlet.FirstIndex;
+			cluster.IndexCount = meshlet.TriangleCount * 3;
+			cluster.VertexOffset = (int32_t)allocation.VertexOffset;
+			cluster.ObjectIndex = objectIndex;
+			cluster.Group = groupIndex;
+			// A group never has more visible clusters than it has clusters, so its slots start where its clusters do
+			cluster.CommandOffset = group.FirstCluster;
+
+			s_Clusters.push_back(cluster);
+		}
+
+		VkDeviceSize size = (VkDeviceSize)group.ClusterCount * sizeof(ClusterRecord);
+		StagingRegion staging = UploadManager::Stage(&s_Clusters[group.FirstCluster], size);
+
+		VkBufferCopy copy{};
+		copy.srcOffset = staging.Offset;
+		copy.dstOffset = (VkDeviceSize)group.FirstCluster * sizeof(ClusterRecord);
+		copy.size = size;
+		vkCmdCopyBuffer(UploadManager::GetCommandBuffer(), staging.Buffer, s_ClusterBuffer, 1, &copy);
+
+		UploadManager::TransferOwnership(s_ClusterBuffer, copy.dstOffset, copy.size, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+		return groupIndex;
+	}
+
+	ClusterCullMode ClusterCuller::GetMode()
+	{
+		if (s_Mode == ClusterCullMode::GPU && !Application::Get().GetContext()->GetPhysicalDevice()->SupportsDrawIndirectCount())
+			return ClusterCullMode::CPU;
+		return s_Mode;
+	}
+
+	void ClusterCuller::BeginFrame(const SceneUniformData& sceneData)
+	{
+		s_Frustum = Frustum::FromMatrix(sceneData.ViewProj);
+		for (uint32_t i = 0; i < Frustum::PlaneCount; i++)
+			s_Constants.Planes[i] = s_Frustum.Planes[i];
+
+		s_Constants.CameraPosition = glm::inverse(sceneData.View)[3];
+		s_Constants.ClusterCount = (uint32_t)s_Clusters.size();
+
+		s_Stats = ClusterCullStats();
+	}
+
+	void ClusterCuller::Dispatch(VkCommandBuffer commandBuffer, uint32_t frameIndex, uint32_t objectBufferOffset)
+	{
+		s_FrameIndex = frameIndex;
+		if (GetMode() != ClusterCullMode::GPU || s_Clusters.empty())
+			return;
+
+		VkDeviceSize countOffset = (VkDeviceSize)s_CountFrameSize * frameIndex;
+		vkCmdFillBuffer(commandBuffer, s_CountBuffer, countOffset, s_CountFrameSize, 0);
+
+		VkMemoryBarrier clearBarrier{};
+		clearBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		clearBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		clearBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &clearBarrier, 0, nullptr, 0, nullptr);
+
+		// Ordered by binding: clusters (0), object buffer (1), commands (2), counts (3)
+		uint32_t dynamicOffsets[] = { 0, objectBufferOffset, s_CommandFrameSize * frameIndex, s_CountFrameSize * frameIndex };
+
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, s_CullShader->GetComputePipeline());
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, s_CullShader->GetPipelineLayout(), 0, 1, &s_DescriptorSet, 4, dynamicOffsets);
+		vkCmdPushConstants(commandBuffer, s_CullShader->GetPipelineLayout(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(CullConstants), &s_Constants);
+		vkCmdDispatch(commandBuffer, (s_Constants.ClusterCount + 63) / 64, 1, 1);
+
+		VkMemoryBarrier cullBarrier{};
+		cullBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		cullBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+		cullBarrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, 0, 1, &cullBarrier, 0, nullptr, 0, nullptr);
+	}
+
+	void ClusterCuller::Draw(VkCommandBuffer commandBuffer, uint32_t groupIndex)
+	{
+		const auto& group = s_Groups[groupIndex];
+		ClusterCullMode mode = GetMode();
+
+		s_Stats.Clusters += group.ClusterCount;
+
+		if (mode == ClusterCullMode::None || !group.ClusterCount)
+		{
+			vkCmdDrawIndexed(commandBuffer, group.IndexCount, 1, group.FirstIndex, group.VertexOffset, 0);
+			s_Stats.VisibleClusters += group.ClusterCount;
+			s_Stats.DrawCalls++;
+			return;
+		}
+
+		if (mode == ClusterCullMode::GPU)
+		{
+			VkDeviceSize commandOffset = (VkDeviceSize)s_CommandFrameSize * s_FrameIndex + (VkDeviceSize)group.FirstCluster * sizeof(VkDrawIndexedIndirectCommand);
+			VkDeviceSize countOffset = (VkDeviceSize)s_CountFrameSize * s_FrameIndex + (VkDeviceSize)groupIndex * sizeof(uint32_t);
+			vkCmdDrawIndexedIndirectCount(commandBuffer, s_CommandBuffer, commandOffset, s_CountBuffer, countOffset, group.ClusterCount, sizeof(VkDrawIndexedIndirectCommand));
+			s_Stats.DrawCalls++;
+			return;
+		}
+
+		// Meshlets cover consecutive index ranges, so a run of visible clusters is a single draw
+		const auto& object = GPUScene::GetObject(group.ObjectIndex);
+		float scale = std::max(glm::length(glm::vec3(object.Model[0])), std::max(glm::length(glm::vec3(object.Model[1])), glm::length(glm::vec3(object.Model[2]))));
+
+		uint32_t runFirstIndex = 0;
+		uint32_t runIndexCount = 0;
+		auto flushRun = [&]()
+		{
+			if (!runIndexCount)
+				return;
+			vkCmdDrawIndexed(commandBuffer, runIndexCount, 1, runFirstIndex, group.VertexOffset, 0);
+			s_Stats.DrawCalls++;
+			runIndexCount = 0;
+		};
+
+		for (uint32_t s = 0; s < group.SubMeshCount; s++)
+		{
+			const auto& subMesh = s_SubMeshes[group.FirstSubMesh + s];
+			glm::vec3 center = glm::vec3(object.Model * glm::vec4(glm::vec3(subMesh.BoundingSphere), 1.0f));
+			if (group.SubMeshCount > 1 && !s_Frustum.IsSphereVisible(center, subMesh.BoundingSphere.w * scale))
+			{
+				flushRun();
+				s_Stats.CulledSubMeshes++;
+				continue;
+			}
+
+			for (uint32_t i = 0; i < subMesh.ClusterCount; i++)
+			{
+				const auto& cluster = s_Clusters[subMesh.FirstCluster + i];
+				if (IsVisible(cluster, object))
+				{
+					if (!runIndexCount)
+						runFirstIndex = cluster.FirstIndex;
+					runIndexCount += cluster.IndexCount;
+					s_Stats.VisibleClusters++;
+					continue;
+				}
+
+				flushRun();
+			}
+		}
+
+		flushRun();
+	}
+
+	bool ClusterCuller::IsVisible(const ClusterRecord& cluster, const ObjectRecord& object)
+	{
+		glm::vec3 center = glm::vec3(object.Model * glm::vec4(glm::vec3(cluster.BoundingSphere), 1.0f));
+		float scale = std::max(glm::length(glm::vec3(object.Model[0])), std::max(glm::length(glm::vec3(object.Model[1])), glm::length(glm::vec3(object.Model[2]))));
+		float radius = cluster.BoundingSphere.w * scale;
+
+		if (!s_Frustum.IsSphereVisible(center, radius))
+			return false;
+
+		// Every triangle faces away when the camera is inside the cone behind the cluster
+		if (cluster.Cone.w < 1.0f)
+		{
+			glm::vec3 axis = glm::normalize(glm::mat3(object.NormalMatrix) * glm::vec3(cluster.Cone));
+			glm::vec3 toCluster = center - glm::vec3(s_Constants.CameraPosition);
+			if (glm::dot(toCluster, axis) >= cluster.Cone.w * glm::length(toCluster) + radius)
+				return false;
+		}
+
+		return true;
+	}
+
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <vulkan1.2.182.0/include/Vulkan/vulkan/vulkan.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <memory>
+
+#include "API/VKMemAllocator.h"
+#include "API/Shader.h"
+#include "GeometryPool.h"
+#include "GPUScene.h"
+#include "Mesh.h"
+#include "Frustum.h"
+
+namespace Rose
+{
+
+	// std430, has to match ClusterRecord in cull.shader
+	struct ClusterRecord
+	{
+		glm::vec4 BoundingSphere = glm::vec4(0.0f); // Object space
+		glm::vec4 Cone = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f); // Object space axis (xyz), w is the cutoff, 1 is never culled
+		uint32_t FirstIndex = 0; // Into the geometry pool's index arena
+		uint32_t IndexCount = 0;
+		int32_t VertexOffset = 0;
+		uint32_t ObjectIndex = 0;
+		uint32_t Group = 0;
+		uint32_t CommandOffset = 0; // First indirect command slot of the group
+		uint32_t Padding[2] = { 0, 0 };
+	};
+
+	// Every cluster of one mesh, drawn with a single indirect count draw on the GPU path
+	struct ClusterGroup
+	{
+		uint32_t FirstCluster = 0;
+		uint32_t ClusterCount = 0;
+		uint32_t ObjectIndex = 0;
+		uint32_t FirstSubMesh = 0; // CPU side sub mesh ranges, one covering every cluster for meshes that aren't static batches
+		uint32_t SubMeshCount = 0;
+
+		// All of LOD 0, for when clusters aren't culled
+		uint32_t FirstIndex = 0;
+		uint32_t IndexCount = 0;
+		int32_t VertexOffset = 0;
+	};
+
+	enum class ClusterCullMode
+	{
+		None, CPU, GPU
+	};
+
+	struct ClusterCullStats
+	{
+		uint32_t Clusters = 0; // Clusters of every group drawn this frame
+		uint32_t VisibleClusters = 0; // CPU mode only, the GPU path doesn't read its counts back
+		uint32_t CulledSubMeshes = 0; // CPU mode only, static batch pieces whose clusters were skipped as a whole
+		uint32_t DrawCalls = 0;
+	};
+
+	// Culls meshlets against the view frustum and their normal cone before they're drawn.
+	// Clusters are uploaded once into a device local buffer, GPU mode culls them in a compute pass that writes
+	// indirect commands and a count per group, draws then go through vkCmdDrawIndexedIndirectCount.
+	// The command and count buffers hold a region per frame in flight, just like the GPUScene.
+	// CPU mode runs the same test on the CPU and merges runs of visible clusters into one draw, sub meshes of static batches
+	// are tested first so the clusters of a piece that's off screen are skipped all at once.
+	class ClusterCuller
+	{
+		public :
+			static void Init(uint32_t maxClusters, uint32_t maxGroups, uint32_t framesInFlight);
+			static void Shutdown();
+
+			// Records the upload of the mesh's meshlets, returns the group to draw it with
+			static uint32_t AddMesh(const Mesh& mesh, const GeometryAllocation& allocation, uint32_t objectIndex);
+
+			// Extracts the frustum and camera position the frame is culled with
+			static void BeginFrame(const SceneUniformData& sceneData);
+			// GPU mode only, has to be recorded before the render pass begins
+			static void Dispatch(VkCommandBuffer commandBuffer, uint32_t frameIndex, uint32_t objectBufferOffset);
+			// Expects the pipeline, descriptors, push constants and the geometry pool's buffers to be bound
+			static void Draw(VkCommandBuffer commandBuffer, uint32_t group);
+
+			// Same test as cull.shader
+			static bool IsVisible(const ClusterRecord& cluster, const ObjectRecord& object);
+
+			static void SetMode(ClusterCullMode mode) { s_Mode = mode; }
+			// GPU mode falls back to CPU mode on devices without drawIndirectCount
+			static ClusterCullMode GetMode();
+
+			static uint32_t GetClusterCount() { return (uint32_t)s_Clusters.size(); }
+			static const ClusterCullStats& GetStats() { return s_Stats; }
+
+		private :
+			struct CullConstants
+			{
+				glm::vec4 Planes[6];
+				glm::vec4 CameraPosition;
+				uint32_t ClusterCount;
+				uint32_t Padding[3];
+			};
+
+			struct ClusterSubMesh
+			{
+				glm::vec4 BoundingSphere; // Object space
+				uint32_t FirstCluster;
+				uint32_t ClusterCount;
+			};
+
+		private :
+			static std::vector<ClusterRecord> s_Clusters;
+			static std::vector<ClusterGroup> s_Groups;
+			static std::vector<ClusterSubMesh> s_SubMeshes;
+
+			static std::shared_ptr<Shader> s_CullShader;
+			static VkDescriptorPool s_DescriptorPool;
+			static VkDescriptorSet s_DescriptorSet;
+
+			static VkBuffer s_ClusterBuffer;
+			static VmaAllocation s_ClusterAllocation;
+			static VkBuffer s_CommandBuffer;
+			static VmaAllocation s_CommandAllocation;
+			static VkBuffer s_CountBuffer;
+			static VmaAllocation s_CountAllocation;
+
+			static uint32_t s_MaxClusters;
+			static uint32_t s_MaxGroups;
+			static uint32_t s_FramesInFlight;
+			static uint32_t s_CommandFrameSize;
+			static uint32_t s_CountFrameSize;
+			static uint32_t s_FrameIndex;
+
+			static CullConstants s_Constants;
+			static ClusterCullMode s_Mode;
+			static ClusterCullStats s_Stats;
+			static Frustum s_Frustum; // This frame's, the planes are also pushed to the cull shader
+	};
+
+}
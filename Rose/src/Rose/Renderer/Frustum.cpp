@@ -0,0 +1,54 @@
+#include "Frustum.h"
+
+namespace Rose
+{
+
+	namespace Utils {
+
+		static glm::vec4 NormalizePlane(const glm::vec4& plane)
+		{
+			return plane / glm::length(glm::vec3(plane));
+		}
+
+	}
+
+
+	Frustum Frustum::FromMatrix(const glm::mat4& viewProj)
+	{
+		// Gribb/Hartmann, rows of the view projection. Depth goes from -1 to 1, so near is row 3 + row 2
+		glm::mat4 m = glm::transpose(viewProj);
+
+		Frustum frustum;
+		frustum.Planes[Left] = Utils::NormalizePlane(m[3] + m[0]);
+		frustum.Planes[Right] = Utils::NormalizePlane(m[3] - m[0]);
+		frustum.Planes[Bottom] = Utils::NormalizePlane(m[3] + m[1]);
+		frustum.Planes[Top] = Utils::NormalizePlane(m[3] - m[1]);
+		frustum.Planes[Near] = Utils::NormalizePlane(m[3] + m[2]);
+		frustum.Planes[Far] = Utils::NormalizePlane(m[3] - m[2]);
+		return frustum;
+	}
+
+	bool Frustum::IsSphereVisible(const glm::vec3& center, float radius) const
+	{
+		for (uint32_t i = 0; i < PlaneCount; i++)
+		{
+			if (glm::dot(glm::vec3(Planes[i]), center) + Planes[i].w < -radius)
+				return false;
+		}
+		return true;
+	}
+
+	bool Frustum::IsBoxVisible(const glm::vec3& min, const glm::vec3& max) const
+	{
+		// Only the corner furthest along the plane normal has to be tested, if even that one is behind the box is outside
+		for (uint32_t i = 0; i < PlaneCount; i++)
+		{
+			const glm::vec4& plane = Planes[i];
+			glm::vec3 corner = glm::vec3(plane.x >= 0.0f ? max.x : min.x, plane.y >= 0.0f ? max.y : min.y, plane.z >= 0.0f ? max.z : min.z);
+			if (glm::dot(glm::vec3(plane), corner) + plane.w < 0.0f)
+				return false;
+		}
+		return true;
+	}
+
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+namespace Rose
+{
+
+	// The six planes of a view projection, normals point inwards and are normalized so distances are in world units
+	struct Frustum
+	{
+		enum PlaneIndex { Left, Right, Bottom, Top, Near, Far, PlaneCount };
+
+		glm::vec4 Planes[PlaneCount];
+
+		// Expects depth mapped to -1..1, like glm::perspective
+		static Frustum FromMatrix(const glm::mat4& viewProj);
+
+		bool IsSphereVisible(const glm::vec3& center, float radius) const;
+		bool IsBoxVisible(const glm::vec3& min, const glm::vec3& max) const;
+	};
+
+}
@@ -0,0 +1,133 @@
+#include "FrustumCuller.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE__)
+	#include <xmmintrin.h>
+	#define ROSE_FRUSTUM_SSE
+#endif
+
+#if defined(_MSC_VER)
+	#include <intrin.h>
+	#include <immintrin.h>
+#endif
+
+namespace Rose
+{
+
+	namespace Utils {
+
+		static bool DetectAVX2()
+		{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+			int info[4];
+			__cpuid(info, 0);
+			if (info[0] < 7)
+				return false;
+
+			// AVX needs OS support too, the YMM registers have to be saved on context switches
+			__cpuid(info, 1);
+			bool osxsave = info[2] & (1 << 27);
+			bool avx = info[2] & (1 << 28);
+			if (!osxsave || !avx || (_xgetbv(0) & 6) != 6)
+				return false;
+
+			__cpuidex(info, 7, 0);
+			return info[1] & (1 << 5);
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+			return __builtin_cpu_supports("avx2");
+#else
+			return false;
+#endif
+		}
+
+	}
+
+
+	void BoxArrays::Resize(uint32_t count)
+	{
+		MinX.resize(count); MinY.resize(count); MinZ.resize(count);
+		MaxX.resize(count); MaxY.resize(count); MaxZ.resize(count);
+	}
+
+	void BoxArrays::PushBack(const glm::vec3& min, const glm::vec3& max)
+	{
+		Resize(GetCount() + 1);
+		Set(GetCount() - 1, min, max);
+	}
+
+	void BoxArrays::Set(uint32_t index, const glm::vec3& min, const glm::vec3& max)
+	{
+		MinX[index] = min.x; MinY[index] = min.y; MinZ[index] = min.z;
+		MaxX[index] = max.x; MaxY[index] = max.y; MaxZ[index] = max.z;
+	}
+
+	void BoxArrays::SwapRemove(uint32_t index)
+	{
+		uint32_t last = GetCount() - 1;
+		Set(index, glm::vec3(MinX[last], MinY[last], MinZ[last]), glm::vec3(MaxX[last], MaxY[last], MaxZ[last]));
+		Resize(last);
+	}
+
+	void FrustumCuller::TransformBox(const glm::mat4& transform, const glm::vec3& min, const glm::vec3& max, glm::vec3& outMin, glm::vec3& outMax)
+	{
+		glm::vec3 center = (min + max) * 0.5f;
+		glm::vec3 extents = (max - min) * 0.5f;
+
+		glm::vec3 worldCenter = glm::vec3(transform * glm::vec4(center, 1.0f));
+		glm::mat3 absolute = glm::mat3(glm::abs(glm::vec3(transform[0])), glm::abs(glm::vec3(transform[1])), glm::abs(glm::vec3(transform[2])));
+		glm::vec3 worldExtents = absolute * extents;
+
+		outMin = worldCenter - worldExtents;
+		outMax = worldCenter + worldExtents;
+	}
+
+	bool FrustumCuller::UsesAVX2()
+	{
+		static const bool s_HasAVX2 = Utils::DetectAVX2();
+		return s_HasAVX2;
+	}
+
+	void FrustumCuller::Cull(const Frustum& frustum, const BoxArrays& boxes, uint32_t start, uint32_t end, uint8_t* visible)
+	{
+		PlaneCorner corners[Frustum::PlaneCount];
+		for (uint32_t p = 0; p < Frustum::PlaneCount; p++)
+		{
+			const glm::vec4& plane = frustum.Planes[p];
+			corners[p].X = plane.x >= 0.0f ? boxes.MaxX.data() : boxes.MinX.data();
+			corners[p].Y = plane.y >= 0.0f ? boxes.MaxY.data() : boxes.MinY.data();
+			corners[p].Z = plane.z >= 0.0f ? boxes.MaxZ.data() : boxes.MinZ.data();
+		}
+
+		uint32_t i = start;
+		if (UsesAVX2())
+			i = CullAVX2(frustum, corners, i, end, visible);
+
+#if defined(ROSE_FRUSTUM_SSE)
+		const __m128 zero = _mm_setzero_ps();
+		for (; i + 4 <= end; i += 4)
+		{
+			__m128 inside = _mm_cmpeq_ps(zero, zero);
+			for (uint32_t p = 0; p < Frustum::PlaneCount; p++)
+			{
+				const glm::vec4& plane = frustum.Planes[p];
+				__m128 distance = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.x), _mm_loadu_ps(corners[p].X + i)), _mm_set1_ps(plane.w));
+				distance = _mm_add_ps(distance, _mm_mul_ps(_mm_set1_ps(plane.y), _mm_loadu_ps(corners[p].Y + i)));
+				distance = _mm_add_ps(distance, _mm_mul_ps(_mm_set1_ps(plane.z), _mm_loadu_ps(corners[p].Z + i)));
+				inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, zero));
+			}
+
+			uint32_t mask = (uint32_t)_mm_movemask_ps(inside);
+			for (uint32_t lane = 0; lane < 4; lane++)
+				visible[i + lane] = (mask >> lane) & 1;
+		}
+#endif
+
+		// Whatever is left over after the last full vector
+		for (; i < end; i++)
+		{
+			glm::vec3 min = glm::vec3(boxes.MinX[i], boxes.MinY[i], boxes.MinZ[i]);
+			glm::vec3 max = glm::vec3(boxes.MaxX[i], boxes.MaxY[i], boxes.MaxZ[i]);
+			visible[i] = frustum.IsBoxVisible(min, max);
+		}
+	}
+
+}
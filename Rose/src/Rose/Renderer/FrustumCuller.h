@@ -0,0 +1,53 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "Frustum.h"
+
+namespace Rose
+{
+
+	// World space boxes, one array per component so the culling loop loads 8 boxes with a single load per component
+	struct BoxArrays
+	{
+		std::vector<float> MinX, MinY, MinZ;
+		std::vector<float> MaxX, MaxY, MaxZ;
+
+		uint32_t GetCount() const { return (uint32_t)MinX.size(); }
+
+		void Resize(uint32_t count);
+		void PushBack(const glm::vec3& min, const glm::vec3& max);
+		void Set(uint32_t index, const glm::vec3& min, const glm::vec3& max);
+		// Moves the last box into index and drops the last one
+		void SwapRemove(uint32_t index);
+	};
+
+	// Tests boxes against a frustum, 8 per iteration with AVX2, 4 with SSE and one at a time otherwise.
+	// Only FrustumCullerAVX2.cpp is built with AVX2, its kernel is picked at runtime on CPUs that support it.
+	// Callers split big arrays into ranges and cull them on different workers, ranges only ever write their own flags
+	class FrustumCuller
+	{
+		public :
+			// Writes 1 to visible[i] for every box of [start, end) that touches the frustum, 0 otherwise
+			static void Cull(const Frustum& frustum, const BoxArrays& boxes, uint32_t start, uint32_t end, uint8_t* visible);
+
+			// Arvo's method, the box of the transformed box
+			static void TransformBox(const glm::mat4& transform, const glm::vec3& min, const glm::vec3& max, glm::vec3& outMin, glm::vec3& outMax);
+
+			static bool UsesAVX2();
+
+		private :
+			// The component arrays holding the corner furthest along a plane's normal, picked once per plane rather than per box
+			struct PlaneCorner
+			{
+				const float* X;
+				const float* Y;
+				const float* Z;
+			};
+
+			// Culls whole groups of 8, returns the first box it didn't get to. Does nothing when built without AVX2
+			static uint32_t CullAVX2(const Frustum& frustum, const PlaneCorner* corners, uint32_t start, uint32_t end, uint8_t* visible);
+	};
+
+}
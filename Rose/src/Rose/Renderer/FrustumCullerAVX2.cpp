@@ -0,0 +1,47 @@
+#include "FrustumCuller.h"
+
+// Built with AVX2 enabled (see premake5.lua), nothing else in the engine is. Only called once UsesAVX2() said so
+#if defined(__AVX2__)
+	#include <immintrin.h>
+	#define ROSE_FRUSTUM_AVX2
+#endif
+
+namespace Rose
+{
+
+	uint32_t FrustumCuller::CullAVX2(const Frustum& frustum, const PlaneCorner* corners, uint32_t start, uint32_t end, uint8_t* visible)
+	{
+		uint32_t i = start;
+
+#if defined(ROSE_FRUSTUM_AVX2)
+		__m256 planeX[Frustum::PlaneCount], planeY[Frustum::PlaneCount], planeZ[Frustum::PlaneCount], planeW[Frustum::PlaneCount];
+		for (uint32_t p = 0; p < Frustum::PlaneCount; p++)
+		{
+			planeX[p] = _mm256_set1_ps(frustum.Planes[p].x);
+			planeY[p] = _mm256_set1_ps(frustum.Planes[p].y);
+			planeZ[p] = _mm256_set1_ps(frustum.Planes[p].z);
+			planeW[p] = _mm256_set1_ps(frustum.Planes[p].w);
+		}
+
+		const __m256 zero = _mm256_setzero_ps();
+		for (; i + 8 <= end; i += 8)
+		{
+			__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+			for (uint32_t p = 0; p < Frustum::PlaneCount; p++)
+			{
+				__m256 distance = _mm256_add_ps(_mm256_mul_ps(planeX[p], _mm256_loadu_ps(corners[p].X + i)), planeW[p]);
+				distance = _mm256_add_ps(distance, _mm256_mul_ps(planeY[p], _mm256_loadu_ps(corners[p].Y + i)));
+				distance = _mm256_add_ps(distance, _mm256_mul_ps(planeZ[p], _mm256_loadu_ps(corners[p].Z + i)));
+				inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, zero, _CMP_GE_OQ));
+			}
+
+			uint32_t mask = (uint32_t)_mm256_movemask_ps(inside);
+			for (uint32_t lane = 0; lane < 8; lane++)
+				visible[i + lane] = (mask >> lane) & 1;
+		}
+#endif
+
+		return i;
+	}
+
+}
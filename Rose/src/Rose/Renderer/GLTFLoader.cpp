@@ -0,0 +1,679 @@
+#include "GLTFLoader.h"
+
+#include "Rose/Core/Log.h"
+#include "Rose/Core/Json.h"
+#include "Rose/Core/JobSystem.h"
+#include "Rose/Core/MappedFile.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+
+#include <glm/gtc/quaternion.hpp>
+
+namespace Rose
+{
+
+	static const uint32_t s_GLBMagic = 0x46546C67; // "glTF"
+	static const uint32_t s_GLBChunkJSON = 0x4E4F534A;
+	static const uint32_t s_GLBChunkBIN = 0x004E4942;
+
+	// Component types as defined by the glTF spec
+	static const uint32_t s_Byte = 5120;
+	static const uint32_t s_UnsignedByte = 5121;
+	static const uint32_t s_Short = 5122;
+	static const uint32_t s_UnsignedShort = 5123;
+	static const uint32_t s_UnsignedInt = 5125;
+	static const uint32_t s_Float = 5126;
+
+	static const uint32_t s_MaxNodeDepth = 256;
+
+
+	namespace Utils {
+
+		struct BufferData
+		{
+			const uint8_t* Data = nullptr;
+			size_t Size = 0;
+		};
+
+		struct AccessorView
+		{
+			const uint8_t* Data = nullptr; // First element
+			uint32_t Count = 0;
+			uint32_t ComponentType = 0;
+			uint32_t ComponentCount = 0;
+			uint32_t Stride = 0;
+			bool Normalized = false;
+		};
+
+		struct LoadCounters
+		{
+			std::atomic<uint32_t> StridedCopies{ 0 };
+			std::atomic<uint32_t> Conversions{ 0 };
+		};
+
+		static uint32_t ComponentSize(uint32_t componentType)
+		{
+			switch (componentType)
+			{
+				case s_Byte:
+				case s_UnsignedByte: return 1;
+				case s_Short:
+				case s_UnsignedShort: return 2;
+				case s_UnsignedInt:
+				case s_Float: return 4;
+			}
+			return 0;
+		}
+
+		static uint32_t ComponentCount(const std::string& type)
+		{
+			if (type == "SCALAR") return 1;
+			if (type == "VEC2") return 2;
+			if (type == "VEC3") return 3;
+			if (type == "VEC4") return 4;
+			return 0;
+		}
+
+		static std::string DecodeURI(const std::string& uri)
+		{
+			std::string result;
+			for (size_t i = 0; i < uri.size(); i++)
+			{
+				if (uri[i] == '%' && i + 2 < uri.size())
+				{
+					result += (char)strtol(uri.substr(i + 1, 2).c_str(), nullptr, 16);
+					i += 2;
+				}
+				else
+				{
+					result += uri[i];
+				}
+			}
+			return result;
+		}
+
+		// Sparse accessors and accessors without a buffer view aren't supported
+		static bool ResolveAccessor(const JsonValue& document, const std::vector<BufferData>& buffers, const JsonValue& index, AccessorView& outView)
+		{
+			if (index.IsNull())
+				return false;
+
+			const JsonValue& accessor = document["accessors"][index.AsUInt()];
+			if (!accessor.Contains("bufferView") || accessor.Contains("sparse"))
+				return false;
+
+			const JsonValue& bufferView = document["bufferViews"][accessor["bufferView"].AsUInt()];
+			uint32_t buffer = bufferView["buffer"].AsUInt();
+			if (bufferView.IsNull() || buffer >= buffers.size() || !buffers[buffer].Data)
+				return false;
+
+			outView.ComponentType = accessor["componentType"].AsUInt();
+			outView.ComponentCount = ComponentCount(accessor["type"].AsString());
+			outView.Count = accessor["count"].AsUInt();
+			outView.Normalized = accessor["normalized"].AsBool();
+
+			uint32_t elementSize = ComponentSize(outView.ComponentType) * outView.ComponentCount;
+			if (!elementSize)
+				return false;
+
+			outView.Stride = bufferView["byteStride"].AsUInt(elementSize);
+
+			uint64_t viewOffset = bufferView["byteOffset"].AsUInt(0);
+			uint64_t viewLength = bufferView["byteLength"].AsUInt();
+			uint64_t offset = accessor["byteOffset"].AsUInt(0);
+
+			if (viewOffset + viewLength > buffers[buffer].Size)
+				return false;
+			if (outView.Count && offset + (uint64_t)outView.Stride * (outView.Count - 1) + elementSize > viewLength)
+				return false;
+
+			outView.Data = buffers[buffer].Data + viewOffset + offset;
+			return true;
+		}
+
+		static float ReadComponent(const uint8_t* data, uint32_t componentType, bool normalized)
+		{
+			switch (componentType)
+			{
+				case s_Float:
+				{
+					float value;
+					memcpy(&value, data, sizeof(float));
+					return value;
+				}
+				case s_Byte:
+				{
+					int8_t value = *(const int8_t*)data;
+					return normalized ? std::max(value / 127.0f, -1.0f) : (float)value;
+				}
+				case s_UnsignedByte:
+					return normalized ? data[0] / 255.0f : (float)data[0];
+				case s_Short:
+				{
+					int16_t value;
+					memcpy(&value, data, sizeof(int16_t));
+					return normalized ? std::max(value / 32767.0f, -1.0f) : (float)value;
+				}
+				case s_UnsignedShort:
+				{
+					uint16_t value;
+					memcpy(&value, data, sizeof(uint16_t));
+					return normalized ? value / 65535.0f : (float)value;
+				}
+				case s_UnsignedInt:
+				{
+					uint32_t value;
+					memcpy(&value, data, sizeof(uint32_t));
+					return (float)value;
+				}
+			}
+			return 0.0f;
+		}
+
+		// Writes the accessor into one member of every vertex. Float data is a strided copy, anything else is converted per component
+		static void CopyAttribute(const AccessorView& view, std::vector<Vertex>& vertices, size_t memberOffset, uint32_t componentCount, LoadCounters& counters)
+		{
+			uint8_t* destination = (uint8_t*)vertices.data() + memberOffset;
+
+			if (view.ComponentType == s_Float)
+			{
+				size_t size = componentCount * sizeof(float);
+				for (uint32_t i = 0; i < view.Count; i++)
+					memcpy(destination + i * sizeof(Vertex), view.Data + (size_t)i * view.Stride, size);
+
+				counters.StridedCopies++;
+				return;
+			}
+
+			uint32_t componentSize = ComponentSize(view.ComponentType);
+			for (uint32_t i = 0; i < view.Count; i++)
+			{
+				float* member = (float*)(destination + i * sizeof(Vertex));
+				for (uint32_t c = 0; c < componentCount; c++)
+					member[c] = ReadComponent(view.Data + (size_t)i * view.Stride + c * componentSize, view.ComponentType, view.Normalized);
+			}
+			counters.Conversions++;
+		}
+
+		static void GenerateNormals(Mesh& mesh)
+		{
+			for (auto& vertex : mesh.Verticies)
+				vertex.Normal = glm::vec3(0.0f);
+
+			// Unnormalized face normals weigh every triangle by its area
+			for (size_t i = 0; i + 2 < mesh.Indicies.size(); i += 3)
+			{
+				Vertex& v0 = mesh.Verticies[mesh.Indicies[i + 0]];
+				Vertex& v1 = mesh.Verticies[mesh.Indicies[i + 1]];
+				Vertex& v2 = mesh.Verticies[mesh.Indicies[i + 2]];
+
+				glm::vec3 normal = glm::cross(v1.Position - v0.Position, v2.Position - v0.Position);
+				v0.Normal += normal;
+				v1.Normal += normal;
+				v2.Normal += normal;
+			}
+
+			for (auto& vertex : mesh.Verticies)
+			{
+				float length = glm::length(vertex.Normal);
+				vertex.Normal = length > 0.0f ? vertex.Normal / length : glm::vec3(0.0f, 1.0f, 0.0f);
+			}
+		}
+
+		static void GenerateTangents(Mesh& mesh)
+		{
+			for (auto& vertex : mesh.Verticies)
+			{
+				vertex.Tangent = glm::vec3(0.0f);
+				vertex.Binormal = glm::vec3(0.0f);
+			}
+
+			for (size_t i = 0; i + 2 < mesh.Indicies.size(); i += 3)
+			{
+				Vertex& v0 = mesh.Verticies[mesh.Indicies[i + 0]];
+				Vertex& v1 = mesh.Verticies[mesh.Indicies[i + 1]];
+				Vertex& v2 = mesh.Verticies[mesh.Indicies[i + 2]];
+
+				glm::vec3 edge1 = v1.Position - v0.Position;
+				glm::vec3 edge2 = v2.Position - v0.Position;
+				glm::vec2 deltaUV1 = v1.TexCoord - v0.TexCoord;
+				glm::vec2 deltaUV2 = v2.TexCoord - v0.TexCoord;
+
+				float determinant = deltaUV1.x * deltaUV2.y - deltaUV2.x * deltaUV1.y;
+				if (glm::abs(determinant) < 1e-12f)
+					continue;
+
+				float r = 1.0f / determinant;
+				glm::vec3 tangent = (edge1 * deltaUV2.y - edge2 * deltaUV1.y) * r;
+				glm::vec3 binormal = (edge2 * deltaUV1.x - edge1 * deltaUV2.x) * r;
+
+				v0.Tangent += tangent; v1.Tangent += tangent; v2.Tangent += tangent;
+				v0.Binormal += binormal; v1.Binormal += binormal; v2.Binormal += binormal;
+			}
+
+			for (auto& vertex : mesh.Verticies)
+			{
+				// Gram-Schmidt against the normal, vertices without usable UVs get any perpendicular frame
+				glm::vec3 tangent = vertex.Tangent - vertex.Normal * glm::dot(vertex.Normal, vertex.Tangent);
+				if (glm::length(tangent) < 1e-6f)
+					tangent = glm::cross(vertex.Normal, glm::abs(vertex.Normal.x) < 0.9f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f));
+				tangent = glm::normalize(tangent);
+
+				float handedness = glm::dot(glm::cross(vertex.Normal, tangent), vertex.Binormal) < 0.0f ? -1.0f : 1.0f;
+				vertex.Tangent = tangent;
+				vertex.Binormal = glm::cross(vertex.Normal, tangent) * handedness;
+			}
+		}
+
+		static bool ConvertPrimitive(const JsonValue& document, const std::vector<BufferData>& buffers, const JsonValue& primitive, Mesh& outMesh, LoadCounters& counters)
+		{
+			const JsonValue& attributes = primitive["attributes"];
+
+			AccessorView position, normal, tangent, binormal, texCoord;
+			if (!ResolveAccessor(document, buffers, attributes["POSITION"], position) || position.ComponentCount != 3)
+				return false;
+
+			uint32_t vertexCount = position.Count;
+			auto resolveOptional = [&](const char* name, AccessorView& view, uint32_t componentCount) -> AccessorView*
+			{
+				if (!ResolveAccessor(document, buffers, attributes[name], view) || view.Count != vertexCount || view.ComponentCount < componentCount)
+					return nullptr;
+				return &view;
+			};
+
+			AccessorView* normalView = resolveOptional("NORMAL", normal, 3);
+			AccessorView* texCoordView = resolveOptional("TEXCOORD_0", texCoord, 2);
+			// Application specific attributes written by exporters that keep our vertex layout (tangent and binormal as separate vec3s)
+			AccessorView* roseTangentView = resolveOptional("_TANGENT", tangent, 3);
+			AccessorView* binormalView = resolveOptional("_BINORMAL", binormal, 3);
+			AccessorView* tangentView = roseTangentView ? roseTangentView : resolveOptional("TANGENT", tangent, 4);
+
+			if (tangentView && tangentView->ComponentType != s_Float)
+				tangentView = nullptr;
+
+			outMesh.Verticies.resize(vertexCount);
+
+			CopyAttribute(position, outMesh.Verticies, offsetof(Vertex, Position), 3, counters);
+			if (normalView)
+				CopyAttribute(*normalView, outMesh.Verticies, offsetof(Vertex, Normal), 3, counters);
+			if (texCoordView)
+				CopyAttribute(*texCoordView, outMesh.Verticies, offsetof(Vertex, TexCoord), 2, counters);
+			if (tangentView)
+				CopyAttribute(*tangentView, outMesh.Verticies, offsetof(Vertex, Tangent), 3, counters);
+			if (roseTangentView && binormalView)
+				CopyAttribute(*binormalView, outMesh.Verticies, offsetof(Vertex, Binormal), 3, counters);
+
+			AccessorView indices;
+			if (ResolveAccessor(document, buffers, primitive["indices"], indices))
+			{
+				if (indices.ComponentCount != 1)
+					return false;
+
+				outMesh.Indicies.resize(indices.Count);
+				if (indices.ComponentType == s_UnsignedInt && indices.Stride == sizeof(uint32_t))
+				{
+					memcpy(outMesh.Indicies.data(), indices.Data, (size_t)indices.Count * sizeof(uint32_t));
+					counters.StridedCopies++;
+				}
+				else
+				{
+					for (uint32_t i = 0; i < indices.Count; i++)
+						outMesh.Indicies[i] = (uint32_t)ReadComponent(indices.Data + (size_t)i * indices.Stride, indices.ComponentType, false);
+					counters.Conversions++;
+				}
+
+				for (uint32_t index : outMesh.Indicies)
+				{
+					if (index >= vertexCount)
+						return false;
+				}
+			}
+			else
+			{
+				// Non indexed, every three vertices are a triangle
+				outMesh.Indicies.resize(vertexCount);
+				for (uint32_t i = 0; i < vertexCount; i++)
+					outMesh.Indicies[i] = i;
+			}
+
+			if (!normalView)
+				GenerateNormals(outMesh);
+
+			if (tangentView == &tangent && !roseTangentView)
+			{
+				// glTF tangents are vec4, w holds the handedness of the binormal
+				for (uint32_t i = 0; i < vertexCount; i++)
+				{
+					Vertex& vertex = outMesh.Verticies[i];
+					float handedness = ReadComponent(tangent.Data + (size_t)i * tangent.Stride + 3 * sizeof(float), s_Float, false);
+					vertex.Binormal = glm::cross(vertex.Normal, vertex.Tangent) * handedness;
+				}
+			}
+			else if (!tangentView)
+			{
+				GenerateTangents(outMesh);
+			}
+			else if (!binormalView)
+			{
+				for (auto& vertex : outMesh.Verticies)
+					vertex.Binormal = glm::cross(vertex.Normal, vertex.Tangent);
+			}
+
+			outMesh.CalculateBounds();
+			return true;
+		}
+
+		// Up to 4 numbers of a JSON array, missing ones keep the fallback's
+		static glm::vec4 ReadVector(const JsonValue& array, const glm::vec4& fallback)
+		{
+			glm::vec4 result = fallback;
+			for (size_t i = 0; i < array.Size() && i < 4; i++)
+				result[(glm::length_t)i] = array[i].AsFloat(fallback[(glm::length_t)i]);
+			return result;
+		}
+
+		// Either a column major matrix or translation, rotation (xyzw quaternion) and scale
+		static glm::mat4 GetNodeTransform(const JsonValue& node)
+		{
+			const JsonValue& matrix = node["matrix"];
+			if (matrix.Size() == 16)
+			{
+				glm::mat4 result;
+				for (size_t i = 0; i < 16; i++)
+					result[(glm::length_t)(i / 4)][(glm::length_t)(i % 4)] = matrix[i].AsFloat();
+				return result;
+			}
+
+			glm::vec3 translation = ReadVector(node["translation"], glm::vec4(0.0f));
+			glm::vec4 r = ReadVector(node["rotation"], glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+			glm::quat rotation = glm::quat(r.w, r.x, r.y, r.z);
+			glm::vec3 scale = ReadVector(node["scale"], glm::vec4(1.0f));
+
+			glm::mat4 result = glm::mat4_cast(rotation);
+			result[0] *= scale.x;
+			result[1] *= scale.y;
+			result[2] *= scale.z;
+			result[3] = glm::vec4(translation, 1.0f);
+			return result;
+		}
+
+		// Depth first, so parents end up before their children. outMeshNodes is the node of every mesh in outMeshes
+		static void CollectNode(const JsonValue& document, uint32_t nodeIndex, uint32_t depth, uint32_t parent,
+			std::vector<CookedNode>& outNodes, std::vector<uint32_t>& outMeshes, std::vector<uint32_t>& outMeshNodes)
+		{
+			const JsonValue& node = document["nodes"][nodeIndex];
+			if (node.IsNull() || depth > s_MaxNodeDepth)
+				return;
+
+			CookedNode cookedNode;
+			cookedNode.LocalTransform = GetNodeTransform(node);
+			cookedNode.Parent = parent;
+
+			uint32_t cookedIndex = (uint32_t)outNodes.size();
+			outNodes.push_back(cookedNode);
+
+			if (node.Contains("mesh"))
+			{
+				outMeshes.push_back(node["mesh"].AsUInt());
+				outMeshNodes.push_back(cookedIndex);
+			}
+
+			const JsonValue& children = node["children"];
+			for (size_t i = 0; i < children.Size(); i++)
+				CollectNode(document, children[i].AsUInt(), depth + 1, cookedIndex, outNodes, outMeshes, outMeshNodes);
+		}
+
+		static std::string GetTexturePath(const JsonValue& document, const JsonValue& textureInfo, const std::string& directory)
+		{
+			if (textureInfo.IsNull())
+				return "";
+
+			const JsonValue& texture = document["textures"][textureInfo["index"].AsUInt()];
+			if (!texture.Contains("source"))
+				return "";
+
+			const JsonValue& image = document["images"][texture["source"].AsUInt()];
+			const std::string& uri = image["uri"].AsString();
+			if (uri.empty() || uri.rfind("data:", 0) == 0)
+			{
+				LOG("glTF images embedded in buffers or data URIs are not supported, using the default texture\n");
+				return "";
+			}
+
+			return (std::filesystem::path(directory) / DecodeURI(uri)).generic_string();
+		}
+
+	}
+
+
+	bool GLTFLoader::IsGLTF(const std::string& filepath)
+	{
+		std::string extension = std::filesystem::path(filepath).extension().string();
+		std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+		return extension == ".gltf" || extension == ".glb";
+	}
+
+	bool GLTFLoader::Load(const std::string& filepath, CookedModel& outModel, bool isStatic)
+	{
+		std::string directory = std::filesystem::path(filepath).parent_path().string();
+
+		// Mapped files stay open until the load is done, the accessors point straight into them
+		std::vector<std::unique_ptr<MappedFile>> files;
+		files.push_back(std::make_unique<MappedFile>(filepath));
+		if (!files[0]->IsValid())
+		{
+			LOG("Could not open glTF '%s'\n", filepath.c_str());
+			return false;
+		}
+
+		const uint8_t* fileData = files[0]->GetData();
+		size_t fileSize = files[0]->GetSize();
+
+		const char* jsonText = (const char*)fileData;
+		size_t jsonSize = fileSize;
+		Utils::BufferData binaryChunk;
+
+		uint32_t magic = 0;
+		if (fileSize >= sizeof(uint32_t))
+			memcpy(&magic, fileData, sizeof(uint32_t));
+
+		if (magic == s_GLBMagic)
+		{
+			// 12 byte header then chunks of { length, type, data }, JSON first and an optional BIN chunk
+			jsonText = nullptr;
+			size_t offset = 12;
+			while (offset + 8 <= fileSize)
+			{
+				uint32_t chunkLength, chunkType;
+				memcpy(&chunkLength, fileData + offset, sizeof(uint32_t));
+				memcpy(&chunkType, fileData + offset + 4, sizeof(uint32_t));
+				offset += 8;
+
+				if (offset + chunkLength > fileSize)
+					break;
+
+				if (chunkType == s_GLBChunkJSON && !jsonText)
+				{
+					jsonText = (const char*)fileData + offset;
+					jsonSize = chunkLength;
+				}
+				else if (chunkType == s_GLBChunkBIN && !binaryChunk.Data)
+				{
+					binaryChunk.Data = fileData + offset;
+					binaryChunk.Size = chunkLength;
+				}
+
+				offset += (chunkLength + 3) & ~3u;
+			}
+
+			if (!jsonText)
+			{
+				LOG("glTF binary '%s' has no JSON chunk\n", filepath.c_str());
+				return false;
+			}
+		}
+
+		JsonValue document;
+		if (!JsonValue::Parse(jsonText, jsonSize, document))
+		{
+			LOG("Could not parse glTF '%s'\n", filepath.c_str());
+			return false;
+		}
+
+		if (document["asset"]["version"].AsString().rfind("2.", 0) != 0)
+		{
+			LOG("glTF '%s' is not version 2.x\n", filepath.c_str());
+			return false;
+		}
+
+		std::vector<Utils::BufferData> buffers;
+		const JsonValue& bufferList = document["buffers"];
+		for (size_t i = 0; i < bufferList.Size(); i++)
+		{
+			const JsonValue& buffer = bufferList[i];
+			if (!buffer.Contains("uri"))
+			{
+				buffers.push_back(i == 0 ? binaryChunk : Utils::BufferData());
+				continue;
+			}
+
+			const std::string& uri = buffer["uri"].AsString();
+			if (uri.rfind("data:", 0) == 0)
+			{
+				LOG("glTF '%s' uses a data URI buffer, those are not supported\n", filepath.c_str());
+				return false;
+			}
+
+			files.push_back(std::make_unique<MappedFile>((std::filesystem::path(directory) / Utils::DecodeURI(uri)).string()));
+			if (!files.back()->IsValid())
+			{
+				LOG("Could not open glTF buffer '%s'\n", uri.c_str());
+				return false;
+			}
+
+			buffers.push_back({ files.back()->GetData(), files.back()->GetSize() });
+		}
+
+		// Meshes in node order when there is a scene, like the Assimp path
+		std::vector<uint32_t> meshes;
+		std::vector<uint32_t> meshNodes;
+		std::vector<CookedNode> nodes;
+		const JsonValue& scene = document["scenes"][document["scene"].AsUInt(0)];
+		if (!scene.IsNull())
+		{
+			const JsonValue& rootNodes = scene["nodes"];
+			for (size_t i = 0; i < rootNodes.Size(); i++)
+				Utils::CollectNode(document, rootNodes[i].AsUInt(), 0, UINT32_MAX, nodes, meshes, meshNodes);
+		}
+		else
+		{
+			// No scene, every mesh sits at the origin
+			nodes.push_back(CookedNode());
+			for (uint32_t i = 0; i < document["meshes"].Size(); i++)
+			{
+				meshes.push_back(i);
+				meshNodes.push_back(0);
+			}
+		}
+
+		std::vector<const JsonValue*> primitives;
+		std::vector<uint32_t> primitiveNodes;
+		for (uint32_t m = 0; m < meshes.size(); m++)
+		{
+			const JsonValue& primitiveList = document["meshes"][meshes[m]]["primitives"];
+			for (size_t i = 0; i < primitiveList.Size(); i++)
+			{
+				// Only triangle lists
+				if (primitiveList[i]["mode"].AsUInt(4) != 4)
+					continue;
+				primitives.push_back(&primitiveList[i]);
+				primitiveNodes.push_back(meshNodes[m]);
+			}
+		}
+
+		if (primitives.empty())
+		{
+			LOG("glTF '%s' has no triangle primitives\n", filepath.c_str());
+			return false;
+		}
+
+		CookedModel model;
+		model.Meshes.resize(primitives.size());
+
+		Utils::LoadCounters counters;
+		std::vector<uint8_t> converted(primitives.size(), 0);
+		{
+			JobCounter counter;
+			for (uint32_t i = 0; i < primitives.size(); i++)
+			{
+				JobSystem::Run([&, i]()
+				{
+					converted[i] = Utils::ConvertPrimitive(document, buffers, *primitives[i], model.Meshes[i], counters);
+				}, &counter);
+			}
+			JobSystem::Wait(counter);
+		}
+
+		for (uint32_t i = 0; i < primitives.size(); i++)
+		{
+			if (!converted[i])
+			{
+				LOG("glTF '%s' has a primitive with an unsupported layout\n", filepath.c_str());
+				return false;
+			}
+		}
+
+		// Texture order matches the Assimp path, metal and roughness share the packed glTF texture
+		const JsonValue& materials = document["materials"];
+		for (size_t i = 0; i < materials.Size(); i++)
+		{
+			const JsonValue& material = materials[i];
+			const JsonValue& pbr = material["pbrMetallicRoughness"];
+
+			CookedMaterial result;
+			result.Name = material.Contains("name") ? material["name"].AsString() : "No name";
+			result.Textures.push_back({ PBRTextureType::Albedo, Utils::GetTexturePath(document, pbr["baseColorTexture"], directory) });
+			result.Textures.push_back({ PBRTextureType::Normal, Utils::GetTexturePath(document, material["normalTexture"], directory), true });
+			result.Textures.push_back({ PBRTextureType::Metal, Utils::GetTexturePath(document, pbr["metallicRoughnessTexture"], directory) });
+			result.Textures.push_back({ PBRTextureType::Rough, Utils::GetTexturePath(document, pbr["metallicRoughnessTexture"], directory) });
+			result.AlbedoFactor = Utils::ReadVector(pbr["baseColorFactor"], glm::vec4(1.0f));
+			result.MetalnessFactor = pbr["metallicFactor"].AsFloat(1.0f);
+			result.RoughnessFactor = pbr["roughnessFactor"].AsFloat(1.0f);
+			model.Materials.push_back(result);
+		}
+
+		uint32_t defaultMaterial = (uint32_t)-1;
+		for (auto primitive : primitives)
+		{
+			uint32_t material = (*primitive)["material"].AsUInt((uint32_t)-1);
+			if (material >= model.Materials.size())
+			{
+				if (defaultMaterial == (uint32_t)-1)
+				{
+					defaultMaterial = (uint32_t)model.Materials.size();
+					model.Materials.push_back({ "Default", { { PBRTextureType::Albedo, "" }, { PBRTextureType::Normal, "", true }, { PBRTextureType::Metal, "" }, { PBRTextureType::Rough, "" } } });
+				}
+				material = defaultMaterial;
+			}
+			model.MeshMaterials.push_back(material);
+		}
+
+		model.Nodes = std::move(nodes);
+		model.MeshNodes = std::move(primitiveNodes);
+		MeshCooker::Process(model, isStatic, filepath);
+
+		LOG("Parsed glTF '%s': %d primitives in %d meshes, %d accessors copied, %d converted\n", filepath.c_str(),
+			(uint32_t)primitives.size(), (uint32_t)model.Meshes.size(), counters.StridedCopies.load(), counters.Conversions.load());
+
+		outModel = std::move(model);
+		return true;
+	}
+
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "MeshCooker.h"
+
+#include <string>
+
+namespace Rose
+{
+
+	// Native glTF 2.0 (.gltf and .glb) parser that skips Assimp. It isn't zero copy: buffers are memory mapped, but every accessor is read
+	// into the Mesh's Vertex array (a strided copy for float data, converted otherwise), since static batching, meshlets and LODs rework
+	// vertices and indices on the CPU and the geometry pool's formats don't match glTF's layout anyway. Models cook the result like an Assimp import.
+	// Every triangle primitive becomes one Mesh hanging off its node, then MeshCooker::Process optimizes, batches and builds LODs like on the Assimp path.
+	class GLTFLoader
+	{
+		public :
+			static bool IsGLTF(const std::string& filepath);
+			static bool Load(const std::string& filepath, CookedModel& outModel, bool isStatic);
+	};
+
+}
@@ -0,0 +1,239 @@
+#include "GPUScene.h"
+
+#include "Rose/Core/Application.h"
+#include "Rose/Core/Log.h"
+
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+namespace Rose
+{
+
+	std::vector<ObjectRecord> GPUScene::s_Objects;
+	std::vector<uint32_t> GPUScene::s_DirtyFrames;
+	std::vector<uint32_t> GPUScene::s_DirtyList;
+
+	VkBuffer GPUScene::s_Buffer = VK_NULL_HANDLE;
+	VmaAllocation GPUScene::s_Allocation = nullptr;
+	uint8_t* GPUScene::s_MappedData = nullptr;
+
+	VkBuffer GPUScene::s_InstanceBuffer = VK_NULL_HANDLE;
+	VmaAllocation GPUScene::s_InstanceAllocation = nullptr;
+	uint8_t* GPUScene::s_InstanceMappedData = nullptr;
+
+	VkBuffer GPUScene::s_MaterialBuffer = VK_NULL_HANDLE;
+	VmaAllocation GPUScene::s_MaterialAllocation = nullptr;
+	MaterialRecord* GPUScene::s_MaterialMappedData = nullptr;
+
+	uint32_t GPUScene::s_MaxObjects = 0;
+	uint32_t GPUScene::s_MaxMaterials = 0;
+	uint32_t GPUScene::s_MaterialCount = 0;
+	uint32_t GPUScene::s_FramesInFlight = 1;
+	uint32_t GPUScene::s_FrameSize = 0;
+	uint32_t GPUScene::s_InstanceFrameSize = 0;
+	uint32_t GPUScene::s_LastUploadCount = 0;
+
+
+	namespace Utils {
+
+		static glm::mat4 ComputeNormalMatrix(const glm::mat4& transform)
+		{
+			glm::mat3 model = glm::mat3(transform);
+			float det = glm::determinant(model);
+			if (det == 0.0f)
+				return glm::mat4(model);
+
+			// Inverse transpose, rescaled so a uniformly scaled model keeps the same normal length as mat3(model) did
+			float scale = std::cbrt(std::abs(det));
+			return glm::mat4(glm::transpose(glm::inverse(model)) * (scale * scale));
+		}
+	}
+
+
+	void GPUScene::Init(uint32_t maxObjects, uint32_t maxMaterials, uint32_t framesInFlight)
+	{
+		s_MaxObjects = maxObjects;
+		s_MaxMaterials = maxMaterials;
+		s_FramesInFlight = framesInFlight ? framesInFlight : 1;
+
+		const auto& props = Application::Get().GetContext()->GetPhysicalDevice()->GetProperties();
+		uint32_t alignment = (uint32_t)props.limits.minStorageBufferOffsetAlignment;
+		if (!alignment)
+			alignment = 1;
+
+		s_FrameSize = (maxObjects * sizeof(ObjectRecord) + alignment - 1) & ~(alignment - 1);
+		s_InstanceFrameSize = (maxObjects * sizeof(uint32_t) + alignment - 1) & ~(alignment - 1);
+
+		VkBufferCreateInfo bufferInfo{};
+		bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		bufferInfo.size = (VkDeviceSize)s_FrameSize * s_FramesInFlight;
+		bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+		bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+		VKMemAllocator allocator;
+		s_Allocation = allocator.AllocateBuffer(bufferInfo, VMA_MEMORY_USAGE_CPU_TO_GPU, &s_Buffer);
+
+		void* data = nullptr;
+		allocator.Map(s_Allocation, &data);
+		s_MappedData = (uint8_t*)data;
+
+		bufferInfo.size = (VkDeviceSize)s_InstanceFrameSize * s_FramesInFlight;
+		s_InstanceAllocation = allocator.AllocateBuffer(bufferInfo, VMA_MEMORY_USAGE_CPU_TO_GPU, &s_InstanceBuffer);
+
+		allocator.Map(s_InstanceAllocation, &data);
+		s_InstanceMappedData = (uint8_t*)data;
+
+		bufferInfo.size = (VkDeviceSize)maxMaterials * sizeof(MaterialRecord);
+		s_MaterialAllocation = allocator.AllocateBuffer(bufferInfo, VMA_MEMORY_USAGE_CPU_TO_GPU, &s_MaterialBuffer);
+
+		allocator.Map(s_MaterialAllocation, &data);
+		s_MaterialMappedData = (MaterialRecord*)data;
+
+		s_Objects.reserve(maxObjects);
+	}
+
+	void GPUScene::Shutdown()
+	{
+		VKMemAllocator allocator;
+		allocator.UnMap(s_Allocation);
+		allocator.Free(s_Allocation, s_Buffer);
+		allocator.UnMap(s_InstanceAllocation);
+		allocator.Free(s_InstanceAllocation, s_InstanceBuffer);
+		allocator.UnMap(s_MaterialAllocation);
+		allocator.Free(s_MaterialAllocation, s_MaterialBuffer);
+
+		s_MappedData = nullptr;
+		s_Buffer = VK_NULL_HANDLE;
+		s_InstanceMappedData = nullptr;
+		s_InstanceBuffer = VK_NULL_HANDLE;
+		s_MaterialMappedData = nullptr;
+		s_MaterialBuffer = VK_NULL_HANDLE;
+		s_MaterialCount = 0;
+
+		s_Objects.clear();
+		s_DirtyFrames.clear();
+		s_DirtyList.clear();
+	}
+
+	uint32_t GPUScene::AddObject(const glm::mat4& transform, const Mesh& mesh, uint32_t materialIndex)
+	{
+		if (s_Objects.size() >= s_MaxObjects)
+		{
+			LOG("GPUScene is full! (max objects: %d)\n", s_MaxObjects);
+			ASSERT();
+			return 0;
+		}
+
+		ObjectRecord record;
+		record.Model = transform;
+		record.NormalMatrix = Utils::ComputeNormalMatrix(transform);
+		record.BoundingSphere = mesh.BoundingSphere;
+		record.PositionScale = glm::vec4(mesh.BoundsMax - mesh.BoundsMin, 0.0f);
+		record.PositionOffset = glm::vec4(mesh.BoundsMin, 0.0f);
+		record.MaterialIndex = materialIndex;
+
+		uint32_t index = (uint32_t)s_Objects.size();
+		s_Objects.push_back(record);
+		s_DirtyFrames.push_back(0);
+		MarkDirty(index);
+
+		return index;
+	}
+
+	void GPUScene::SetTransform(uint32_t objectIndex, const glm::mat4& transform)
+	{
+		auto& record = s_Objects[objectIndex];
+		if (record.Model == transform)
+			return;
+
+		record.Model = transform;
+		record.NormalMatrix = Utils::ComputeNormalMatrix(transform);
+		MarkDirty(objectIndex);
+	}
+
+	void GPUScene::SetMaterialIndex(uint32_t objectIndex, uint32_t materialIndex)
+	{
+		auto& record = s_Objects[objectIndex];
+		if (record.MaterialIndex == materialIndex)
+			return;
+
+		record.MaterialIndex = materialIndex;
+		MarkDirty(objectIndex);
+	}
+
+	uint32_t GPUScene::AddMaterial(const MaterialRecord& material)
+	{
+		if (s_MaterialCount >= s_MaxMaterials)
+		{
+			LOG("GPUScene material buffer is full! (max materials: %d)\n", s_MaxMaterials);
+			ASSERT();
+			return 0;
+		}
+
+		// A new slot isn't read by any frame in flight yet, so it's written straight into the only copy
+		uint32_t index = s_MaterialCount++;
+		s_MaterialMappedData[index] = material;
+		vmaFlushAllocation(VKMemAllocator::GetVMAAllocator(), s_MaterialAllocation, (VkDeviceSize)index * sizeof(MaterialRecord), sizeof(MaterialRecord));
+
+		return index;
+	}
+
+	void GPUScene::MarkDirty(uint32_t objectIndex)
+	{
+		if (!s_DirtyFrames[objectIndex])
+			s_DirtyList.push_back(objectIndex);
+
+		s_DirtyFrames[objectIndex] = s_FramesInFlight;
+	}
+
+	uint32_t GPUScene::Update(uint32_t frameIndex)
+	{
+		uint32_t frameOffset = frameIndex * s_FrameSize;
+		ObjectRecord* records = (ObjectRecord*)(s_MappedData + frameOffset);
+
+		s_LastUploadCount = (uint32_t)s_DirtyList.size();
+		for (uint32_t i = 0; i < s_DirtyList.size();)
+		{
+			uint32_t objectIndex = s_DirtyList[i];
+			memcpy(&records[objectIndex], &s_Objects[objectIndex], sizeof(ObjectRecord));
+
+			// Once every frame's copy has it, the object is clean again
+			if (--s_DirtyFrames[objectIndex] == 0)
+			{
+				s_DirtyList[i] = s_DirtyList.back();
+				s_DirtyList.pop_back();
+				continue;
+			}
+			i++;
+		}
+
+		if (s_LastUploadCount)
+			vmaFlushAllocation(VKMemAllocator::GetVMAAllocator(), s_Allocation, frameOffset, s_FrameSize);
+
+		return frameOffset;
+	}
+
+	uint32_t GPUScene::UpdateInstances(uint32_t frameIndex, const std::vector<uint32_t>& objectIndices)
+	{
+		uint32_t frameOffset = frameIndex * s_InstanceFrameSize;
+		uint32_t count = (uint32_t)std::min(objectIndices.size(), (size_t)s_MaxObjects);
+		if (!count)
+			return frameOffset;
+
+		memcpy(s_InstanceMappedData + frameOffset, objectIndices.data(), count * sizeof(uint32_t));
+		vmaFlushAllocation(VKMemAllocator::GetVMAAllocator(), s_InstanceAllocation, frameOffset, count * sizeof(uint32_t));
+
+		return frameOffset;
+	}
+
+	std::unordered_map<uint32_t, VkDescriptorBufferInfo> GPUScene::GetStorageBuffers()
+	{
+		std::unordered_map<uint32_t, VkDescriptorBufferInfo> buffers;
+		buffers[ObjectBufferBinding] = { s_Buffer, 0, s_FrameSize };
+		buffers[InstanceBufferBinding] = { s_InstanceBuffer, 0, s_InstanceFrameSize };
+		buffers[MaterialBufferBinding] = { s_MaterialBuffer, 0, (VkDeviceSize)s_MaxMaterials * sizeof(MaterialRecord) };
+		return buffers;
+	}
+
+}
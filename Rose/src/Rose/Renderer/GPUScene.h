@@ -0,0 +1,104 @@
+#pragma once
+
+#include <vulkan1.2.182.0/include/Vulkan/vulkan/vulkan.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <unordered_map>
+
+#include "API/VKMemAllocator.h"
+#include "Mesh.h"
+
+namespace Rose
+{
+
+	// std430, has to match ObjectRecord in the shaders
+	struct ObjectRecord
+	{
+		glm::mat4 Model = glm::mat4(1.0f);
+		glm::mat4 NormalMatrix = glm::mat4(1.0f);
+		glm::vec4 BoundingSphere = glm::vec4(0.0f); // Object space center (xyz) and radius (w)
+		glm::vec4 PositionScale = glm::vec4(1.0f); // Quantized positions are PositionOffset + position * PositionScale, xyz only
+		glm::vec4 PositionOffset = glm::vec4(0.0f);
+		uint32_t MaterialIndex = 0; // Into the material buffer
+		uint32_t Padding[3] = { 0, 0, 0 };
+	};
+
+	// std430, has to match MaterialRecord in the shaders. Only the factors, textures are still bound through the material's descriptor set
+	struct MaterialRecord
+	{
+		glm::vec4 AlbedoFactor = glm::vec4(1.0f);
+		float MetalnessFactor = 1.0f;
+		float RoughnessFactor = 1.0f;
+		uint32_t Padding[2] = { 0, 0 };
+	};
+
+	// Every object's transform and material data in one storage buffer.
+	// The buffer holds a copy per frame in flight, changed objects are copied into each of those copies over the next frames
+	// so the GPU never reads a record while it's being written.
+	// Draws don't index it directly, they push an offset into the frame's instance list, and instance i of the draw
+	// reads the object at InstanceList[offset + i]. The instance list is rewritten every frame.
+	// Materials are only ever appended, so their buffer has a single copy that's written once per material.
+	class GPUScene
+	{
+		public :
+			static const uint32_t ObjectBufferBinding = 8;
+			static const uint32_t InstanceBufferBinding = 9;
+			static const uint32_t MaterialBufferBinding = 10;
+
+			static void Init(uint32_t maxObjects, uint32_t maxMaterials, uint32_t framesInFlight);
+			static void Shutdown();
+
+			static uint32_t AddObject(const glm::mat4& transform, const Mesh& mesh, uint32_t materialIndex);
+			static void SetTransform(uint32_t objectIndex, const glm::mat4& transform);
+			static void SetMaterialIndex(uint32_t objectIndex, uint32_t materialIndex);
+
+			// Returns the index objects refer to the material with
+			static uint32_t AddMaterial(const MaterialRecord& material);
+
+			// Copies the dirty objects into the frame's copy and returns the dynamic offset of that copy
+			static uint32_t Update(uint32_t frameIndex);
+			// Writes the frame's instance list (object indices) and returns its dynamic offset, at most one entry per object
+			static uint32_t UpdateInstances(uint32_t frameIndex, const std::vector<uint32_t>& objectIndices);
+
+			static VkBuffer GetBuffer() { return s_Buffer; }
+			static VkDeviceSize GetFrameRange() { return s_FrameSize; }
+			static VkBuffer GetInstanceBuffer() { return s_InstanceBuffer; }
+			static VkDeviceSize GetInstanceFrameRange() { return s_InstanceFrameSize; }
+			// Every buffer by the binding the shaders declare it at
+			static std::unordered_map<uint32_t, VkDescriptorBufferInfo> GetStorageBuffers();
+
+			static const ObjectRecord& GetObject(uint32_t objectIndex) { return s_Objects[objectIndex]; }
+			static uint32_t GetObjectCount() { return (uint32_t)s_Objects.size(); }
+			static uint32_t GetLastUploadCount() { return s_LastUploadCount; }
+			static uint32_t GetMaterialCount() { return s_MaterialCount; }
+
+		private :
+			static void MarkDirty(uint32_t objectIndex);
+
+		private :
+			static std::vector<ObjectRecord> s_Objects;
+			static std::vector<uint32_t> s_DirtyFrames; // How many frame copies are still out of date, per object
+			static std::vector<uint32_t> s_DirtyList;
+
+			static VkBuffer s_Buffer;
+			static VmaAllocation s_Allocation;
+			static uint8_t* s_MappedData;
+
+			static VkBuffer s_InstanceBuffer;
+			static VmaAllocation s_InstanceAllocation;
+			static uint8_t* s_InstanceMappedData;
+
+			static VkBuffer s_MaterialBuffer;
+			static VmaAllocation s_MaterialAllocation;
+			static MaterialRecord* s_MaterialMappedData;
+
+			static uint32_t s_MaxObjects;
+			static uint32_t s_MaxMaterials;
+			static uint32_t s_MaterialCount;
+			static uint32_t s_FramesInFlight;
+			static uint32_t s_FrameSize;
+			static uint32_t s_InstanceFrameSize;
+			static uint32_t s_LastUploadCount;
+	};
+
+}
@@ -0,0 +1,168 @@
+#include "GeometryPool.h"
+
+#include "API/UploadManager.h"
+#include "Rose/Core/Log.h"
+
+#include <cstring>
+
+namespace Rose
+{
+
+	namespace Utils {
+
+		static VkDeviceSize AlignStream(VkDeviceSize offset)
+		{
+			return (offset + 15) & ~(VkDeviceSize)15;
+		}
+
+	}
+
+
+	GeometryPool::GeometryPool(VertexFormat format, uint32_t maxVertices, uint32_t maxIndices)
+		: m_Format(format), m_VertexAllocator(maxVertices), m_IndexAllocator(maxIndices)
+	{
+		VkDeviceSize vertexSize = 0;
+		for (uint32_t stream = 0; stream < VertexStream_Count; stream++)
+		{
+			m_StreamStrides[stream] = VertexPacker::GetStride(format, (VertexStream)stream);
+			m_StreamOffsets[stream] = vertexSize;
+			vertexSize = Utils::AlignStream(vertexSize + (VkDeviceSize)maxVertices * m_StreamStrides[stream]);
+		}
+
+		VKMemAllocator allocator;
+
+		VkBufferCreateInfo bufferInfo{};
+		bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		bufferInfo.size = vertexSize;
+		bufferInfo.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+		bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		m_VertexAllocation = allocator.AllocateBuffer(bufferInfo, VMA_MEMORY_USAGE_GPU_ONLY, &m_VertexBuffer);
+
+		bufferInfo.size = (VkDeviceSize)maxIndices * sizeof(uint32_t);
+		bufferInfo.usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+		m_IndexAllocation = allocator.AllocateBuffer(bufferInfo, VMA_MEMORY_USAGE_GPU_ONLY, &m_IndexBuffer);
+	}
+
+	GeometryPool::~GeometryPool()
+	{
+		if (!m_IsFreed)
+			FreeMemory();
+	}
+
+	bool GeometryPool::Allocate(const Mesh& mesh, GeometryAllocation& outAllocation)
+	{
+		auto streams = VertexPacker::Pack(mesh, m_Format);
+
+		PackedGeometry geometry;
+		geometry.Format = m_Format;
+		geometry.VertexCount = (uint32_t)mesh.Verticies.size();
+		geometry.IndexCount = (uint32_t)mesh.Indicies.size();
+		for (uint32_t stream = 0; stream < VertexStream_Count; stream++)
+			geometry.Streams[stream] = streams[stream].data();
+		geometry.Indices = mesh.Indicies.data();
+
+		return Allocate(geometry, outAllocation);
+	}
+
+	bool GeometryPool::Allocate(const PackedGeometry& geometry, GeometryAllocation& outAllocation)
+	{
+		if (geometry.Format != m_Format)
+		{
+			LOG("Geometry pool can't take vertices packed in another format\n");
+			return false;
+		}
+
+		GeometryAllocation allocation;
+		allocation.VertexCount = geometry.VertexCount;
+		allocation.IndexCount = geometry.IndexCount;
+
+		// Every index fits into 16 bits, half the index fetch bandwidth
+		bool shortIndices = allocation.VertexCount <= 65536;
+		allocation.IndexType = shortIndices ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+		allocation.IndexWordCount = shortIndices ? (allocation.IndexCount + 1) / 2 : allocation.IndexCount;
+
+		if (!m_VertexAllocator.Allocate(allocation.VertexCount, allocation.VertexOffset))
+		{
+			LOG("Geometry pool is out of vertex space (%d vertices requested, largest free block is %d)\n", allocation.VertexCount, m_VertexAllocator.GetLargestFreeBlock());
+			return false;
+		}
+		if (!m_IndexAllocator.Allocate(allocation.IndexWordCount, allocation.IndexWordOffset))
+		{
+			LOG("Geometry pool is out of index space (%d indices requested)\n", allocation.IndexCount);
+			m_VertexAllocator.Free(allocation.VertexOffset, allocation.VertexCount);
+			return false;
+		}
+		allocation.FirstIndex = shortIndices ? allocation.IndexWordOffset * 2 : allocation.IndexWordOffset;
+
+		for (uint32_t stream = 0; stream < VertexStream_Count; stream++)
+		{
+			VkDeviceSize streamSize = (VkDeviceSize)allocation.VertexCount * m_StreamStrides[stream];
+			if (!streamSize || !geometry.Streams[stream])
+				continue;
+
+			StagingRegion staging = UploadManager::Stage(geometry.Streams[stream], streamSize);
+
+			VkBufferCopy copy{};
+			copy.srcOffset = staging.Offset;
+			copy.dstOffset = m_StreamOffsets[stream] + (VkDeviceSize)allocation.VertexOffset * m_StreamStrides[stream];
+			copy.size = streamSize;
+			vkCmdCopyBuffer(UploadManager::GetCommandBuffer(), staging.Buffer, m_VertexBuffer, 1, &copy);
+
+			UploadManager::TransferOwnership(m_VertexBuffer, copy.dstOffset, copy.size, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT);
+		}
+
+		if (allocation.IndexCount)
+		{
+			VkDeviceSize indexSize = (VkDeviceSize)allocation.IndexWordCount * sizeof(uint32_t);
+			StagingRegion staging = UploadManager::AllocateStaging(indexSize);
+			if (shortIndices)
+			{
+				// An odd count leaves the last half word of the range unused
+				uint16_t* shortIndicies = (uint16_t*)staging.Data;
+				for (uint32_t i = 0; i < allocation.IndexCount; i++)
+					shortIndicies[i] = (uint16_t)geometry.Indices[i];
+				if (allocation.IndexCount & 1)
+					shortIndicies[allocation.IndexCount] = 0;
+			}
+			else
+				memcpy(staging.Data, geometry.Indices, indexSize);
+
+			VkBufferCopy copy{};
+			copy.srcOffset = staging.Offset;
+			copy.dstOffset = (VkDeviceSize)allocation.IndexWordOffset * sizeof(uint32_t);
+			copy.size = indexSize;
+			vkCmdCopyBuffer(UploadManager::GetCommandBuffer(), staging.Buffer, m_IndexBuffer, 1, &copy);
+
+			UploadManager::TransferOwnership(m_IndexBuffer, copy.dstOffset, copy.size, VK_ACCESS_INDEX_READ_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT);
+		}
+
+		outAllocation = allocation;
+		return true;
+	}
+
+	void GeometryPool::Free(const GeometryAllocation& allocation)
+	{
+		m_VertexAllocator.Free(allocation.VertexOffset, allocation.VertexCount);
+		m_IndexAllocator.Free(allocation.IndexWordOffset, allocation.IndexWordCount);
+	}
+
+	void GeometryPool::FreeMemory()
+	{
+		m_IsFreed = true;
+		VKMemAllocator allocator;
+		allocator.Free(m_VertexAllocation, m_VertexBuffer);
+		allocator.Free(m_IndexAllocation, m_IndexBuffer);
+	}
+
+	void GeometryPool::BindVertexStreams(VkCommandBuffer commandBuffer, uint32_t streamCount) const
+	{
+		VkBuffer buffers[VertexStream_Count] = { m_VertexBuffer, m_VertexBuffer };
+		vkCmdBindVertexBuffers(commandBuffer, 0, streamCount, buffers, m_StreamOffsets);
+	}
+
+	void GeometryPool::BindIndexBuffer(VkCommandBuffer commandBuffer, VkIndexType indexType) const
+	{
+		vkCmdBindIndexBuffer(commandBuffer, m_IndexBuffer, 0, indexType);
+	}
+
+}
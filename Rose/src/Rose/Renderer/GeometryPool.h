@@ -0,0 +1,73 @@
+#pragma once
+
+#include <vulkan1.2.182.0/include/Vulkan/vulkan/vulkan.h>
+#include <vector>
+
+#include "API/VKMemAllocator.h"
+#include "Rose/Core/FreeListAllocator.h"
+#include "Mesh.h"
+#include "VertexFormat.h"
+
+namespace Rose
+{
+
+	// Where a mesh lives inside a GeometryPool, drawn with vkCmdDrawIndexed(IndexCount, 1, FirstIndex, VertexOffset, 0)
+	struct GeometryAllocation
+	{
+		uint32_t VertexOffset = 0; // In vertices, indices stay local to the mesh
+		uint32_t VertexCount = 0;
+		uint32_t FirstIndex = 0; // In indices of IndexType from the start of the index arena
+		uint32_t IndexCount = 0;
+		VkIndexType IndexType = VK_INDEX_TYPE_UINT32;
+
+		uint32_t IndexWordOffset = 0; // Where the range starts in the index arena's allocator, in 4 byte words
+		uint32_t IndexWordCount = 0;
+	};
+
+	// Device local vertex and index arenas every mesh of one vertex format is sub allocated from,
+	// so the renderer binds the arenas once and draws go through offsets instead of rebinding buffers.
+	// The vertex arena has one region per VertexStream, a vertex offset applies to all of them.
+	// The index arena mixes 16 and 32 bit ranges, they're allocated in 4 byte words so both index types stay aligned.
+	// Data is copied in through the UploadManager, allocating only records the upload.
+	class GeometryPool
+	{
+		public :
+			GeometryPool(VertexFormat format, uint32_t maxVertices, uint32_t maxIndices);
+			~GeometryPool();
+
+			// Packs the mesh into the pool's format, false when either arena has no room left for it
+			bool Allocate(const Mesh& mesh, GeometryAllocation& outAllocation);
+			// Stages the streams as they are, they have to be in the pool's format
+			bool Allocate(const PackedGeometry& geometry, GeometryAllocation& outAllocation);
+			// The GPU has to be done with every draw that used the allocation
+			void Free(const GeometryAllocation& allocation);
+
+			void FreeMemory();
+
+			// Binds the first streamCount vertex streams starting at binding 0
+			void BindVertexStreams(VkCommandBuffer commandBuffer, uint32_t streamCount = VertexStream_Count) const;
+			// 16 and 32 bit ranges share one buffer, draws only have to rebind it when the index type changes
+			void BindIndexBuffer(VkCommandBuffer commandBuffer, VkIndexType indexType) const;
+
+			VertexFormat GetVertexFormat() const { return m_Format; }
+			const FreeListAllocator& GetVertexAllocator() const { return m_VertexAllocator; }
+			const FreeListAllocator& GetIndexAllocator() const { return m_IndexAllocator; }
+
+		private :
+			VertexFormat m_Format;
+
+			VkBuffer m_VertexBuffer = VK_NULL_HANDLE;
+			VmaAllocation m_VertexAllocation = nullptr;
+			VkBuffer m_IndexBuffer = VK_NULL_HANDLE;
+			VmaAllocation m_IndexAllocation = nullptr;
+
+			VkDeviceSize m_StreamOffsets[VertexStream_Count];
+			uint32_t m_StreamStrides[VertexStream_Count];
+
+			FreeListAllocator m_VertexAllocator; // In vertices
+			FreeListAllocator m_IndexAllocator; // In 4 byte words
+
+			bool m_IsFreed = false;
+	};
+
+}
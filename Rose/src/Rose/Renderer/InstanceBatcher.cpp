@@ -0,0 +1,142 @@
+#include "InstanceBatcher.h"
+
+#include "GPUScene.h"
+#include "ClusterCuller.h"
+#include "LODSelector.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace Rose
+{
+
+	std::vector<InstancedMesh> InstanceBatcher::s_Meshes;
+	std::vector<uint32_t> InstanceBatcher::s_MeshOrder;
+
+	std::vector<uint64_t> InstanceBatcher::s_SortKeys;
+	std::vector<uint32_t> InstanceBatcher::s_InstanceList;
+	std::vector<InstanceBatch> InstanceBatcher::s_Batches;
+
+	bool InstanceBatcher::s_MeshesChanged = false;
+	InstanceStats InstanceBatcher::s_Stats;
+
+
+	void InstanceBatcher::Shutdown()
+	{
+		s_Meshes.clear();
+		s_MeshOrder.clear();
+		s_SortKeys.clear();
+		s_InstanceList.clear();
+		s_Batches.clear();
+	}
+
+	uint32_t InstanceBatcher::AddMesh(const Mesh& mesh, const Material& material, const GeometryAllocation& geometry)
+	{
+		InstancedMesh instancedMesh;
+		instancedMesh.MeshData = &mesh;
+		instancedMesh.MaterialData = &material;
+		instancedMesh.Geometry = geometry;
+
+		s_Meshes.push_back(instancedMesh);
+		s_MeshesChanged = true;
+		return (uint32_t)s_Meshes.size() - 1;
+	}
+
+	RenderItem InstanceBatcher::AddInstance(uint32_t mesh, const glm::mat4& transform, bool cullClusters)
+	{
+		const auto& instancedMesh = s_Meshes[mesh];
+
+		RenderItem item;
+		item.Mesh = mesh;
+		item.ObjectIndex = GPUScene::AddObject(transform, *instancedMesh.MeshData, instancedMesh.MaterialData->RecordIndex);
+		item.ClusterGroup = cullClusters ? ClusterCuller::AddMesh(*instancedMesh.MeshData, instancedMesh.Geometry, item.ObjectIndex) : UINT32_MAX;
+		return item;
+	}
+
+	void InstanceBatcher::SortMeshes()
+	{
+		std::vector<uint32_t> sorted(s_Meshes.size());
+		std::iota(sorted.begin(), sorted.end(), 0);
+
+		// Pipeline changes cost the most, then descriptor sets, then index buffer rebinds
+		std::sort(sorted.begin(), sorted.end(), [](uint32_t a, uint32_t b)
+		{
+			const auto& meshA = s_Meshes[a];
+			const auto& meshB = s_Meshes[b];
+			uint64_t pipelineA = (uint64_t)meshA.MaterialData->ShaderData->GetGrahpicsPipeline();
+			uint64_t pipelineB = (uint64_t)meshB.MaterialData->ShaderData->GetGrahpicsPipeline();
+			if (pipelineA != pipelineB)
+				return pipelineA < pipelineB;
+			if (meshA.MaterialData != meshB.MaterialData)
+				return meshA.MaterialData < meshB.MaterialData;
+			if (meshA.Geometry.IndexType != meshB.Geometry.IndexType)
+				return meshA.Geometry.IndexType < meshB.Geometry.IndexType;
+			return a < b;
+		});
+
+		s_MeshOrder.resize(s_Meshes.size());
+		for (uint32_t rank = 0; rank < sorted.size(); rank++)
+			s_MeshOrder[sorted[rank]] = rank;
+
+		s_MeshesChanged = false;
+	}
+
+	uint32_t InstanceBatcher::Build(uint32_t frameIndex, const std::vector<RenderItem>& items)
+	{
+		if (s_MeshesChanged)
+			SortMeshes();
+
+		// Mesh rank, then LOD, then item, so instances of one batch end up next to each other
+		s_SortKeys.clear();
+		for (uint32_t i = 0; i < items.size(); i++)
+		{
+			const auto& item = items[i];
+			uint32_t lod = LODSelector::Select(item.ObjectIndex, *s_Meshes[item.Mesh].MeshData);
+			if (lod == LODSelector::Culled)
+				continue;
+
+			s_SortKeys.push_back(((uint64_t)s_MeshOrder[item.Mesh] << 40) | ((uint64_t)lod << 32) | i);
+		}
+		std::sort(s_SortKeys.begin(), s_SortKeys.end());
+
+		s_InstanceList.clear();
+		s_Batches.clear();
+		for (uint64_t key : s_SortKeys)
+		{
+			const auto& item = items[(uint32_t)key];
+			uint32_t lod = (uint32_t)(key >> 32) & 0xFF;
+
+			// Only LOD 0 has clusters, coarser LODs are instanced like everything else
+			uint32_t clusterGroup = lod == 0 ? item.ClusterGroup : UINT32_MAX;
+
+			bool extends = !s_Batches.empty() && clusterGroup == UINT32_MAX && s_Batches.back().ClusterGroup == UINT32_MAX
+				&& s_Batches.back().Mesh == item.Mesh && s_Batches.back().LOD == lod;
+			if (extends)
+				s_Batches.back().InstanceCount++;
+			else
+				s_Batches.push_back({ item.Mesh, lod, (uint32_t)s_InstanceList.size(), 1, clusterGroup });
+
+			s_InstanceList.push_back(item.ObjectIndex);
+		}
+
+		s_Stats.Items = (uint32_t)items.size();
+		s_Stats.Instances = (uint32_t)s_InstanceList.size();
+		s_Stats.Batches = (uint32_t)s_Batches.size();
+
+		return GPUScene::UpdateInstances(frameIndex, s_InstanceList);
+	}
+
+	void InstanceBatcher::Draw(VkCommandBuffer commandBuffer, const InstanceBatch& batch)
+	{
+		if (batch.ClusterGroup != UINT32_MAX)
+		{
+			ClusterCuller::Draw(commandBuffer, batch.ClusterGroup);
+			return;
+		}
+
+		const auto& mesh = s_Meshes[batch.Mesh];
+		MeshLOD range = mesh.MeshData->GetLOD(batch.LOD);
+		vkCmdDrawIndexed(commandBuffer, range.IndexCount, batch.InstanceCount, mesh.Geometry.FirstIndex + range.FirstIndex, mesh.Geometry.VertexOffset, 0);
+	}
+
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <vulkan1.2.182.0/include/Vulkan/vulkan/vulkan.h>
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "GeometryPool.h"
+#include "Material.h"
+#include "Mesh.h"
+
+namespace Rose
+{
+
+	// A mesh every placement of it draws with, it keeps pointers so the mesh and material have to outlive the batcher
+	struct InstancedMesh
+	{
+		const Mesh* MeshData = nullptr;
+		const Material* MaterialData = nullptr;
+		GeometryAllocation Geometry;
+	};
+
+	// One placement of a mesh, the Scene packs one for every visible MeshRenderer into the frame's render item list
+	struct RenderItem
+	{
+		uint32_t Mesh = 0;
+		uint32_t ObjectIndex = 0; // GPUScene object
+		uint32_t ClusterGroup = UINT32_MAX; // Set for cluster culled placements, which are always drawn on their own
+	};
+
+	// One draw call, InstanceCount render items of the same mesh at the same LOD
+	struct InstanceBatch
+	{
+		uint32_t Mesh = 0;
+		uint32_t LOD = 0;
+		uint32_t FirstInstance = 0; // Into the frame's instance list, pushed as the draw's instance offset
+		uint32_t InstanceCount = 0;
+		uint32_t ClusterGroup = UINT32_MAX;
+	};
+
+	struct InstanceStats
+	{
+		uint32_t Items = 0; // Handed to Build()
+		uint32_t Instances = 0; // Left after LOD selection
+		uint32_t Batches = 0;
+	};
+
+	// Every placement of every mesh is an object in the GPUScene, so placing a model again only costs an ObjectRecord.
+	// Once per frame Build() picks the LOD of every visible render item, drops the ones too small to see and groups the rest
+	// by mesh and LOD into batches ordered by pipeline and material, then writes their object indices into the GPUScene's instance list.
+	class InstanceBatcher
+	{
+		public :
+			static void Shutdown();
+
+			// Returns the id placements refer to the mesh with
+			static uint32_t AddMesh(const Mesh& mesh, const Material& material, const GeometryAllocation& geometry);
+			// Adds a GPUScene object for the placement, drawn with the mesh's material.
+			// Cluster culled placements get their own ClusterCuller group and are never instanced, meant for a few big meshes
+			static RenderItem AddInstance(uint32_t mesh, const glm::mat4& transform, bool cullClusters = false);
+
+			// Expects frustum culled items and LODSelector::BeginFrame(), returns the dynamic offset of the frame's instance list
+			static uint32_t Build(uint32_t frameIndex, const std::vector<RenderItem>& items);
+			// Expects the pipeline, descriptors, the instance offset push constant and the geometry pool's buffers to be bound
+			static void Draw(VkCommandBuffer commandBuffer, const InstanceBatch& batch);
+
+			static const std::vector<InstanceBatch>& GetBatches() { return s_Batches; }
+			static const InstancedMesh& GetMesh(uint32_t mesh) { return s_Meshes[mesh]; }
+			static const InstanceStats& GetStats() { return s_Stats; }
+
+		private :
+			static void SortMeshes();
+
+		private :
+			static std::vector<InstancedMesh> s_Meshes;
+			static std::vector<uint32_t> s_MeshOrder; // Rank of every mesh once sorted by pipeline, material and index type
+
+			static std::vector<uint64_t> s_SortKeys;
+			static std::vector<uint32_t> s_InstanceList;
+			static std::vector<InstanceBatch> s_Batches;
+
+			static bool s_MeshesChanged;
+			static InstanceStats s_Stats;
+	};
+
+}
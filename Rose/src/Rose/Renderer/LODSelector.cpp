@@ -0,0 +1,69 @@
+#include "LODSelector.h"
+#include "GPUScene.h"
+
+#include <algorithm>
+
+namespace Rose
+{
+
+	std::vector<uint32_t> LODSelector::s_CurrentLODs;
+	glm::vec3 LODSelector::s_CameraPosition = glm::vec3(0.0f);
+	float LODSelector::s_PixelsPerUnit = 1.0f;
+	float LODSelector::s_ErrorThreshold = 1.0f;
+	float LODSelector::s_CullThreshold = 1.0f;
+	float LODSelector::s_Hysteresis = 0.25f;
+	LODStats LODSelector::s_Stats;
+
+
+	void LODSelector::BeginFrame(const glm::mat4& view, const glm::mat4& projection, float viewportHeight)
+	{
+		s_CameraPosition = glm::vec3(glm::inverse(view)[3]);
+		// projection[1][1] is 1 / tan(fov / 2), half the viewport spans that many units at a distance of 1
+		s_PixelsPerUnit = glm::abs(projection[1][1]) * viewportHeight * 0.5f;
+		s_Stats = LODStats();
+	}
+
+	uint32_t LODSelector::Select(uint32_t objectIndex, const Mesh& mesh)
+	{
+		if (objectIndex >= s_CurrentLODs.size())
+			s_CurrentLODs.resize(objectIndex + 1, 0);
+
+		const auto& object = GPUScene::GetObject(objectIndex);
+		glm::vec3 center = glm::vec3(object.Model * glm::vec4(glm::vec3(mesh.BoundingSphere), 1.0f));
+		float scale = std::max(glm::length(glm::vec3(object.Model[0])), std::max(glm::length(glm::vec3(object.Model[1])), glm::length(glm::vec3(object.Model[2]))));
+		float radius = mesh.BoundingSphere.w * scale;
+
+		float centerDistance = glm::length(center - s_CameraPosition);
+		if (centerDistance > radius && 2.0f * radius * s_PixelsPerUnit / centerDistance < s_CullThreshold)
+		{
+			s_Stats.Culled++;
+			return Culled;
+		}
+
+		// The closest point of the bounds, errors are never projected from further away than they can be
+		float distance = std::max(centerDistance - radius, 1e-3f);
+		float pixelsPerError = scale * s_PixelsPerUnit / distance;
+
+		uint32_t lodCount = std::min(mesh.GetLODCount(), MeshSimplifier::MaxLODs);
+		uint32_t current = std::min(s_CurrentLODs[objectIndex], lodCount - 1);
+
+		uint32_t lod = current;
+		if (mesh.GetLOD(current).Error * pixelsPerError > s_ErrorThreshold)
+		{
+			// Too coarse, refine to the coarsest one that's good enough
+			while (lod > 0 && mesh.GetLOD(lod).Error * pixelsPerError > s_ErrorThreshold)
+				lod--;
+		}
+		else
+		{
+			float coarsenThreshold = s_ErrorThreshold * (1.0f - s_Hysteresis);
+			while (lod + 1 < lodCount && mesh.GetLOD(lod + 1).Error * pixelsPerError <= coarsenThreshold)
+				lod++;
+		}
+
+		s_CurrentLODs[objectIndex] = lod;
+		s_Stats.Objects[lod]++;
+		return lod;
+	}
+
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "Mesh.h"
+#include "MeshSimplifier.h"
+
+namespace Rose
+{
+
+	struct LODStats
+	{
+		uint32_t Objects[MeshSimplifier::MaxLODs] = {}; // Objects drawn at each LOD this frame
+		uint32_t Culled = 0; // Smaller than the cull threshold on screen
+	};
+
+	// Picks the LOD every object is drawn with from how many pixels its simplification error covers on screen.
+	// The LOD an object was drawn with last is kept per object, it only switches to a coarser one once that one is comfortably
+	// under the threshold, so objects sitting right at a switching distance don't pop back and forth.
+	class LODSelector
+	{
+		public :
+			static const uint32_t Culled = UINT32_MAX;
+
+			// The projection is the camera's, viewportHeight is in pixels
+			static void BeginFrame(const glm::mat4& view, const glm::mat4& projection, float viewportHeight);
+
+			// Coarsest LOD whose error stays under the error threshold, or Culled when the object is too small to see
+			static uint32_t Select(uint32_t objectIndex, const Mesh& mesh);
+
+			// Projected error in pixels a LOD may have
+			static void SetErrorThreshold(float pixels) { s_ErrorThreshold = pixels; }
+			static float GetErrorThreshold() { return s_ErrorThreshold; }
+			// Objects whose bounding sphere is smaller than this many pixels across aren't drawn
+			static void SetCullThreshold(float pixels) { s_CullThreshold = pixels; }
+			static float GetCullThreshold() { return s_CullThreshold; }
+			// Fraction of the threshold a coarser LOD has to be under before switching to it
+			static void SetHysteresis(float fraction) { s_Hysteresis = fraction; }
+
+			static const LODStats& GetStats() { return s_Stats; }
+
+		private :
+			static std::vector<uint32_t> s_CurrentLODs; // Per object
+			static glm::vec3 s_CameraPosition;
+			static float s_PixelsPerUnit; // At a distance of 1
+			static float s_ErrorThreshold;
+			static float s_CullThreshold;
+			static float s_Hysteresis;
+			static LODStats s_Stats;
+	};
+
+}
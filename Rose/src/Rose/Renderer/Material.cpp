@@ -0,0 +1,48 @@
+#include "Material.h"
+
+#include "Rose/Core/Application.h"
+#include "API/UniformRingBuffer.h"
+#include "GPUScene.h"
+
+namespace Rose
+{
+
+	std::shared_ptr<Texture2D> Material::s_DefaultWhiteTexture;
+
+	void Material::CreateDescriptorSet()
+	{
+		ShaderData->CreateDescriptorPool(DescriptorPool);
+		ShaderData->CreateDescriptorSet(Uniforms, UniformRingBuffer::GetBuffer(), GPUScene::GetStorageBuffers(), DescriptorPool, DescriptorSet);
+	}
+
+	void Material::CreateRecord()
+	{
+		MaterialRecord record;
+		record.AlbedoFactor = AlbedoFactor;
+		record.MetalnessFactor = MetalnessFactor;
+		record.RoughnessFactor = RoughnessFactor;
+		RecordIndex = GPUScene::AddMaterial(record);
+	}
+
+	std::shared_ptr<Texture2D> Material::DefaultWhiteTexture()
+	{
+		if (!s_DefaultWhiteTexture)
+			s_DefaultWhiteTexture = std::make_shared<Texture2D>("assets/textures/white.png");
+		return s_DefaultWhiteTexture;
+	}
+
+	void Material::ReleaseDefaultTextures()
+	{
+		s_DefaultWhiteTexture.reset();
+	}
+
+	void Material::Destroy()
+	{
+		const auto& device = Application::Get().GetContext()->GetLogicalDevice()->GetDevice();
+
+		vkDestroyDescriptorPool(device, DescriptorPool, nullptr);
+		DescriptorPool = VK_NULL_HANDLE;
+		DescriptorSet = VK_NULL_HANDLE;
+	}
+
+}
@@ -2,6 +2,7 @@
 
 #include "API/Texture.h"
 #include "API/Shader.h"
+#include <glm/glm.hpp>
 #include <vector>
 
 namespace Rose
@@ -19,23 +20,38 @@ namespace Rose
 		std::shared_ptr<TextureCube> Texture3DCube;
 		PBRTextureType TextureType;
 	};
+	// The shader (and its pipeline) is shared between materials, the descriptor set is per material.
+	// Uniform data lives in the UniformRingBuffer, object data and instance lists in the GPUScene, all are selected with dynamic offsets when binding,
+	// so one set covers every frame in flight.
 	struct Material
 	{
 		std::string Name;
 		std::vector<MaterialUniform> Uniforms;
 		std::shared_ptr<Rose::Shader> ShaderData;
 
-		~Material()
-		{
-			//ShaderData->DestroyPipeline();
-		}
+		VkDescriptorPool DescriptorPool = VK_NULL_HANDLE;
+		VkDescriptorSet DescriptorSet = VK_NULL_HANDLE;
 
+		// The textures are multiplied with these
+		glm::vec4 AlbedoFactor = glm::vec4(1.0f);
+		float MetalnessFactor = 1.0f;
+		float RoughnessFactor = 1.0f;
+		// Index into the GPUScene material buffer, set by CreateRecord()
+		uint32_t RecordIndex = 0;
 
-		static std::shared_ptr<Texture2D> DefaultWhiteTexture()
-		{
-			static std::shared_ptr<Texture2D> white = std::make_shared<Texture2D>("assets/textures/white.png");
-			return white;
-		}
+
+		void CreateDescriptorSet();
+		// Adds the factors to the GPUScene material buffer
+		void CreateRecord();
+		void Destroy();
+
+
+		static std::shared_ptr<Texture2D> DefaultWhiteTexture();
+		// Drops the engine's reference on shutdown, the texture goes with the last material using it
+		static void ReleaseDefaultTextures();
+
+	private :
+		static std::shared_ptr<Texture2D> s_DefaultWhiteTexture;
 	};
 
 
@@ -4,6 +4,7 @@
 
 #include <array>
 #include <vector>
+#include <limits>
 
 
 
@@ -27,11 +28,82 @@ namespace Rose
 	};
 
 
+	// A run of at most MeshletBuilder::MaxTriangles consecutive triangles of the index buffer that reference at most MeshletBuilder::MaxVertices vertices
+	struct Meshlet
+	{
+		uint32_t FirstIndex = 0; // Into the mesh's index buffer
+		uint32_t TriangleCount = 0;
+		uint32_t VertexCount = 0; // Unique vertices the triangles reference
+		uint32_t Padding = 0;
+		glm::vec4 BoundingSphere = { 0.0f, 0.0f, 0.0f, 0.0f }; // Object space, xyz center, w radius
+		glm::vec4 Cone = { 0.0f, 0.0f, 0.0f, 1.0f }; // Normal cone axis (xyz) and the sine of its spread (w), 1 is never backfacing
+	};
+
+	// A simplified version of the mesh, its indices follow the ones of the finer LODs in the mesh's index buffer
+	struct MeshLOD
+	{
+		uint32_t FirstIndex = 0;
+		uint32_t IndexCount = 0;
+		float Error = 0.0f; // Object space distance the simplified surface may be off by, 0 for LOD 0
+		uint32_t Padding = 0;
+	};
+
+	// One of the meshes a static batch was merged from, its bounds are kept so the batch can still be culled piece by piece
+	struct SubMesh
+	{
+		uint32_t FirstIndex = 0; // Into LOD 0's indices
+		uint32_t IndexCount = 0;
+		glm::vec3 BoundsMin = { 0.0f, 0.0f, 0.0f };
+		glm::vec3 BoundsMax = { 0.0f, 0.0f, 0.0f };
+		glm::vec4 BoundingSphere = { 0.0f, 0.0f, 0.0f, 0.0f };
+	};
+
 	struct Mesh
 	{
 		std::vector<Vertex> Verticies;
 		std::vector<uint32_t> Indicies;
+		std::vector<Meshlet> Meshlets; // Cover LOD 0's indices in order, built on import
+		std::vector<MeshLOD> LODs; // Finest first, LOD 0 is the full mesh. Empty when no LODs were generated
+		std::vector<SubMesh> SubMeshes; // Cover LOD 0's indices in order, only set on static batches
+
+		// Object space, filled in on import
+		glm::vec3 BoundsMin = { 0.0f, 0.0f, 0.0f };
+		glm::vec3 BoundsMax = { 0.0f, 0.0f, 0.0f };
+		glm::vec4 BoundingSphere = { 0.0f, 0.0f, 0.0f, 0.0f }; // xyz center, w radius
+
+		// Only set when Verticies and Indicies were left empty because the data was loaded already packed for the GPU
+		uint32_t PackedVertexCount = 0;
+		uint32_t PackedIndexCount = 0;
+
+		uint32_t GetVertexCount() const { return Verticies.empty() ? PackedVertexCount : (uint32_t)Verticies.size(); }
+		uint32_t GetIndexCount() const { return Indicies.empty() ? PackedIndexCount : (uint32_t)Indicies.size(); }
+
+		uint32_t GetLODCount() const { return LODs.empty() ? 1 : (uint32_t)LODs.size(); }
+		MeshLOD GetLOD(uint32_t lod) const { return LODs.empty() ? MeshLOD{ 0, GetIndexCount(), 0.0f, 0 } : LODs[lod]; }
+
+		// Recomputes the bounds from the vertex positions
+		void CalculateBounds()
+		{
+			if (Verticies.empty())
+				return;
+
+			glm::vec3 min = glm::vec3(std::numeric_limits<float>::max());
+			glm::vec3 max = glm::vec3(std::numeric_limits<float>::lowest());
+			for (auto& vertex : Verticies)
+			{
+				min = glm::min(min, vertex.Position);
+				max = glm::max(max, vertex.Position);
+			}
+
+			glm::vec3 center = (min + max) * 0.5f;
+			float radius = 0.0f;
+			for (auto& vertex : Verticies)
+				radius = glm::max(radius, glm::length(vertex.Position - center));
 
+			BoundsMin = min;
+			BoundsMax = max;
+			BoundingSphere = glm::vec4(center, radius);
+		}
 	};
 
 }
\ No newline at end of file
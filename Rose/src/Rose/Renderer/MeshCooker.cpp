@@ -0,0 +1,544 @@
+#include "MeshCooker.h"
+#include "MeshOptimizer.h"
+#include "MeshletBuilder.h"
+#include "MeshSimplifier.h"
+#include "StaticBatcher.h"
+
+#include "Rose/Core/Log.h"
+#include "Rose/Core/MappedFile.h"
+#include "Rose/Core/JobSystem.h"
+#include "Rose/Core/Profiler.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace Rose
+{
+
+	static const char* s_CookDirectory = "assets/cache/meshes";
+	static const uint32_t s_CookMagic = 0x48534D52; // "RMSH"
+	static const uint32_t s_CookVersion = 9;
+	static const uint64_t s_BlobAlignment = 16;
+
+	// Import settings baked into the file, a mismatch recooks
+	static const uint32_t s_CookFlagOptimized = 1 << 0;
+	static const uint32_t s_CookFlagStaticBatched = 1 << 1;
+
+	struct RMeshHeader
+	{
+		uint32_t Magic;
+		uint32_t Version;
+		uint32_t VertexFormat; // The format the streams are packed in
+		uint32_t PositionStride;
+		uint32_t AttributeStride;
+		uint32_t IndexStride;
+		uint32_t MeshCount;
+		uint32_t MaterialCount;
+		uint32_t Flags;
+		uint32_t MeshletStride;
+		uint32_t LODStride;
+		uint32_t SubMeshStride;
+		uint32_t NodeCount;
+		uint32_t NodeStride;
+		uint64_t NodeTableOffset;
+		uint64_t MaterialTableOffset;
+		uint64_t DataOffset;
+	};
+
+	struct RMeshEntry
+	{
+		uint64_t StreamOffsets[VertexStream_Count]; // From the start of the file
+		uint64_t IndexOffset;
+		uint64_t MeshletOffset;
+		uint64_t LODOffset;
+		uint64_t SubMeshOffset;
+		uint32_t VertexCount;
+		uint32_t IndexCount; // Every LOD's indices
+		uint32_t MeshletCount;
+		uint32_t LODCount;
+		uint32_t SubMeshCount;
+		uint32_t MaterialIndex;
+		uint32_t NodeIndex;
+		uint32_t Padding;
+		glm::vec3 BoundsMin;
+		glm::vec3 BoundsMax;
+		glm::vec4 BoundingSphere;
+	};
+
+
+	namespace Utils {
+
+		static uint32_t GetCookFlags(bool staticBatched)
+		{
+			return (MeshOptimizer::IsEnabled() ? s_CookFlagOptimized : 0) | (staticBatched ? s_CookFlagStaticBatched : 0);
+		}
+
+		static uint64_t HashFNV1a(const void* data, size_t size)
+		{
+			uint64_t hash = 14695981039346656037ull;
+			const uint8_t* bytes = (const uint8_t*)data;
+			for (size_t i = 0; i < size; i++)
+			{
+				hash ^= bytes[i];
+				hash *= 1099511628211ull;
+			}
+			return hash;
+		}
+
+		static uint64_t Align(uint64_t value, uint64_t alignment)
+		{
+			return (value + alignment - 1) & ~(alignment - 1);
+		}
+
+		template<typename T>
+		static void Write(std::ostream& stream, const T& value)
+		{
+			stream.write((const char*)&value, sizeof(T));
+		}
+
+		static void WriteString(std::ostream& stream, const std::string& value)
+		{
+			Write(stream, (uint32_t)value.size());
+			stream.write(value.data(), value.size());
+		}
+
+		static void WritePadding(std::ostream& stream, uint64_t count)
+		{
+			static const char zeros[s_BlobAlignment] = {};
+			stream.write(zeros, count);
+		}
+
+		// Bounds checked reads out of the mapped file
+		struct BlobReader
+		{
+			const uint8_t* Data;
+			size_t Size;
+			size_t Offset;
+
+			template<typename T>
+			bool Read(T& value)
+			{
+				if (Offset + sizeof(T) > Size)
+					return false;
+
+				memcpy(&value, Data + Offset, sizeof(T));
+				Offset += sizeof(T);
+				return true;
+			}
+
+			bool ReadString(std::string& value)
+			{
+				uint32_t size;
+				if (!Read(size) || Offset + size > Size)
+					return false;
+
+				value.assign((const char*)Data + Offset, size);
+				Offset += size;
+				return true;
+			}
+		};
+
+	}
+
+
+	std::string MeshCooker::GetCookedPath(const std::string& sourcePath, VertexFormat format)
+	{
+		// Hashing the whole path keeps models with the same file name in different folders apart
+		std::string filename = std::filesystem::path(sourcePath).filename().string();
+		uint64_t hash = Utils::HashFNV1a(sourcePath.data(), sourcePath.size());
+
+		std::stringstream ss;
+		ss << s_CookDirectory << "/" << filename << "." << std::hex << hash << "." << (uint32_t)format << ".rmesh";
+		return ss.str();
+	}
+
+	bool MeshCooker::IsUpToDate(const std::string& sourcePath, const std::string& cookedPath)
+	{
+		std::error_code error;
+		auto cookedTime = std::filesystem::last_write_time(cookedPath, error);
+		if (error)
+			return false;
+
+		auto sourceTime = std::filesystem::last_write_time(sourcePath, error);
+		if (error)
+			return true;
+
+		return cookedTime >= sourceTime;
+	}
+
+	void MeshCooker::Process(CookedModel& model, bool isStatic, const std::string& name)
+	{
+		// Optimizing before batching keeps every source mesh's triangles together, which the sub meshes rely on
+		if (MeshOptimizer::IsEnabled())
+		{
+			ScopedProfile profile("Model mesh optimization");
+
+			std::vector<VertexCacheStats> before(model.Meshes.size()), after(model.Meshes.size());
+			JobCounter counter;
+			for (uint32_t i = 0; i < model.Meshes.size(); i++)
+			{
+				JobSystem::Run([&, i]()
+				{
+					MeshOptimizer::Optimize(model.Meshes[i], before[i], after[i]);
+				}, &counter);
+			}
+			JobSystem::Wait(counter);
+
+			VertexCacheStats totalBefore, totalAfter;
+			for (uint32_t i = 0; i < model.Meshes.size(); i++)
+			{
+				totalBefore.Triangles += before[i].Triangles; totalBefore.Vertices += before[i].Vertices; totalBefore.Transforms += before[i].Transforms;
+				totalAfter.Triangles += after[i].Triangles; totalAfter.Vertices += after[i].Vertices; totalAfter.Transforms += after[i].Transforms;
+			}
+
+			LOG("Optimized '%s': ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n", name.c_str(),
+				totalBefore.GetACMR(), totalAfter.GetACMR(), totalBefore.GetATVR(), totalAfter.GetATVR());
+		}
+
+		if (isStatic)
+		{
+			ScopedProfile profile("Model static batching");
+			uint32_t meshCount = (uint32_t)model.Meshes.size();
+			StaticBatcher::Merge(model);
+			LOG("Static batched '%s': %d meshes merged into %d\n", name.c_str(), meshCount, (uint32_t)model.Meshes.size());
+		}
+
+		// Meshlets and LODs are built on the merged meshes, so they run after batching
+		{
+			ScopedProfile profile("Model meshlets and LODs");
+
+			JobCounter counter;
+			for (uint32_t i = 0; i < model.Meshes.size(); i++)
+			{
+				JobSystem::Run([&, i]()
+				{
+					MeshletBuilder::Build(model.Meshes[i]);
+					MeshSimplifier::GenerateLODs(model.Meshes[i]);
+				}, &counter);
+			}
+			JobSystem::Wait(counter);
+		}
+	}
+
+	bool MeshCooker::Write(const std::string& cookedPath, const CookedModel& model, VertexFormat format)
+	{
+		std::stringstream materialTable;
+		for (auto& material : model.Materials)
+		{
+			Utils::WriteString(materialTable, material.Name);
+			Utils::Write(materialTable, (uint32_t)material.Textures.size());
+			for (auto& texture : material.Textures)
+			{
+				Utils::Write(materialTable, (uint32_t)texture.TextureType);
+				Utils::Write(materialTable, (uint32_t)texture.IsNormalMap);
+				Utils::WriteString(materialTable, texture.Path);
+			}
+			Utils::Write(materialTable, material.AlbedoFactor);
+			Utils::Write(materialTable, material.MetalnessFactor);
+			Utils::Write(materialTable, material.RoughnessFactor);
+		}
+		std::string materialData = materialTable.str();
+
+		// Every mesh is packed on its own job, same as the conversion on import
+		std::vector<std::vector<std::vector<uint8_t>>> streams(model.Meshes.size());
+		{
+			JobCounter counter;
+			for (uint32_t i = 0; i < model.Meshes.size(); i++)
+			{
+				JobSystem::Run([&, i]()
+				{
+					streams[i] = VertexPacker::Pack(model.Meshes[i], format);
+				}, &counter);
+			}
+			JobSystem::Wait(counter);
+		}
+
+		RMeshHeader header = {};
+		header.Magic = s_CookMagic;
+		header.Version = s_CookVersion;
+		header.VertexFormat = (uint32_t)format;
+		header.PositionStride = VertexPacker::GetStride(format, VertexStream_Position);
+		header.AttributeStride = VertexPacker::GetStride(format, VertexStream_Attributes);
+		header.IndexStride = sizeof(uint32_t);
+		header.MeshCount = (uint32_t)model.Meshes.size();
+		header.MaterialCount = (uint32_t)model.Materials.size();
+		header.Flags = Utils::GetCookFlags(model.StaticBatched);
+		header.MeshletStride = sizeof(Meshlet);
+		header.LODStride = sizeof(MeshLOD);
+		header.SubMeshStride = sizeof(SubMesh);
+		header.NodeCount = (uint32_t)model.Nodes.size();
+		header.NodeStride = sizeof(CookedNode);
+		header.NodeTableOffset = sizeof(RMeshHeader) + sizeof(RMeshEntry) * header.MeshCount;
+		header.MaterialTableOffset = header.NodeTableOffset + sizeof(CookedNode) * header.NodeCount;
+		header.DataOffset = Utils::Align(header.MaterialTableOffset + materialData.size(), s_BlobAlignment);
+
+		// Every blob starts aligned, the vertex streams first then indices, meshlets, LODs and sub meshes for each mesh
+		std::vector<RMeshEntry> entries(header.MeshCount);
+		uint64_t offset = header.DataOffset;
+		for (uint32_t i = 0; i < header.MeshCount; i++)
+		{
+			const Mesh& mesh = model.Meshes[i];
+			RMeshEntry& entry = entries[i];
+
+			entry.VertexCount = (uint32_t)mesh.Verticies.size();
+			entry.IndexCount = (uint32_t)mesh.Indicies.size();
+			entry.MeshletCount = (uint32_t)mesh.Meshlets.size();
+			entry.LODCount = (uint32_t)mesh.LODs.size();
+			entry.SubMeshCount = (uint32_t)mesh.SubMeshes.size();
+			entry.MaterialIndex = model.MeshMaterials[i];
+			entry.NodeIndex = model.MeshNodes[i];
+			entry.BoundsMin = mesh.BoundsMin;
+			entry.BoundsMax = mesh.BoundsMax;
+			entry.BoundingSphere = mesh.BoundingSphere;
+
+			for (uint32_t stream = 0; stream < VertexStream_Count; stream++)
+			{
+				entry.StreamOffsets[stream] = offset;
+				offset = Utils::Align(offset + streams[i][stream].size(), s_BlobAlignment);
+			}
+			entry.IndexOffset = offset;
+			offset = Utils::Align(offset + entry.IndexCount * sizeof(uint32_t), s_BlobAlignment);
+			entry.MeshletOffset = offset;
+			offset = Utils::Align(offset + entry.MeshletCount * sizeof(Meshlet), s_BlobAlignment);
+			entry.LODOffset = offset;
+			offset = Utils::Align(offset + entry.LODCount * sizeof(MeshLOD), s_BlobAlignment);
+			entry.SubMeshOffset = offset;
+			offset = Utils::Align(offset + entry.SubMeshCount * sizeof(SubMesh), s_BlobAlignment);
+		}
+
+		std::error_code error;
+		std::filesystem::create_directories(s_CookDirectory, error);
+
+		// Same as the shader cache, a crash mid write never leaves a half written file behind
+		std::string tempPath = cookedPath + ".tmp";
+		{
+			std::ofstream file(tempPath, std::ios::out | std::ios::binary | std::ios::trunc);
+			if (!file)
+			{
+				LOG("Could not write cooked mesh '%s'\n", cookedPath.c_str());
+				return false;
+			}
+
+			Utils::Write(file, header);
+			file.write((const char*)entries.data(), entries.size() * sizeof(RMeshEntry));
+			file.write((const char*)model.Nodes.data(), model.Nodes.size() * sizeof(CookedNode));
+			file.write(materialData.data(), materialData.size());
+
+			uint64_t written = header.MaterialTableOffset + materialData.size();
+			Utils::WritePadding(file, header.DataOffset - written);
+			written = header.DataOffset;
+
+			for (uint32_t i = 0; i < header.MeshCount; i++)
+			{
+				const Mesh& mesh = model.Meshes[i];
+				const RMeshEntry& entry = entries[i];
+
+				for (uint32_t stream = 0; stream < VertexStream_Count; stream++)
+				{
+					uint64_t streamSize = streams[i][stream].size();
+					uint64_t next = stream + 1 < VertexStream_Count ? entry.StreamOffsets[stream + 1] : entry.IndexOffset;
+					file.write((const char*)streams[i][stream].data(), streamSize);
+					Utils::WritePadding(file, next - (written + streamSize));
+					written = next;
+				}
+
+				uint64_t indexSize = entry.IndexCount * sizeof(uint32_t);
+				file.write((const char*)mesh.Indicies.data(), indexSize);
+				Utils::WritePadding(file, entry.MeshletOffset - (written + indexSize));
+				written = entry.MeshletOffset;
+
+				uint64_t meshletSize = entry.MeshletCount * sizeof(Meshlet);
+				file.write((const char*)mesh.Meshlets.data(), meshletSize);
+				Utils::WritePadding(file, entry.LODOffset - (written + meshletSize));
+				written = entry.LODOffset;
+
+				uint64_t lodSize = entry.LODCount * sizeof(MeshLOD);
+				file.write((const char*)mesh.LODs.data(), lodSize);
+				Utils::WritePadding(file, entry.SubMeshOffset - (written + lodSize));
+				written = entry.SubMeshOffset;
+
+				uint64_t subMeshSize = entry.SubMeshCount * sizeof(SubMesh);
+				uint64_t next = Utils::Align(written + subMeshSize, s_BlobAlignment);
+				file.write((const char*)mesh.SubMeshes.data(), subMeshSize);
+				Utils::WritePadding(file, next - (written + subMeshSize));
+				written = next;
+			}
+
+			if (!file)
+			{
+				LOG("Could not write cooked mesh '%s'\n", cookedPath.c_str());
+				return false;
+			}
+		}
+
+		std::filesystem::rename(tempPath, cookedPath, error);
+		if (error)
+		{
+			LOG("Could not write cooked mesh '%s'\n", cookedPath.c_str());
+			return false;
+		}
+
+		return true;
+	}
+
+	bool MeshCooker::Load(const std::string& cookedPath, CookedModel& outModel, bool staticBatched, VertexFormat format)
+	{
+		auto file = std::make_shared<MappedFile>(cookedPath);
+		if (!file->IsValid())
+			return false;
+
+		const uint8_t* data = file->GetData();
+		size_t size = file->GetSize();
+
+		RMeshHeader header;
+		if (size < sizeof(RMeshHeader))
+		{
+			LOG("Cooked mesh '%s' is corrupt, recooking\n", cookedPath.c_str());
+			return false;
+		}
+		memcpy(&header, data, sizeof(RMeshHeader));
+
+		uint32_t positionStride = VertexPacker::GetStride(format, VertexStream_Position);
+		uint32_t attributeStride = VertexPacker::GetStride(format, VertexStream_Attributes);
+		if (header.Magic != s_CookMagic || header.Version != s_CookVersion || header.VertexFormat != (uint32_t)format
+			|| header.PositionStride != positionStride || header.AttributeStride != attributeStride || header.IndexStride != sizeof(uint32_t) || header.MeshletStride != sizeof(Meshlet) || header.LODStride != sizeof(MeshLOD) || header.SubMeshStride != sizeof(SubMesh)
+			|| header.NodeStride != sizeof(CookedNode) || header.Flags != Utils::GetCookFlags(staticBatched))
+		{
+			LOG("Cooked mesh '%s' is out of date, recooking\n", cookedPath.c_str());
+			return false;
+		}
+
+		if (header.NodeTableOffset != sizeof(RMeshHeader) + sizeof(RMeshEntry) * (uint64_t)header.MeshCount
+			|| header.MaterialTableOffset != header.NodeTableOffset + sizeof(CookedNode) * (uint64_t)header.NodeCount
+			|| header.MaterialTableOffset > header.DataOffset || header.DataOffset > size)
+		{
+			LOG("Cooked mesh '%s' is corrupt, recooking\n", cookedPath.c_str());
+			return false;
+		}
+
+		std::vector<RMeshEntry> entries(header.MeshCount);
+		memcpy(entries.data(), data + sizeof(RMeshHeader), entries.size() * sizeof(RMeshEntry));
+
+		CookedModel model;
+		model.StaticBatched = staticBatched;
+
+		// Parents have to come first, the scene graph builds its depth order from that
+		model.Nodes.resize(header.NodeCount);
+		memcpy(model.Nodes.data(), data + header.NodeTableOffset, model.Nodes.size() * sizeof(CookedNode));
+		for (uint32_t i = 0; i < header.NodeCount; i++)
+		{
+			if (model.Nodes[i].Parent != UINT32_MAX && model.Nodes[i].Parent >= i)
+			{
+				LOG("Cooked mesh '%s' is corrupt, recooking\n", cookedPath.c_str());
+				return false;
+			}
+		}
+
+		Utils::BlobReader reader = { data, (size_t)header.DataOffset, (size_t)header.MaterialTableOffset };
+		model.Materials.resize(header.MaterialCount);
+		for (auto& material : model.Materials)
+		{
+			uint32_t textureCount;
+			if (!reader.ReadString(material.Name) || !reader.Read(textureCount))
+			{
+				LOG("Cooked mesh '%s' is corrupt, recooking\n", cookedPath.c_str());
+				return false;
+			}
+
+			material.Textures.resize(textureCount);
+			for (auto& texture : material.Textures)
+			{
+				uint32_t type, isNormalMap;
+				if (!reader.Read(type) || !reader.Read(isNormalMap) || !reader.ReadString(texture.Path))
+				{
+					LOG("Cooked mesh '%s' is corrupt, recooking\n", cookedPath.c_str());
+					return false;
+				}
+				texture.TextureType = (PBRTextureType)type;
+				texture.IsNormalMap = isNormalMap != 0;
+			}
+
+			if (!reader.Read(material.AlbedoFactor) || !reader.Read(material.MetalnessFactor) || !reader.Read(material.RoughnessFactor))
+			{
+				LOG("Cooked mesh '%s' is corrupt, recooking\n", cookedPath.c_str());
+				return false;
+			}
+		}
+
+		// The vertex and index blobs already have the layout of the pool's buffers, they stay in the mapping and are staged from there
+		model.PackedSource = file;
+
+		model.Meshes.resize(header.MeshCount);
+		model.PackedMeshes.resize(header.MeshCount);
+		model.MeshMaterials.resize(header.MeshCount);
+		model.MeshNodes.resize(header.MeshCount);
+		for (uint32_t i = 0; i < header.MeshCount; i++)
+		{
+			const RMeshEntry& entry = entries[i];
+			uint64_t positionSize = entry.VertexCount * (uint64_t)positionStride;
+			uint64_t attributeSize = entry.VertexCount * (uint64_t)attributeStride;
+			uint64_t indexSize = entry.IndexCount * (uint64_t)sizeof(uint32_t);
+			uint64_t meshletSize = entry.MeshletCount * (uint64_t)sizeof(Meshlet);
+			uint64_t lodSize = entry.LODCount * (uint64_t)sizeof(MeshLOD);
+			uint64_t subMeshSize = entry.SubMeshCount * (uint64_t)sizeof(SubMesh);
+
+			if (entry.StreamOffsets[VertexStream_Position] < header.DataOffset || entry.StreamOffsets[VertexStream_Position] + positionSize > size
+				|| entry.StreamOffsets[VertexStream_Attributes] < header.DataOffset || entry.StreamOffsets[VertexStream_Attributes] + attributeSize > size
+				|| entry.IndexOffset < header.DataOffset || entry.IndexOffset + indexSize > size || entry.MeshletOffset + meshletSize > size
+				|| entry.LODOffset + lodSize > size || entry.SubMeshOffset + subMeshSize > size || entry.MaterialIndex >= header.MaterialCount || entry.NodeIndex >= header.NodeCount)
+			{
+				LOG("Cooked mesh '%s' is corrupt, recooking\n", cookedPath.c_str());
+				return false;
+			}
+
+			Mesh& mesh = model.Meshes[i];
+			mesh.PackedVertexCount = entry.VertexCount;
+			mesh.PackedIndexCount = entry.IndexCount;
+			mesh.Meshlets.resize(entry.MeshletCount);
+			mesh.LODs.resize(entry.LODCount);
+			mesh.SubMeshes.resize(entry.SubMeshCount);
+			memcpy(mesh.Meshlets.data(), data + entry.MeshletOffset, meshletSize);
+			memcpy(mesh.LODs.data(), data + entry.LODOffset, lodSize);
+			memcpy(mesh.SubMeshes.data(), data + entry.SubMeshOffset, subMeshSize);
+
+			for (auto& lod : mesh.LODs)
+			{
+				if ((uint64_t)lod.FirstIndex + lod.IndexCount > entry.IndexCount)
+				{
+					LOG("Cooked mesh '%s' is corrupt, recooking\n", cookedPath.c_str());
+					return false;
+				}
+			}
+
+			for (auto& subMesh : mesh.SubMeshes)
+			{
+				if ((uint64_t)subMesh.FirstIndex + subMesh.IndexCount > mesh.GetLOD(0).IndexCount)
+				{
+					LOG("Cooked mesh '%s' is corrupt, recooking\n", cookedPath.c_str());
+					return false;
+				}
+			}
+
+			mesh.BoundsMin = entry.BoundsMin;
+			mesh.BoundsMax = entry.BoundsMax;
+			mesh.BoundingSphere = entry.BoundingSphere;
+
+			PackedGeometry& geometry = model.PackedMeshes[i];
+			geometry.Format = format;
+			geometry.VertexCount = entry.VertexCount;
+			geometry.IndexCount = entry.IndexCount;
+			for (uint32_t stream = 0; stream < VertexStream_Count; stream++)
+				geometry.Streams[stream] = data + entry.StreamOffsets[stream];
+			geometry.Indices = (const uint32_t*)(data + entry.IndexOffset);
+
+			model.MeshMaterials[i] = entry.MaterialIndex;
+			model.MeshNodes[i] = entry.NodeIndex;
+		}
+
+		outModel = std::move(model);
+		return true;
+	}
+
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "Mesh.h"
+#include "Material.h"
+#include "VertexFormat.h"
+#include "Rose/Core/MappedFile.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Rose
+{
+
+	struct CookedTexture
+	{
+		PBRTextureType TextureType;
+		std::string Path; // Relative to the working directory, empty uses the default white texture
+		bool IsNormalMap = false;
+	};
+
+	// Everything needed to build a Material without going back to the source file
+	struct CookedMaterial
+	{
+		std::string Name;
+		std::vector<CookedTexture> Textures;
+		glm::vec4 AlbedoFactor = glm::vec4(1.0f);
+		float MetalnessFactor = 1.0f;
+		float RoughnessFactor = 1.0f;
+	};
+
+	// A node of the source file's hierarchy, parents always come before their children
+	struct CookedNode
+	{
+		glm::mat4 LocalTransform = glm::mat4(1.0f);
+		uint32_t Parent = UINT32_MAX; // UINT32_MAX for roots
+		uint32_t Padding[3] = { 0, 0, 0 };
+	};
+
+	struct CookedModel
+	{
+		std::vector<Mesh> Meshes;
+		std::vector<uint32_t> MeshMaterials; // Index into Materials for every mesh
+		std::vector<uint32_t> MeshNodes; // Index into Nodes for every mesh
+		std::vector<CookedMaterial> Materials;
+		std::vector<CookedNode> Nodes;
+		bool StaticBatched = false; // Node transforms are baked into the meshes and Nodes is a single root
+
+		// Only set by MeshCooker::Load, the meshes then leave Verticies and Indicies empty. Points into PackedSource
+		std::vector<PackedGeometry> PackedMeshes;
+		std::shared_ptr<MappedFile> PackedSource;
+	};
+
+	// Versioned binary container (.rmesh) of an imported model, cooked for one vertex format.
+	// Vertices are stored as the packed streams and indices as the raw array that end up in the GPU buffers, so loading is a memory map.
+	// The geometry pool stages straight out of the mapping, only what culling and LOD selection read (bounds, meshlets, LODs, sub meshes) is copied out.
+	class MeshCooker
+	{
+		public :
+			// Every vertex format gets its own file, so models sharing a source don't keep recooking each other
+			static std::string GetCookedPath(const std::string& sourcePath, VertexFormat format);
+			// True if the cooked file exists and is at least as new as the source, a missing source counts as up to date
+			static bool IsUpToDate(const std::string& sourcePath, const std::string& cookedPath);
+
+			// The steps every loader runs on its converted meshes before cooking: optimize, static batch, then meshlets and LODs.
+			// Expects meshes, mesh materials, mesh nodes and nodes to be filled in, name is only for the log
+			static void Process(CookedModel& model, bool isStatic, const std::string& name);
+
+			// Packs every mesh into the format's streams
+			static bool Write(const std::string& cookedPath, const CookedModel& model, VertexFormat format);
+			// A file cooked with a different staticBatched setting or vertex format is out of date
+			static bool Load(const std::string& cookedPath, CookedModel& outModel, bool staticBatched, VertexFormat format);
+	};
+
+}
@@ -0,0 +1,365 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Rose
+{
+
+	bool MeshOptimizer::s_Enabled = true;
+
+	static const uint32_t s_ForsythCacheSize = 32;
+	static const uint32_t s_SimulatedCacheSize = 16;
+
+
+	namespace Utils {
+
+		static float ForsythVertexScore(int32_t cachePosition, uint32_t remainingTriangles)
+		{
+			if (!remainingTriangles)
+				return -1.0f;
+
+			float score = 0.0f;
+			if (cachePosition >= 0)
+			{
+				// The last triangle's vertices get a fixed score so the next triangle doesn't just reuse the same edge
+				if (cachePosition < 3)
+					score = 0.75f;
+				else
+					score = powf(1.0f - (float)(cachePosition - 3) / (s_ForsythCacheSize - 3), 1.5f);
+			}
+
+			// Vertices with few triangles left are finished first so they can leave the cache
+			score += 2.0f * powf((float)remainingTriangles, -0.5f);
+			return score;
+		}
+
+		// FIFO cache through timestamps, a vertex is cached if it was transformed less than cacheSize misses ago
+		struct FIFOCache
+		{
+			std::vector<uint32_t> Timestamps;
+			uint32_t Time;
+			uint32_t Size;
+
+			FIFOCache(uint32_t vertexCount, uint32_t size)
+				: Timestamps(vertexCount, 0), Time(size + 1), Size(size) {}
+
+			uint32_t Access(uint32_t vertex)
+			{
+				if (Time - Timestamps[vertex] > Size)
+				{
+					Timestamps[vertex] = Time++;
+					return 1;
+				}
+				return 0;
+			}
+
+			void Flush() { Time += Size + 1; }
+		};
+
+		struct Cluster
+		{
+			uint32_t Start;
+			uint32_t End;
+			float SortKey;
+		};
+
+	}
+
+
+	void MeshOptimizer::Optimize(Mesh& mesh, VertexCacheStats& outBefore, VertexCacheStats& outAfter)
+	{
+		uint32_t vertexCount = (uint32_t)mesh.Verticies.size();
+		outBefore = AnalyzeVertexCache(mesh.Indicies, vertexCount);
+
+		if (mesh.Indicies.empty() || mesh.Indicies.size() % 3)
+		{
+			outAfter = outBefore;
+			return;
+		}
+
+		OptimizeVertexCache(mesh.Indicies, vertexCount);
+		OptimizeOverdraw(mesh.Indicies, mesh.Verticies);
+		OptimizeVertexFetch(mesh);
+		mesh.CalculateBounds();
+
+		outAfter = AnalyzeVertexCache(mesh.Indicies, (uint32_t)mesh.Verticies.size());
+	}
+
+	void MeshOptimizer::OptimizeVertexCache(std::vector<uint32_t>& indices, uint32_t vertexCount)
+	{
+		uint32_t triangleCount = (uint32_t)(indices.size() / 3);
+		if (!triangleCount)
+			return;
+
+		// Triangles of every vertex, the first RemainingTriangles[v] entries of its range are the ones not emitted yet
+		std::vector<uint32_t> remainingTriangles(vertexCount, 0);
+		for (uint32_t index : indices)
+			remainingTriangles[index]++;
+
+		std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+		for (uint32_t i = 0; i < vertexCount; i++)
+			adjacencyOffsets[i + 1] = adjacencyOffsets[i] + remainingTriangles[i];
+
+		std::vector<uint32_t> adjacency(indices.size());
+		{
+			std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+			for (uint32_t i = 0; i < indices.size(); i++)
+				adjacency[fill[indices[i]]++] = i / 3;
+		}
+
+		std::vector<int32_t> cachePositions(vertexCount, -1);
+		std::vector<float> vertexScores(vertexCount);
+		for (uint32_t i = 0; i < vertexCount; i++)
+			vertexScores[i] = Utils::ForsythVertexScore(-1, remainingTriangles[i]);
+
+		std::vector<float> triangleScores(triangleCount);
+		std::vector<uint8_t> emitted(triangleCount, 0);
+
+		int32_t bestTriangle = -1;
+		float bestScore = -1.0f;
+		for (uint32_t i = 0; i < triangleCount; i++)
+		{
+			triangleScores[i] = vertexScores[indices[i * 3 + 0]] + vertexScores[indices[i * 3 + 1]] + vertexScores[indices[i * 3 + 2]];
+			if (triangleScores[i] > bestScore)
+			{
+				bestScore = triangleScores[i];
+				bestTriangle = (int32_t)i;
+			}
+		}
+
+		std::vector<uint32_t> result;
+		result.reserve(indices.size());
+
+		uint32_t cache[s_ForsythCacheSize + 3];
+		uint32_t cacheCount = 0;
+		uint32_t scanCursor = 0;
+
+		while (result.size() < indices.size())
+		{
+			// Nothing in the cache has triangles left, carry on with the next triangle in input order
+			if (bestTriangle < 0)
+			{
+				while (emitted[scanCursor])
+					scanCursor++;
+				bestTriangle = (int32_t)scanCursor;
+			}
+
+			const uint32_t* triangle = &indices[bestTriangle * 3];
+			emitted[bestTriangle] = 1;
+			result.insert(result.end(), triangle, triangle + 3);
+
+			for (uint32_t i = 0; i < 3; i++)
+			{
+				uint32_t vertex = triangle[i];
+				uint32_t* list = &adjacency[adjacencyOffsets[vertex]];
+				uint32_t& count = remainingTriangles[vertex];
+				for (uint32_t j = 0; j < count; j++)
+				{
+					if (list[j] == (uint32_t)bestTriangle)
+					{
+						std::swap(list[j], list[count - 1]);
+						count--;
+						break;
+					}
+				}
+			}
+
+			// The triangle's vertices move to the front, everything else shifts back and may fall out
+			uint32_t newCache[s_ForsythCacheSize + 3];
+			uint32_t newCount = 0;
+			for (uint32_t i = 0; i < 3; i++)
+			{
+				if (std::find(newCache, newCache + newCount, triangle[i]) == newCache + newCount)
+					newCache[newCount++] = triangle[i];
+			}
+			for (uint32_t i = 0; i < cacheCount; i++)
+			{
+				if (cache[i] != triangle[0] && cache[i] != triangle[1] && cache[i] != triangle[2])
+					newCache[newCount++] = cache[i];
+			}
+
+			for (uint32_t i = 0; i < newCount; i++)
+			{
+				uint32_t vertex = newCache[i];
+				cachePositions[vertex] = i < s_ForsythCacheSize ? (int32_t)i : -1;
+
+				float score = Utils::ForsythVertexScore(cachePositions[vertex], remainingTriangles[vertex]);
+				float delta = score - vertexScores[vertex];
+				vertexScores[vertex] = score;
+
+				const uint32_t* list = &adjacency[adjacencyOffsets[vertex]];
+				for (uint32_t j = 0; j < remainingTriangles[vertex]; j++)
+					triangleScores[list[j]] += delta;
+			}
+
+			cacheCount = std::min(newCount, s_ForsythCacheSize);
+			std::copy(newCache, newCache + cacheCount, cache);
+
+			// Only triangles touching the cache are candidates, that keeps the whole pass linear
+			bestTriangle = -1;
+			bestScore = -1.0f;
+			for (uint32_t i = 0; i < cacheCount; i++)
+			{
+				uint32_t vertex = cache[i];
+				const uint32_t* list = &adjacency[adjacencyOffsets[vertex]];
+				for (uint32_t j = 0; j < remainingTriangles[vertex]; j++)
+				{
+					if (triangleScores[list[j]] > bestScore)
+					{
+						bestScore = triangleScores[list[j]];
+						bestTriangle = (int32_t)list[j];
+					}
+				}
+			}
+		}
+
+		indices.swap(result);
+	}
+
+	void MeshOptimizer::OptimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<Vertex>& vertices, float threshold)
+	{
+		uint32_t triangleCount = (uint32_t)(indices.size() / 3);
+		if (!triangleCount)
+			return;
+
+		Utils::FIFOCache cache((uint32_t)vertices.size(), s_SimulatedCacheSize);
+		auto accessTriangle = [&](uint32_t triangle)
+		{
+			return cache.Access(indices[triangle * 3 + 0]) + cache.Access(indices[triangle * 3 + 1]) + cache.Access(indices[triangle * 3 + 2]);
+		};
+
+		// Hard boundaries are where the cache optimized order misses on every vertex, the cache is cold there anyway
+		std::vector<uint32_t> hardBoundaries;
+		for (uint32_t i = 0; i < triangleCount; i++)
+		{
+			if (accessTriangle(i) == 3 || i == 0)
+				hardBoundaries.push_back(i);
+		}
+		hardBoundaries.push_back(triangleCount);
+
+		// Soft boundaries split a cluster further wherever starting over doesn't cost more than threshold
+		std::vector<Utils::Cluster> clusters;
+		for (uint32_t c = 0; c + 1 < hardBoundaries.size(); c++)
+		{
+			uint32_t start = hardBoundaries[c];
+			uint32_t end = hardBoundaries[c + 1];
+
+			cache.Flush();
+			uint32_t clusterMisses = 0;
+			for (uint32_t i = start; i < end; i++)
+				clusterMisses += accessTriangle(i);
+			float clusterACMR = (float)clusterMisses / (end - start);
+
+			cache.Flush();
+			uint32_t clusterStart = start;
+			uint32_t misses = 0;
+			for (uint32_t i = start; i < end; i++)
+			{
+				misses += accessTriangle(i);
+
+				float acmr = (float)misses / (i + 1 - clusterStart);
+				if (i + 1 < end && acmr <= clusterACMR * threshold)
+				{
+					clusters.push_back({ clusterStart, i + 1, 0.0f });
+					clusterStart = i + 1;
+					misses = 0;
+					cache.Flush();
+				}
+			}
+			clusters.push_back({ clusterStart, end, 0.0f });
+		}
+
+		// Clusters facing away from the mesh center are more likely to occlude the rest, they go first
+		glm::vec3 meshCenter = glm::vec3(0.0f);
+		float meshArea = 0.0f;
+		std::vector<glm::vec3> clusterCenters(clusters.size());
+		std::vector<glm::vec3> clusterNormals(clusters.size());
+
+		for (uint32_t c = 0; c < clusters.size(); c++)
+		{
+			glm::vec3 center = glm::vec3(0.0f);
+			glm::vec3 normal = glm::vec3(0.0f);
+			float area = 0.0f;
+
+			for (uint32_t i = clusters[c].Start; i < clusters[c].End; i++)
+			{
+				const glm::vec3& p0 = vertices[indices[i * 3 + 0]].Position;
+				const glm::vec3& p1 = vertices[indices[i * 3 + 1]].Position;
+				const glm::vec3& p2 = vertices[indices[i * 3 + 2]].Position;
+
+				glm::vec3 faceNormal = glm::cross(p1 - p0, p2 - p0);
+				float faceArea = glm::length(faceNormal);
+
+				center += (p0 + p1 + p2) * (faceArea / 3.0f);
+				normal += faceNormal;
+				area += faceArea;
+			}
+
+			meshCenter += center;
+			meshArea += area;
+
+			clusterCenters[c] = area > 0.0f ? center / area : center;
+			float normalLength = glm::length(normal);
+			clusterNormals[c] = normalLength > 0.0f ? normal / normalLength : normal;
+		}
+
+		if (meshArea > 0.0f)
+			meshCenter /= meshArea;
+
+		for (uint32_t c = 0; c < clusters.size(); c++)
+			clusters[c].SortKey = glm::dot(clusterCenters[c] - meshCenter, clusterNormals[c]);
+
+		std::stable_sort(clusters.begin(), clusters.end(), [](const Utils::Cluster& a, const Utils::Cluster& b) { return a.SortKey > b.SortKey; });
+
+		std::vector<uint32_t> result;
+		result.reserve(indices.size());
+		for (auto& cluster : clusters)
+			result.insert(result.end(), indices.begin() + cluster.Start * 3, indices.begin() + cluster.End * 3);
+
+		indices.swap(result);
+	}
+
+	void MeshOptimizer::OptimizeVertexFetch(Mesh& mesh)
+	{
+		std::vector<uint32_t> remap(mesh.Verticies.size(), UINT32_MAX);
+		uint32_t vertexCount = 0;
+
+		for (auto& index : mesh.Indicies)
+		{
+			if (remap[index] == UINT32_MAX)
+				remap[index] = vertexCount++;
+			index = remap[index];
+		}
+
+		std::vector<Vertex> vertices(vertexCount);
+		for (uint32_t i = 0; i < mesh.Verticies.size(); i++)
+		{
+			if (remap[i] != UINT32_MAX)
+				vertices[remap[i]] = mesh.Verticies[i];
+		}
+
+		mesh.Verticies.swap(vertices);
+	}
+
+	VertexCacheStats MeshOptimizer::AnalyzeVertexCache(const std::vector<uint32_t>& indices, uint32_t vertexCount, uint32_t cacheSize)
+	{
+		VertexCacheStats stats;
+		stats.Triangles = (uint32_t)(indices.size() / 3);
+
+		Utils::FIFOCache cache(vertexCount, cacheSize);
+		std::vector<uint8_t> referenced(vertexCount, 0);
+		for (uint32_t index : indices)
+		{
+			stats.Transforms += cache.Access(index);
+			if (!referenced[index])
+			{
+				referenced[index] = 1;
+				stats.Vertices++;
+			}
+		}
+
+		return stats;
+	}
+
+}
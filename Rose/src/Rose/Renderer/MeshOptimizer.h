@@ -0,0 +1,46 @@
+#pragma once
+
+#include "Mesh.h"
+
+#include <vector>
+
+namespace Rose
+{
+
+	// Result of running an index buffer through a simulated FIFO post transform cache
+	struct VertexCacheStats
+	{
+		uint32_t Triangles = 0;
+		uint32_t Vertices = 0; // Unique vertices referenced
+		uint32_t Transforms = 0; // Cache misses, every one is a vertex shader invocation
+
+		float GetACMR() const { return Triangles ? (float)Transforms / Triangles : 0.0f; } // Average cache miss ratio, 0.5 is the best a triangle list can do
+		float GetATVR() const { return Vertices ? (float)Transforms / Vertices : 0.0f; } // Average transformed vertex ratio, 1.0 is optimal
+	};
+
+	// Import time reordering of triangle lists, nothing here runs at runtime since the result is cooked.
+	class MeshOptimizer
+	{
+		public :
+			// Vertex cache, then overdraw, then vertex fetch. Skips meshes that aren't triangle lists
+			static void Optimize(Mesh& mesh, VertexCacheStats& outBefore, VertexCacheStats& outAfter);
+
+			// Forsyth's linear speed vertex cache optimization
+			static void OptimizeVertexCache(std::vector<uint32_t>& indices, uint32_t vertexCount);
+			// Splits the cache optimized order into clusters where the cache is cold anyway (Tipsify style) and draws
+			// outward facing clusters first. Threshold is how much worse than the cluster's ACMR a split may make it
+			static void OptimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<Vertex>& vertices, float threshold = 1.05f);
+			// Reorders vertices into first use order and drops unreferenced ones
+			static void OptimizeVertexFetch(Mesh& mesh);
+
+			static VertexCacheStats AnalyzeVertexCache(const std::vector<uint32_t>& indices, uint32_t vertexCount, uint32_t cacheSize = 16);
+
+			// Changing this recooks every model on the next load
+			static void SetEnabled(bool enabled) { s_Enabled = enabled; }
+			static bool IsEnabled() { return s_Enabled; }
+
+		private :
+			static bool s_Enabled;
+	};
+
+}
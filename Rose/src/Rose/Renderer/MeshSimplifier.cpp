@@ -0,0 +1,330 @@
+#include "MeshSimplifier.h"
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <unordered_map>
+#include <cmath>
+
+namespace Rose
+{
+
+	namespace Utils {
+
+		// Normal and texture coordinate changes count as this fraction of the bounding radius per unit of change
+		static const float s_NormalWeight = 0.05f;
+		static const float s_TexCoordWeight = 0.05f;
+
+		// Symmetric 4x4 matrix of the squared distance to a set of planes, doubles since big meshes sum a lot of tiny planes.
+		// Planes are weighted, Evaluate() returns the weighted mean so the result stays a squared distance
+		struct Quadric
+		{
+			double A2 = 0.0, AB = 0.0, AC = 0.0, AD = 0.0;
+			double B2 = 0.0, BC = 0.0, BD = 0.0;
+			double C2 = 0.0, CD = 0.0;
+			double D2 = 0.0;
+			double Weight = 0.0;
+
+			void AddPlane(const glm::dvec3& normal, double d, double weight)
+			{
+				A2 += weight * normal.x * normal.x; AB += weight * normal.x * normal.y; AC += weight * normal.x * normal.z; AD += weight * normal.x * d;
+				B2 += weight * normal.y * normal.y; BC += weight * normal.y * normal.z; BD += weight * normal.y * d;
+				C2 += weight * normal.z * normal.z; CD += weight * normal.z * d;
+				D2 += weight * d * d;
+				Weight += weight;
+			}
+
+			void Add(const Quadric& other)
+			{
+				A2 += other.A2; AB += other.AB; AC += other.AC; AD += other.AD;
+				B2 += other.B2; BC += other.BC; BD += other.BD;
+				C2 += other.C2; CD += other.CD;
+				D2 += other.D2;
+				Weight += other.Weight;
+			}
+
+			double Evaluate(const glm::vec3& point) const
+			{
+				double x = point.x, y = point.y, z = point.z;
+				double result = A2 * x * x + B2 * y * y + C2 * z * z + D2
+					+ 2.0 * (AB * x * y + AC * x * z + BC * y * z + AD * x + BD * y + CD * z);
+				return Weight > 0.0 ? std::max(result / Weight, 0.0) : 0.0;
+			}
+		};
+
+		struct Collapse
+		{
+			uint32_t From;
+			uint32_t To;
+			float Cost; // Squared
+		};
+
+		static bool LessPosition(const glm::vec3& a, const glm::vec3& b)
+		{
+			if (a.x != b.x) return a.x < b.x;
+			if (a.y != b.y) return a.y < b.y;
+			return a.z < b.z;
+		}
+	}
+
+
+	void MeshSimplifier::GenerateLODs(Mesh& mesh)
+	{
+		mesh.LODs.clear();
+
+		uint32_t baseIndexCount = (uint32_t)mesh.Indicies.size();
+		if (!baseIndexCount || baseIndexCount % 3)
+			return;
+
+		mesh.LODs.push_back({ 0, baseIndexCount, 0.0f, 0 });
+
+		// Every LOD simplifies the previous one, so the errors add up
+		std::vector<uint32_t> previous = mesh.Indicies;
+		std::vector<uint32_t> simplified;
+		float error = 0.0f;
+		for (uint32_t lod = 1; lod < MaxLODs; lod++)
+		{
+			uint32_t target = (uint32_t)previous.size() / 6 * 3;
+			if (target < MinTriangles * 3)
+				break;
+
+			float lodError = Simplify(mesh, previous, target, simplified);
+
+			// Locked borders and seams can stop it early, a LOD that barely removed anything isn't worth its memory
+			if (simplified.size() * 5 > previous.size() * 4)
+				break;
+
+			if (MeshOptimizer::IsEnabled())
+				MeshOptimizer::OptimizeVertexCache(simplified, (uint32_t)mesh.Verticies.size());
+
+			error += lodError;
+			mesh.LODs.push_back({ (uint32_t)mesh.Indicies.size(), (uint32_t)simplified.size(), error, 0 });
+			mesh.Indicies.insert(mesh.Indicies.end(), simplified.begin(), simplified.end());
+
+			previous.swap(simplified);
+		}
+	}
+
+	float MeshSimplifier::Simplify(const Mesh& mesh, const std::vector<uint32_t>& indices, uint32_t targetIndexCount, std::vector<uint32_t>& outIndices)
+	{
+		const auto& vertices = mesh.Verticies;
+		uint32_t vertexCount = (uint32_t)vertices.size();
+
+		outIndices = indices;
+		if (indices.size() <= targetIndexCount || indices.size() % 3)
+			return 0.0f;
+
+		// Vertices sharing a position are one point of the surface, seams between them can't move
+		std::vector<uint32_t> sorted(vertexCount);
+		for (uint32_t i = 0; i < vertexCount; i++)
+			sorted[i] = i;
+		std::sort(sorted.begin(), sorted.end(), [&](uint32_t a, uint32_t b) { return Utils::LessPosition(vertices[a].Position, vertices[b].Position); });
+
+		std::vector<uint32_t> positionId(vertexCount);
+		std::vector<uint32_t> positionUses;
+		for (uint32_t i = 0; i < vertexCount; i++)
+		{
+			if (i == 0 || Utils::LessPosition(vertices[sorted[i - 1]].Position, vertices[sorted[i]].Position))
+				positionUses.push_back(0);
+			positionId[sorted[i]] = (uint32_t)positionUses.size() - 1;
+		}
+
+		std::vector<uint8_t> referenced(vertexCount, 0);
+		for (uint32_t index : indices)
+		{
+			if (!referenced[index])
+				positionUses[positionId[index]]++;
+			referenced[index] = 1;
+		}
+
+		std::vector<uint8_t> locked(vertexCount, 0);
+		for (uint32_t i = 0; i < vertexCount; i++)
+			locked[i] = positionUses[positionId[i]] > 1;
+
+		// An edge only one triangle uses is an open border
+		std::unordered_map<uint64_t, uint32_t> edgeUses;
+		edgeUses.reserve(indices.size());
+		for (size_t i = 0; i < indices.size(); i += 3)
+		{
+			for (uint32_t corner = 0; corner < 3; corner++)
+			{
+				uint64_t a = positionId[indices[i + corner]], b = positionId[indices[i + (corner + 1) % 3]];
+				edgeUses[a < b ? (a << 32) | b : (b << 32) | a]++;
+			}
+		}
+		for (size_t i = 0; i < indices.size(); i += 3)
+		{
+			for (uint32_t corner = 0; corner < 3; corner++)
+			{
+				uint32_t a = indices[i + corner], b = indices[i + (corner + 1) % 3];
+				uint64_t pa = positionId[a], pb = positionId[b];
+				if (edgeUses[pa < pb ? (pa << 32) | pb : (pb << 32) | pa] == 1)
+					locked[a] = locked[b] = 1;
+			}
+		}
+
+		std::vector<Utils::Quadric> quadrics(vertexCount);
+		for (size_t i = 0; i < indices.size(); i += 3)
+		{
+			glm::dvec3 a = vertices[indices[i + 0]].Position;
+			glm::dvec3 b = vertices[indices[i + 1]].Position;
+			glm::dvec3 c = vertices[indices[i + 2]].Position;
+
+			glm::dvec3 normal = glm::cross(b - a, c - a);
+			double length = glm::length(normal);
+			if (length <= 0.0)
+				continue;
+
+			// Weighted by area, so big flat triangles hold their shape better than slivers
+			normal /= length;
+			Utils::Quadric plane;
+			plane.AddPlane(normal, -glm::dot(normal, a), length * 0.5);
+			for (uint32_t corner = 0; corner < 3; corner++)
+				quadrics[indices[i + corner]].Add(plane);
+		}
+
+		float radius = mesh.BoundingSphere.w > 0.0f ? mesh.BoundingSphere.w : 1.0f;
+		float normalScale = Utils::s_NormalWeight * radius;
+		float texCoordScale = Utils::s_TexCoordWeight * radius;
+
+		auto collapseCost = [&](uint32_t from, uint32_t to)
+		{
+			Utils::Quadric quadric = quadrics[from];
+			quadric.Add(quadrics[to]);
+
+			float normalError = glm::length(vertices[from].Normal - vertices[to].Normal) * normalScale;
+			float texCoordError = glm::length(vertices[from].TexCoord - vertices[to].TexCoord) * texCoordScale;
+			return (float)quadric.Evaluate(vertices[to].Position) + normalError * normalError + texCoordError * texCoordError;
+		};
+
+		std::vector<uint32_t>& triangles = outIndices;
+		uint32_t triangleCount = (uint32_t)triangles.size() / 3;
+		uint32_t targetTriangles = targetIndexCount / 3;
+
+		std::vector<uint32_t> remap(vertexCount);
+		std::vector<uint8_t> touched(vertexCount);
+		std::vector<uint32_t> adjacencyOffsets(vertexCount + 1);
+		std::vector<uint32_t> adjacency;
+		std::vector<Utils::Collapse> collapses;
+
+		float maxCost = 0.0f;
+
+		// Passes of independent collapses, cheapest first. A collapse locks the neighbourhood it changes until the next pass
+		while (triangleCount > targetTriangles)
+		{
+			std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0);
+			for (uint32_t index : triangles)
+				adjacencyOffsets[index + 1]++;
+			for (uint32_t i = 0; i < vertexCount; i++)
+				adjacencyOffsets[i + 1] += adjacencyOffsets[i];
+
+			adjacency.resize(triangles.size());
+			std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+			for (uint32_t i = 0; i < triangles.size(); i++)
+				adjacency[fill[triangles[i]]++] = i / 3;
+
+			collapses.clear();
+			for (size_t i = 0; i < triangles.size(); i += 3)
+			{
+				for (uint32_t corner = 0; corner < 3; corner++)
+				{
+					uint32_t a = triangles[i + corner], b = triangles[i + (corner + 1) % 3];
+					// The neighbouring triangle has the same edge the other way around
+					if (a > b)
+						continue;
+
+					bool canA = !locked[a], canB = !locked[b];
+					if (!canA && !canB)
+						continue;
+
+					float costA = canA ? collapseCost(a, b) : 0.0f;
+					float costB = canB ? collapseCost(b, a) : 0.0f;
+					if (canA && (!canB || costA <= costB))
+						collapses.push_back({ a, b, costA });
+					else
+						collapses.push_back({ b, a, costB });
+				}
+			}
+
+			if (collapses.empty())
+				break;
+
+			std::sort(collapses.begin(), collapses.end(), [](const Utils::Collapse& a, const Utils::Collapse& b) { return a.Cost < b.Cost; });
+
+			for (uint32_t i = 0; i < vertexCount; i++)
+				remap[i] = i;
+			std::fill(touched.begin(), touched.end(), 0);
+
+			uint32_t remaining = triangleCount;
+			uint32_t collapsed = 0;
+			for (auto& collapse : collapses)
+			{
+				if (remaining <= targetTriangles)
+					break;
+				if (touched[collapse.From] || touched[collapse.To])
+					continue;
+
+				// Moving the vertex must not flip any triangle that survives the collapse
+				const glm::vec3& target = vertices[collapse.To].Position;
+				bool flips = false;
+				uint32_t removed = 0;
+				for (uint32_t j = adjacencyOffsets[collapse.From]; j < adjacencyOffsets[collapse.From + 1] && !flips; j++)
+				{
+					const uint32_t* triangle = &triangles[adjacency[j] * 3];
+					if (triangle[0] == collapse.To || triangle[1] == collapse.To || triangle[2] == collapse.To)
+					{
+						removed++;
+						continue;
+					}
+
+					glm::vec3 before[3], after[3];
+					for (uint32_t corner = 0; corner < 3; corner++)
+					{
+						before[corner] = vertices[triangle[corner]].Position;
+						after[corner] = triangle[corner] == collapse.From ? target : before[corner];
+					}
+
+					glm::vec3 normalBefore = glm::cross(before[1] - before[0], before[2] - before[0]);
+					glm::vec3 normalAfter = glm::cross(after[1] - after[0], after[2] - after[0]);
+					// Turning by more than ~75 degrees counts as well, smaller turns can still add up to a fold over a few passes
+					flips = glm::dot(normalBefore, normalAfter) <= 0.25f * glm::length(normalBefore) * glm::length(normalAfter);
+				}
+				if (flips)
+					continue;
+
+				remap[collapse.From] = collapse.To;
+				quadrics[collapse.To].Add(quadrics[collapse.From]);
+				maxCost = std::max(maxCost, collapse.Cost);
+
+				for (uint32_t j = adjacencyOffsets[collapse.From]; j < adjacencyOffsets[collapse.From + 1]; j++)
+				{
+					const uint32_t* triangle = &triangles[adjacency[j] * 3];
+					touched[triangle[0]] = touched[triangle[1]] = touched[triangle[2]] = 1;
+				}
+
+				remaining -= std::min(removed, remaining);
+				collapsed++;
+			}
+
+			if (!collapsed)
+				break;
+
+			// Drops the triangles that collapsed into lines
+			uint32_t write = 0;
+			for (size_t i = 0; i < triangles.size(); i += 3)
+			{
+				uint32_t a = remap[triangles[i + 0]], b = remap[triangles[i + 1]], c = remap[triangles[i + 2]];
+				if (a == b || b == c || a == c)
+					continue;
+
+				triangles[write++] = a;
+				triangles[write++] = b;
+				triangles[write++] = c;
+			}
+			triangles.resize(write);
+			triangleCount = write / 3;
+		}
+
+		return std::sqrt(maxCost);
+	}
+
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "Mesh.h"
+
+#include <vector>
+
+namespace Rose
+{
+
+	// Quadric error edge collapse simplification, import time only, the LOD chain is cooked with the mesh.
+	// Vertices are only ever collapsed onto other vertices, so every LOD shares the mesh's vertex buffer and is just another index range.
+	// Vertices on open borders and attribute seams (several vertices at one position) stay where they are, so LODs don't tear apart.
+	class MeshSimplifier
+	{
+		public :
+			static const uint32_t MaxLODs = 5; // LOD 0 included
+			static const uint32_t MinTriangles = 64; // Meshes smaller than this aren't worth another LOD
+
+			// Appends every LOD after LOD 0's indices, each one aims for half the triangles of the previous one.
+			// Run it after MeshletBuilder, meshlets only cover LOD 0.
+			static void GenerateLODs(Mesh& mesh);
+
+			// Collapses edges of the triangle list until it has at most targetIndexCount indices or nothing can be collapsed anymore.
+			// Returns the error the result may be off by, in object space units
+			static float Simplify(const Mesh& mesh, const std::vector<uint32_t>& indices, uint32_t targetIndexCount, std::vector<uint32_t>& outIndices);
+	};
+
+}
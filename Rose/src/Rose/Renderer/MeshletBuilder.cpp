@@ -0,0 +1,131 @@
+#include "MeshletBuilder.h"
+
+#include <limits>
+
+namespace Rose
+{
+
+	void MeshletBuilder::Build(Mesh& mesh)
+	{
+		mesh.Meshlets.clear();
+
+		const auto& indices = mesh.Indicies;
+		// Only LOD 0, coarser LODs are drawn whole
+		uint32_t triangleCount = mesh.GetLOD(0).IndexCount / 3;
+		if (!triangleCount)
+			return;
+
+		// Which meshlet last referenced a vertex, counts unique vertices without clearing anything between meshlets
+		std::vector<uint32_t> lastMeshlet(mesh.Verticies.size(), std::numeric_limits<uint32_t>::max());
+
+		Meshlet current;
+		uint32_t meshletIndex = 0;
+		uint32_t nextSubMesh = 1;
+
+		auto countNewVertices = [&](uint32_t triangle)
+		{
+			uint32_t count = 0;
+			for (uint32_t corner = 0; corner < 3; corner++)
+			{
+				uint32_t index = indices[triangle * 3 + corner];
+				// A triangle can reference the same vertex twice, only count it once
+				bool seen = lastMeshlet[index] == meshletIndex;
+				for (uint32_t previous = 0; previous < corner && !seen; previous++)
+					seen = indices[triangle * 3 + previous] == index;
+
+				if (!seen)
+					count++;
+			}
+			return count;
+		};
+
+		for (uint32_t triangle = 0; triangle < triangleCount; triangle++)
+		{
+			uint32_t newVertices = countNewVertices(triangle);
+			bool subMeshStart = false;
+			while (nextSubMesh < mesh.SubMeshes.size() && mesh.SubMeshes[nextSubMesh].FirstIndex == triangle * 3)
+			{
+				subMeshStart = true;
+				nextSubMesh++;
+			}
+
+			if (current.TriangleCount && (subMeshStart || current.TriangleCount == MaxTriangles || current.VertexCount + newVertices > MaxVertices))
+			{
+				ComputeBounds(mesh, current);
+				mesh.Meshlets.push_back(current);
+
+				current = Meshlet();
+				current.FirstIndex = triangle * 3;
+				meshletIndex++;
+				newVertices = countNewVertices(triangle);
+			}
+
+			for (uint32_t corner = 0; corner < 3; corner++)
+				lastMeshlet[indices[triangle * 3 + corner]] = meshletIndex;
+
+			current.VertexCount += newVertices;
+			current.TriangleCount++;
+		}
+
+		ComputeBounds(mesh, current);
+		mesh.Meshlets.push_back(current);
+	}
+
+	void MeshletBuilder::ComputeBounds(const Mesh& mesh, Meshlet& meshlet)
+	{
+		const auto& vertices = mesh.Verticies;
+		const uint32_t* indices = mesh.Indicies.data() + meshlet.FirstIndex;
+		uint32_t indexCount = meshlet.TriangleCount * 3;
+
+		glm::vec3 min = glm::vec3(std::numeric_limits<float>::max());
+		glm::vec3 max = glm::vec3(std::numeric_limits<float>::lowest());
+		for (uint32_t i = 0; i < indexCount; i++)
+		{
+			min = glm::min(min, vertices[indices[i]].Position);
+			max = glm::max(max, vertices[indices[i]].Position);
+		}
+
+		glm::vec3 center = (min + max) * 0.5f;
+		float radius = 0.0f;
+		for (uint32_t i = 0; i < indexCount; i++)
+			radius = glm::max(radius, glm::length(vertices[indices[i]].Position - center));
+
+		meshlet.BoundingSphere = glm::vec4(center, radius);
+
+		// The cone axis is the average face normal, its spread is the widest angle any face normal makes with it
+		std::vector<glm::vec3> normals;
+		normals.reserve(meshlet.TriangleCount);
+		glm::vec3 axis = glm::vec3(0.0f);
+		for (uint32_t i = 0; i < indexCount; i += 3)
+		{
+			glm::vec3 a = vertices[indices[i + 0]].Position;
+			glm::vec3 b = vertices[indices[i + 1]].Position;
+			glm::vec3 c = vertices[indices[i + 2]].Position;
+
+			glm::vec3 normal = glm::cross(b - a, c - a);
+			float length = glm::length(normal);
+			if (length <= 0.0f)
+				continue;
+
+			normals.push_back(normal / length);
+			axis += normals.back();
+		}
+
+		meshlet.Cone = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+		float axisLength = glm::length(axis);
+		if (normals.empty() || axisLength <= 0.0f)
+			return;
+
+		axis /= axisLength;
+		float minDot = 1.0f;
+		for (auto& normal : normals)
+			minDot = glm::min(minDot, glm::dot(axis, normal));
+
+		// Close to a hemisphere or wider, some view always sees a front face
+		if (minDot <= 0.1f)
+			return;
+
+		meshlet.Cone = glm::vec4(axis, glm::sqrt(1.0f - minDot * minDot));
+	}
+
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "Mesh.h"
+
+namespace Rose
+{
+
+	// Splits a mesh's index buffer into meshlets for cluster culling. Import time only, meshlets are cooked with the mesh.
+	class MeshletBuilder
+	{
+		public :
+			static const uint32_t MaxVertices = 64;
+			static const uint32_t MaxTriangles = 124;
+
+			// Cuts the triangle list into meshlets in its current order, so the index buffer stays as it is.
+			// Run it after MeshOptimizer, whose cache friendly order keeps neighbouring triangles together.
+			// A meshlet never spans two sub meshes of a static batch, every sub mesh starts a new one.
+			static void Build(Mesh& mesh);
+
+			// Bounding sphere and normal cone of the triangles the meshlet covers
+			static void ComputeBounds(const Mesh& mesh, Meshlet& meshlet);
+	};
+
+}
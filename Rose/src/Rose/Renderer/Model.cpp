@@ -1,7 +1,11 @@
 #include "Model.h"
+#include "GLTFLoader.h"
 
 
 #include "Rose/Core/Log.h"
+#include "Rose/Core/JobSystem.h"
+#include "Rose/Core/Profiler.h"
+#include "API/TextureCache.h"
 
 #include <assimp/Importer.hpp>
 #include <assimp/postprocess.h>
@@ -11,12 +15,57 @@
 namespace Rose
 {
 
-	Model::Model(const std::string& filepath) 
-		: m_Filepath(filepath)
+	Model::Model(const std::string& filepath, VertexFormat vertexFormat, bool isStatic) 
+		: m_Filepath(filepath), m_VertexFormat(vertexFormat), m_IsStatic(isStatic)
 	{
+		CookedModel model;
+		bool loaded = false;
 
+		std::string cookedPath = MeshCooker::GetCookedPath(filepath, vertexFormat);
+		if (MeshCooker::IsUpToDate(filepath, cookedPath))
+		{
+			ScopedProfile profile("Model cooked load");
+			loaded = MeshCooker::Load(cookedPath, model, isStatic, vertexFormat);
+		}
+
+		// glTF has a native parser, Assimp is only the fallback for everything else and for glTF files the parser can't handle.
+		// Either way the result is cooked, so the next load skips meshlets, LODs and packing and is staged straight from the file
+		if (!loaded)
+		{
+			bool parsed = false;
+			if (GLTFLoader::IsGLTF(filepath))
+			{
+				ScopedProfile profile("Model glTF load");
+				parsed = GLTFLoader::Load(filepath, model, isStatic);
+			}
+
+			if (!parsed && !Import(model))
+				return;
+
+			if (MeshCooker::Write(cookedPath, model, vertexFormat))
+				LOG("Cooked '%s' into '%s'\n", filepath.c_str(), cookedPath.c_str());
+		}
+
+		m_Meshes = std::move(model.Meshes);
+		m_Nodes = std::move(model.Nodes);
+		m_MeshNodes = std::move(model.MeshNodes);
+		m_MeshMaterials = std::move(model.MeshMaterials);
+		m_PackedMeshes = std::move(model.PackedMeshes);
+		m_PackedSource = std::move(model.PackedSource);
+
+		// Textures, pipelines and descriptor sets are created afterwards, once per material, meshes sharing one share its set and GPUScene record
+		ScopedProfile profile("Model material creation");
+		m_Materials.reserve(model.Materials.size());
+		for (const auto& material : model.Materials)
+		{
+			m_Materials.push_back(CreateMaterial(material));
+		}
+	}
+
+	bool Model::Import(CookedModel& outModel)
+	{
 		Assimp::Importer importer;
-		const aiScene* scene = importer.ReadFile(filepath,
+		const aiScene* scene = importer.ReadFile(m_Filepath,
 
 			aiPostProcessSteps::aiProcess_Triangulate | aiPostProcessSteps::aiProcess_CalcTangentSpace
 			| aiPostProcessSteps::aiProcess_GenNormals | aiPostProcessSteps::aiProcess_GenUVCoords
@@ -28,55 +77,84 @@ namespace Rose
 		{
 			LOG("ASSIMP Failed!\tError: %s\n", importer.GetErrorString());
 			ASSERT();
-			return;
+			return false;
+		}
+
+		std::vector<aiMesh*> meshes;
+		ProcessNode(scene->mRootNode, scene, UINT32_MAX, meshes, outModel);
+
+		// Mesh conversion doesn't touch Vulkan, every aiMesh gets its own job writing into its own slot
+		{
+			ScopedProfile profile("Model mesh conversion");
+
+			outModel.Meshes.resize(meshes.size());
+
+			JobCounter counter;
+			for (uint32_t i = 0; i < meshes.size(); i++)
+			{
+				JobSystem::Run([&, i]()
+				{
+					ConvertMesh(meshes[i], outModel.Meshes[i]);
+				}, &counter);
+			}
+			JobSystem::Wait(counter);
 		}
 
-		ProcessNode(scene->mRootNode, scene);
+		outModel.Materials.reserve(scene->mNumMaterials);
+		for (uint32_t i = 0; i < scene->mNumMaterials; i++)
+			outModel.Materials.push_back(ConvertMaterial(scene->mMaterials[i]));
+
+		outModel.MeshMaterials.reserve(meshes.size());
+		for (auto mesh : meshes)
+			outModel.MeshMaterials.push_back(mesh->mMaterialIndex);
+
+		MeshCooker::Process(outModel, m_IsStatic, m_Filepath);
+		return true;
 	}
 
 
 	void Model::CleanUp()
 	{
+		// Textures are shared with other models through the TextureCache, dropping the references lets the last user destroy them
 		for (auto& material : m_Materials)
 		{
-			material.ShaderData->DestroyPipeline();
-			for (auto& uniform : material.Uniforms)
-			{
-				if(uniform.Texture)
-					uniform.Texture->Destroy();
-				if(uniform.Texture3DCube)
-					uniform.Texture3DCube->Destroy();
-
-			}
+			material.Destroy();
+			material.Uniforms.clear();
 		}
+		TextureCache::Evict();
 	}
 
-	void Model::ProcessNode(aiNode* node, const aiScene* scene)
+	void Model::ProcessNode(aiNode* node, const aiScene* scene, uint32_t parent, std::vector<aiMesh*>& outMeshes, CookedModel& outModel)
 	{
+		// Assimp matrices are row major
+		const aiMatrix4x4& m = node->mTransformation;
+		CookedNode cookedNode;
+		cookedNode.LocalTransform = glm::mat4(m.a1, m.b1, m.c1, m.d1, m.a2, m.b2, m.c2, m.d2, m.a3, m.b3, m.c3, m.d3, m.a4, m.b4, m.c4, m.d4);
+		cookedNode.Parent = parent;
+
+		uint32_t nodeIndex = (uint32_t)outModel.Nodes.size();
+		outModel.Nodes.push_back(cookedNode);
+
 		for (uint32_t i = 0; i < node->mNumMeshes; i++)
 		{
-			aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
-			m_Meshes.push_back(CreateMesh(mesh, scene));
+			outMeshes.push_back(scene->mMeshes[node->mMeshes[i]]);
+			outModel.MeshNodes.push_back(nodeIndex);
 		}
 		for (uint32_t i = 0; i < node->mNumChildren; i++)
 		{
-			ProcessNode(node->mChildren[i], scene);
+			ProcessNode(node->mChildren[i], scene, nodeIndex, outMeshes, outModel);
 		}
 
 
 	}
 
-	Rose::Mesh Model::CreateMesh(aiMesh* mesh, const aiScene* scene)
+	void Model::ConvertMesh(const aiMesh* mesh, Mesh& outMesh)
 	{
-
-		Mesh result;
-
-		int mult3 = 0;
-		Triangle triangle{};
+		outMesh.Verticies.resize(mesh->mNumVertices);
 
 		for (uint32_t i = 0; i < mesh->mNumVertices; i++)
 		{
-			Vertex vertex;
+			Vertex& vertex = outMesh.Verticies[i];
 
 			vertex.Position.x = mesh->mVertices[i].x;
 			vertex.Position.y = mesh->mVertices[i].y;
@@ -103,135 +181,132 @@ namespace Rose
 				vertex.TexCoord.x = mesh->mTextureCoords[0][i].x;
 				vertex.TexCoord.y = mesh->mTextureCoords[0][i].y;
 			}
-
-			result.Verticies.push_back(vertex);
 		}
 
 
-		
+		uint32_t indexCount = 0;
+		for (uint32_t i = 0; i < mesh->mNumFaces; i++)
+			indexCount += mesh->mFaces[i].mNumIndices;
+
+		outMesh.Indicies.resize(indexCount);
 
+		uint32_t index = 0;
 		for (uint32_t i = 0; i < mesh->mNumFaces; i++)
 		{
-			aiFace face = mesh->mFaces[i];
+			const aiFace& face = mesh->mFaces[i];
 			for (uint32_t j = 0; j < face.mNumIndices; j++)
 			{
-				result.Indicies.push_back(face.mIndices[j]);
+				outMesh.Indicies[index++] = face.mIndices[j];
 			}
 		}
 
-		if (mesh->mMaterialIndex >= 0)
-		{
-			Material result;
-			result.Name = "No name";
-
-
-			aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];
-
-			auto diffMaps = LoadTextures(material, aiTextureType_DIFFUSE);
-			result.Uniforms.insert(result.Uniforms.end(), diffMaps.begin(), diffMaps.end());
-
-
-			auto normMaps = LoadTextures(material, aiTextureType_NORMALS);
-			result.Uniforms.insert(result.Uniforms.end(), normMaps.begin(), normMaps.end());
-
-			auto metalMaps = LoadTextures(material, aiTextureType_METALNESS);
-			result.Uniforms.insert(result.Uniforms.end(), metalMaps.begin(), metalMaps.end());
-
-			auto roughMaps = LoadTextures(material, aiTextureType_SHININESS);
-			result.Uniforms.insert(result.Uniforms.end(), roughMaps.begin(), roughMaps.end());
-
-			MaterialUniform irr;
-			irr.Texture3DCube = EnviormentTexture::GetIrradianceMap();
-			irr.TextureType = PBRTextureType::Irr;
-			result.Uniforms.insert(result.Uniforms.end(), irr);
-
+		outMesh.CalculateBounds();
+	}
 
-			MaterialUniform rad;
-			rad.Texture3DCube = EnviormentTexture::GetRadienceMap();
-			rad.TextureType = PBRTextureType::Rad;
-			result.Uniforms.insert(result.Uniforms.end(), rad);
+	CookedMaterial Model::ConvertMaterial(aiMaterial* material)
+	{
+		CookedMaterial result;
+		result.Name = "No name";
 
+		ConvertTextures(material, aiTextureType_DIFFUSE, result);
+		ConvertTextures(material, aiTextureType_NORMALS, result);
+		ConvertTextures(material, aiTextureType_METALNESS, result);
+		ConvertTextures(material, aiTextureType_SHININESS, result);
 
-			MaterialUniform specBRDF;
-			specBRDF.Texture = EnviormentTexture::GetSpecularBRDF();
-			specBRDF.TextureType = PBRTextureType::SpecBRDF;
-			result.Uniforms.insert(result.Uniforms.end(), specBRDF);
+		// The diffuse color only stands in for a missing texture, FBX exporters write one next to the map too
+		aiColor4D diffuse;
+		if (!material->GetTextureCount(aiTextureType_DIFFUSE) && material->Get(AI_MATKEY_COLOR_DIFFUSE, diffuse) == AI_SUCCESS)
+			result.AlbedoFactor = glm::vec4(diffuse.r, diffuse.g, diffuse.b, diffuse.a);
+		material->Get(AI_MATKEY_METALLIC_FACTOR, result.MetalnessFactor);
+		material->Get(AI_MATKEY_ROUGHNESS_FACTOR, result.RoughnessFactor);
 
-		
-			ShaderAttributeLayout layout =
-			{
-				{"a_Position", 0, ShaderMemberType::Float3},
-				{"a_Normal", 1, ShaderMemberType::Float3},
-				{"a_Tangent", 2, ShaderMemberType::Float3},
-				{"a_Binormal", 3, ShaderMemberType::Float3},
-				{"a_TexCoord", 4, ShaderMemberType::Float2}
-			};
+		return result;
+	}
 
-			result.ShaderData = std::make_shared<Rose::Shader>("assets/shaders/main.shader", layout);
-		
-			result.ShaderData->CreatePipelineAndDescriptorPool(result.Uniforms);
+	void Model::ConvertTextures(aiMaterial* mat, aiTextureType type, CookedMaterial& outMaterial)
+	{
+		CookedTexture texture;
+
+		if (type == aiTextureType_DIFFUSE)
+			texture.TextureType = PBRTextureType::Albedo;
+		else if (type == aiTextureType_SPECULAR)
+			texture.TextureType = PBRTextureType::Specular;
+		else if (type == aiTextureType_NORMALS)
+			texture.TextureType = PBRTextureType::Normal;
+		else if (type == aiTextureType_METALNESS)
+			texture.TextureType = PBRTextureType::Metal;
+		else if (type == aiTextureType_DIFFUSE_ROUGHNESS || type == aiTextureType_SHININESS)
+			texture.TextureType = PBRTextureType::Rough;
+
+		texture.IsNormalMap = (type == aiTextureType_NORMALS);
+
+		unsigned int count = mat->GetTextureCount(type);
+		for (unsigned int i = 0; i < count; i++)
+		{
+			aiString str;
+			mat->GetTexture(type, i, &str);
 
-			m_Materials.push_back(result);
+			std::filesystem::path modelPath = m_Filepath;
+			std::filesystem::path modelParentPath = modelPath.parent_path();
+			texture.Path = modelParentPath.string() + std::string("/") + std::string(str.C_Str());
 
+			outMaterial.Textures.push_back(texture);
 		}
 
-		
-
-		return result;
+		// An empty path falls back to the default white texture
+		if (!count)
+			outMaterial.Textures.push_back(texture);
 	}
 
-	std::vector<MaterialUniform> Model::LoadTextures(aiMaterial* mat, aiTextureType type)
+	Material Model::CreateMaterial(const CookedMaterial& material)
 	{
-		std::vector<MaterialUniform> result;
+		Material result;
+		result.Name = material.Name;
+		result.AlbedoFactor = material.AlbedoFactor;
+		result.MetalnessFactor = material.MetalnessFactor;
+		result.RoughnessFactor = material.RoughnessFactor;
 
-		for (unsigned int i = 0; i < mat->GetTextureCount(type); i++)
+		for (auto& texture : material.Textures)
 		{
 			MaterialUniform uniform;
+			uniform.TextureType = texture.TextureType;
 
-			if (type == aiTextureType_DIFFUSE)
-				uniform.TextureType = PBRTextureType::Albedo;
-			else if (type == aiTextureType_SPECULAR)
-				uniform.TextureType = PBRTextureType::Specular;
-			else if (type == aiTextureType_NORMALS)
-				uniform.TextureType = PBRTextureType::Normal;
-			else if (type == aiTextureType_METALNESS)
-				uniform.TextureType = PBRTextureType::Metal;
-			else if (type == aiTextureType_DIFFUSE_ROUGHNESS || type == aiTextureType_SHININESS)
-				uniform.TextureType = PBRTextureType::Rough;
+			if (texture.Path.empty())
+			{
+				uniform.Texture = Material::DefaultWhiteTexture();
+			}
+			else
+			{
+				TextureProperties props;
+				props.IsNormalMap = texture.IsNormalMap;
+				uniform.Texture = TextureCache::Get(texture.Path, props);
+			}
 
-			aiString str;
-			mat->GetTexture(type, i, &str);
+			result.Uniforms.push_back(uniform);
+		}
 
+		MaterialUniform irr;
+		irr.Texture3DCube = EnviormentTexture::GetIrradianceMap();
+		irr.TextureType = PBRTextureType::Irr;
+		result.Uniforms.insert(result.Uniforms.end(), irr);
 
-			std::filesystem::path modelPath = m_Filepath;
-			std::filesystem::path modelParentPath = modelPath.parent_path();
-			TextureProperties props;
-			props.IsNormalMap = (type == aiTextureType_NORMALS);
 
-			uniform.Texture = std::make_shared<Texture2D>(modelParentPath.string() + std::string("/") +std::string(str.C_Str()), props);
+		MaterialUniform rad;
+		rad.Texture3DCube = EnviormentTexture::GetRadienceMap();
+		rad.TextureType = PBRTextureType::Rad;
+		result.Uniforms.insert(result.Uniforms.end(), rad);
 
-			result.push_back(uniform);
-		}
 
-		if (!result.size())
-		{
-			MaterialUniform uniform;
+		MaterialUniform specBRDF;
+		specBRDF.Texture = EnviormentTexture::GetSpecularBRDF();
+		specBRDF.TextureType = PBRTextureType::SpecBRDF;
+		result.Uniforms.insert(result.Uniforms.end(), specBRDF);
 
-			if (type == aiTextureType_DIFFUSE)
-				uniform.TextureType = PBRTextureType::Albedo;
-			else if (type == aiTextureType_SPECULAR)
-				uniform.TextureType = PBRTextureType::Specular;
-			else if (type == aiTextureType_NORMALS)
-				uniform.TextureType = PBRTextureType::Normal;
-			else if (type == aiTextureType_METALNESS)
-				uniform.TextureType = PBRTextureType::Metal;
-			else if (type == aiTextureType_DIFFUSE_ROUGHNESS || type == aiTextureType_SHININESS)
-				uniform.TextureType = PBRTextureType::Rough;
 
-			uniform.Texture = Material::DefaultWhiteTexture();
+		result.ShaderData = ShaderLibrary::Get("assets/shaders/main.shader", VertexPacker::GetLayout(m_VertexFormat));
+		result.CreateDescriptorSet();
+		result.CreateRecord();
 
-			result.push_back(uniform);
-		}
 		return result;
 	}
 
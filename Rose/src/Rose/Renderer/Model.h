@@ -2,6 +2,8 @@
 
 #include "Mesh.h"
 #include "Material.h"
+#include "MeshCooker.h"
+#include "VertexFormat.h"
 
 #include <string>
 
@@ -15,7 +17,8 @@ namespace Rose
 	{
 
 		public :
-			Model(const std::string& filepath);
+			// Static models are merged by the StaticBatcher on import, their node hierarchy is flattened into a single root node
+			Model(const std::string& filepath, VertexFormat vertexFormat = VertexFormat::Full, bool isStatic = true);
 			void CleanUp();
 
 
@@ -24,17 +27,42 @@ namespace Rose
 
 			const std::vector<Material>& GetMaterials() const { return m_Materials; }
 			std::vector<Material>& GetMaterials() { return m_Materials; }
+			const Material& GetMeshMaterial(uint32_t mesh) const { return m_Materials[m_MeshMaterials[mesh]]; }
+
+			// Parents come before their children
+			const std::vector<CookedNode>& GetNodes() const { return m_Nodes; }
+			// The node every mesh hangs off, meshes are in the node's space
+			uint32_t GetMeshNode(uint32_t mesh) const { return m_MeshNodes[mesh]; }
+
+			VertexFormat GetVertexFormat() const { return m_VertexFormat; }
+			// The mesh's streams in the model's vertex format when it was loaded from a cooked file, null when only Verticies has them
+			const PackedGeometry* GetPackedGeometry(uint32_t mesh) const { return m_PackedMeshes.empty() ? nullptr : &m_PackedMeshes[mesh]; }
 
 		private :
-			void ProcessNode(aiNode* node, const aiScene* scene);
-			Mesh CreateMesh(aiMesh* mesh, const aiScene* scene);
-			std::vector<MaterialUniform> LoadTextures(aiMaterial* mat, aiTextureType type);
+			// Runs Assimp on the source file, only needed when there is no up to date cooked file
+			bool Import(CookedModel& outModel);
+			// Collects the nodes depth first and the meshes in node order, the conversion itself happens in parallel afterwards
+			void ProcessNode(aiNode* node, const aiScene* scene, uint32_t parent, std::vector<aiMesh*>& outMeshes, CookedModel& outModel);
+			// Only touches outMesh, safe to run from any job
+			static void ConvertMesh(const aiMesh* mesh, Mesh& outMesh);
+			CookedMaterial ConvertMaterial(aiMaterial* material);
+			void ConvertTextures(aiMaterial* mat, aiTextureType type, CookedMaterial& outMaterial);
+			// Creates textures and descriptor sets, main thread only
+			Material CreateMaterial(const CookedMaterial& material);
 
 		private :
 
 			std::string m_Filepath;
+			VertexFormat m_VertexFormat;
+			bool m_IsStatic;
 			std::vector<Mesh> m_Meshes;
 			std::vector<Material> m_Materials;
+			std::vector<CookedNode> m_Nodes;
+			std::vector<uint32_t> m_MeshNodes;
+			std::vector<uint32_t> m_MeshMaterials; // Index into m_Materials for every mesh
+
+			std::vector<PackedGeometry> m_PackedMeshes;
+			std::shared_ptr<MappedFile> m_PackedSource; // The cooked file, mapped for as long as the packed meshes point into it
 	};
 
 }
\ No newline at end of file
@@ -2,6 +2,8 @@
 
 #include <glm/glm.hpp>
 
+#include "Frustum.h"
+
 namespace Rose
 {
 
@@ -41,6 +43,8 @@ namespace Rose
 			glm::mat4& GetProjView() { return m_ProjView; }
 			glm::mat4& GetView() { return m_View; }
 			glm::mat4& GetProj() { return m_Projection; }
+			// Planes of the current view projection
+			Frustum GetFrustum() const { return Frustum::FromMatrix(m_ProjView); }
 
 			void RecalculateMatrix();
 
@@ -4,10 +4,25 @@
 #include "Rose/Core/Log.h"
 
 #include <vector>
+#include <fstream>
+#include <filesystem>
+#include <cstring>
 #include "Rose/Core/Application.h"
 
 namespace Rose
 {
+	static const char* s_PipelineCachePath = "assets/cache/pipeline.cache";
+
+	// Layout of VK_PIPELINE_CACHE_HEADER_VERSION_ONE, our SDK headers predate VkPipelineCacheHeaderVersionOne
+	struct PipelineCacheHeader
+	{
+		uint32_t HeaderSize;
+		uint32_t HeaderVersion;
+		uint32_t VendorID;
+		uint32_t DeviceID;
+		uint8_t PipelineCacheUUID[VK_UUID_SIZE];
+	};
+
 	//////////////////////////////////////////////////////////////////////////
 	/////////////////////// PhysicalRenderingDevice	//////////////////////////
 	//////////////////////////////////////////////////////////////////////////
@@ -47,6 +62,14 @@ namespace Rose
 		vkGetPhysicalDeviceFeatures(m_PhysicalDevice, &m_PhysicalDeviceFeatures);
 		vkGetPhysicalDeviceMemoryProperties(m_PhysicalDevice, &m_PhysicalMemProps);
 
+		VkPhysicalDeviceVulkan12Features supported12{};
+		supported12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+		VkPhysicalDeviceFeatures2 supported{};
+		supported.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+		supported.pNext = &supported12;
+		vkGetPhysicalDeviceFeatures2(m_PhysicalDevice, &supported);
+		m_SupportsDrawIndirectCount = supported12.drawIndirectCount == VK_TRUE;
+
 
 
 
@@ -74,54 +97,64 @@ namespace Rose
 		}
 
 
-		int queueTypesToQuery = VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_TRANSFER_BIT;
+		m_QueueFamilyIndicies.Graphics = -1;
+		m_QueueFamilyIndicies.Transfer = -1;
+		m_QueueFamilyIndicies.Present = -1;
 
-		int i = 0;
-		int found = 0;
-		for (const auto& queueFamily : queueFamilies) {
-			if (queueTypesToQuery & VK_QUEUE_GRAPHICS_BIT)
+		for (int i = 0; i < (int)queueFamilies.size(); i++)
+		{
+			if (queueFamilies[i].queueFlags & VK_QUEUE_GRAPHICS_BIT)
 			{
-				if (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) {
-					m_QueueFamilyIndicies.Graphics = i;
-
+				m_QueueFamilyIndicies.Graphics = i;
+				m_QueueFamilyIndicies.Present = i;
+				break;
+			}
+		}
 
-					m_QueueFamilyIndicies.Present = i;
-					found = 1;
-					i++;
-					continue;
-				}
+		// Prefer a transfer only family (the copy engine), then anything that can copy but isn't the graphics family.
+		// Uploads only ever copy whole mip levels, so the coarse image granularity some of these families have doesn't matter.
+		for (int i = 0; i < (int)queueFamilies.size(); i++)
+		{
+			VkQueueFlags flags = queueFamilies[i].queueFlags;
+			if ((flags & VK_QUEUE_TRANSFER_BIT) && !(flags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)))
+			{
+				m_QueueFamilyIndicies.Transfer = i;
+				break;
 			}
+		}
 
-			if (queueTypesToQuery & VK_QUEUE_TRANSFER_BIT)
+		if (m_QueueFamilyIndicies.Transfer == -1)
+		{
+			for (int i = 0; i < (int)queueFamilies.size(); i++)
 			{
-				if ((queueFamily.queueFlags & VK_QUEUE_TRANSFER_BIT) && found == 1)
+				// Graphics and compute families can always copy, even if they don't report the transfer bit
+				VkQueueFlags flags = queueFamilies[i].queueFlags;
+				if (i != m_QueueFamilyIndicies.Graphics && (flags & (VK_QUEUE_TRANSFER_BIT | VK_QUEUE_COMPUTE_BIT)))
 				{
 					m_QueueFamilyIndicies.Transfer = i;
-					found = 2;
-					i++;
-					continue;
+					break;
 				}
 			}
-
-			if (found == 2)
-				break;
-			i++;
 		}
 
-
-
-
-		if (queueTypesToQuery & VK_QUEUE_GRAPHICS_BIT)
+		if (m_QueueFamilyIndicies.Transfer == -1)
 		{
-			VkDeviceQueueCreateInfo queueCreateInfo{};
-			queueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
-			queueCreateInfo.queueFamilyIndex = m_QueueFamilyIndicies.Graphics;
-			queueCreateInfo.queueCount = 1;
-			queueCreateInfo.pQueuePriorities = &queuePriority;
-			m_DeviceQueueInfos.push_back(queueCreateInfo);
+			LOG("No separate transfer queue family, uploads go through the graphics queue\n");
+			m_QueueFamilyIndicies.Transfer = m_QueueFamilyIndicies.Graphics;
 		}
+		else
+			LOG("Using queue family %d for transfers (graphics is %d)\n", m_QueueFamilyIndicies.Transfer, m_QueueFamilyIndicies.Graphics);
+
 
-		if (queueTypesToQuery & VK_QUEUE_TRANSFER_BIT)
+		VkDeviceQueueCreateInfo queueCreateInfo{};
+		queueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+		queueCreateInfo.queueFamilyIndex = m_QueueFamilyIndicies.Graphics;
+		queueCreateInfo.queueCount = 1;
+		queueCreateInfo.pQueuePriorities = &queuePriority;
+		m_DeviceQueueInfos.push_back(queueCreateInfo);
+
+		// Every family may only be listed once
+		if (m_QueueFamilyIndicies.Transfer != m_QueueFamilyIndicies.Graphics)
 		{
 			VkDeviceQueueCreateInfo queueInfo{};
 			queueInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
@@ -130,12 +163,8 @@ namespace Rose
 			queueInfo.pQueuePriorities = &queuePriority;
 
 			m_DeviceQueueInfos.push_back(queueInfo);
-
 		}
 
-	
-
-
 	}
 
 	PhysicalRenderingDevice::~PhysicalRenderingDevice()
@@ -198,7 +227,7 @@ namespace Rose
 	//////////////////////////////////////////////////////////////////////////
 
 
-	LogicalRenderingDevice::LogicalRenderingDevice(const std::shared_ptr<PhysicalRenderingDevice>& physicalDevice, VkPhysicalDeviceFeatures features)
+	LogicalRenderingDevice::LogicalRenderingDevice(const std::shared_ptr<PhysicalRenderingDevice>& physicalDevice, VkPhysicalDeviceFeatures features, uint32_t framesInFlight)
 	{
 		m_PhysicalDevice = physicalDevice;
 		std::vector<const char*> deviceExtensions;
@@ -210,6 +239,14 @@ namespace Rose
 		deviceCreateInfo.pQueueCreateInfos = physicalDevice->m_DeviceQueueInfos.data();
 		deviceCreateInfo.pEnabledFeatures = &features;
 
+		// Core since 1.2, used to hand uploads from the transfer queue over to the graphics queue
+		VkPhysicalDeviceVulkan12Features features12{};
+		features12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+		features12.timelineSemaphore = VK_TRUE;
+		// GPU cluster culling writes how many draws survived, the draw reads the count back on the GPU
+		features12.drawIndirectCount = physicalDevice->SupportsDrawIndirectCount() ? VK_TRUE : VK_FALSE;
+		deviceCreateInfo.pNext = &features12;
+
 		
 		if (deviceExtensions.size() > 0)
 		{
@@ -226,6 +263,7 @@ namespace Rose
 		vkCreateCommandPool(m_Device, &cmdPoolInfo, nullptr, &m_CommandPool);
 
 		vkGetDeviceQueue(m_Device, m_PhysicalDevice->GetQueueFamily().Graphics, 0, &m_RenderingQueue);
+		vkGetDeviceQueue(m_Device, m_PhysicalDevice->GetQueueFamily().Transfer, 0, &m_TransferQueue);
 
 
 		VkSemaphoreCreateInfo semaphoreInfo{};
@@ -236,10 +274,24 @@ namespace Rose
 		fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
 
 
-		vkCreateSemaphore(m_Device, &semaphoreInfo, nullptr, &m_ImageReadySemaphore);
-		vkCreateSemaphore(m_Device, &semaphoreInfo, nullptr, &m_RenderFinishedSemaphore);
-		vkCreateFence(m_Device, &fenceInfo, nullptr, &m_FramesInFlightFence);
+		m_Frames.resize(framesInFlight ? framesInFlight : 1);
+		for (auto& frame : m_Frames)
+		{
+			vkCreateCommandPool(m_Device, &cmdPoolInfo, nullptr, &frame.CommandPool);
+
+			VkCommandBufferAllocateInfo allocInfo{};
+			allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+			allocInfo.commandPool = frame.CommandPool;
+			allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+			allocInfo.commandBufferCount = 1;
+			vkAllocateCommandBuffers(m_Device, &allocInfo, &frame.CommandBuffer);
+
+			vkCreateSemaphore(m_Device, &semaphoreInfo, nullptr, &frame.ImageReadySemaphore);
+			vkCreateSemaphore(m_Device, &semaphoreInfo, nullptr, &frame.RenderFinishedSemaphore);
+			vkCreateFence(m_Device, &fenceInfo, nullptr, &frame.InFlightFence);
+		}
 
+		CreatePipelineCache();
 	}
 
 	LogicalRenderingDevice::~LogicalRenderingDevice()
@@ -255,7 +307,9 @@ namespace Rose
 		VkSubmitInfo submitInfo{};
 		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
-		VkSemaphore waitSemaphores[] = { m_ImageReadySemaphore };
+		FrameData& frame = m_Frames[m_CurrentFrame];
+
+		VkSemaphore waitSemaphores[] = { frame.ImageReadySemaphore };
 		VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
 		submitInfo.waitSemaphoreCount = 1;
 		submitInfo.pWaitSemaphores = waitSemaphores;
@@ -264,12 +318,12 @@ namespace Rose
 		submitInfo.commandBufferCount = 1;
 		submitInfo.pCommandBuffers = &buffer;
 
-		VkSemaphore signalSemaphores[] = { m_RenderFinishedSemaphore };
+		VkSemaphore signalSemaphores[] = { frame.RenderFinishedSemaphore };
 		submitInfo.signalSemaphoreCount = 1;
 		submitInfo.pSignalSemaphores = signalSemaphores;
 
-		vkQueueSubmit(m_RenderingQueue, 1, &submitInfo, m_FramesInFlightFence);
-		vkWaitForFences(m_Device, 1, &m_FramesInFlightFence, VK_TRUE, UINT64_MAX);
+		// No wait here, BeginCommand waits on this fence when the slot comes around again
+		vkQueueSubmit(m_RenderingQueue, 1, &submitInfo, frame.InFlightFence);
 
 		
  		VkPresentInfoKHR presentInfo{};
@@ -286,31 +340,124 @@ namespace Rose
 
 		vkQueuePresentKHR(m_RenderingQueue, &presentInfo);
 
+		m_CurrentFrame = (m_CurrentFrame + 1) % (uint32_t)m_Frames.size();
 	}
 
 	void LogicalRenderingDevice::Shutdown()
 	{
+		SavePipelineCache();
+		vkDestroyPipelineCache(m_Device, m_PipelineCache, nullptr);
+
+		vkDeviceWaitIdle(m_Device);
 		vkDestroyCommandPool(m_Device, m_CommandPool, nullptr);
 
-		vkDestroySemaphore(m_Device, m_ImageReadySemaphore, nullptr);
-		vkDestroySemaphore(m_Device, m_RenderFinishedSemaphore, nullptr);
-		vkDestroyFence(m_Device, m_FramesInFlightFence, nullptr);
+		for (auto& frame : m_Frames)
+		{
+			vkDestroyCommandPool(m_Device, frame.CommandPool, nullptr);
+			vkDestroySemaphore(m_Device, frame.ImageReadySemaphore, nullptr);
+			vkDestroySemaphore(m_Device, frame.RenderFinishedSemaphore, nullptr);
+			vkDestroyFence(m_Device, frame.InFlightFence, nullptr);
+		}
+		m_Frames.clear();
 
-		vkDeviceWaitIdle(m_Device);
 		vkDestroyDevice(m_Device, nullptr);
 
 
 	}
 
-	void LogicalRenderingDevice::BeginCommand(VkCommandBuffer& buffer)
+	VkCommandBuffer LogicalRenderingDevice::BeginCommand()
 	{
-		vkWaitForFences(m_Device, 1, &m_FramesInFlightFence, VK_TRUE, UINT64_MAX);
-		vkResetFences(m_Device, 1, &m_FramesInFlightFence);
+		FrameData& frame = m_Frames[m_CurrentFrame];
+		vkWaitForFences(m_Device, 1, &frame.InFlightFence, VK_TRUE, UINT64_MAX);
 
 		uint32_t imageIndex = 0;
-		vkAcquireNextImageKHR(m_Device, Application::Get().GetSwapChain()->GetSwapChain(), UINT64_MAX, m_ImageReadySemaphore, VK_NULL_HANDLE, &imageIndex);
+		vkAcquireNextImageKHR(m_Device, Application::Get().GetSwapChain()->GetSwapChain(), UINT64_MAX, frame.ImageReadySemaphore, VK_NULL_HANDLE, &imageIndex);
 		m_ImageIndex = imageIndex;
-		vkResetCommandBuffer(buffer, 0);
+
+		// The swapchain can hand out images out of order, so an older frame may still be rendering into this one
+		if (m_ImagesInFlight.size() <= imageIndex)
+			m_ImagesInFlight.resize(imageIndex + 1, VK_NULL_HANDLE);
+
+		if (m_ImagesInFlight[imageIndex] != VK_NULL_HANDLE && m_ImagesInFlight[imageIndex] != frame.InFlightFence)
+			vkWaitForFences(m_Device, 1, &m_ImagesInFlight[imageIndex], VK_TRUE, UINT64_MAX);
+		m_ImagesInFlight[imageIndex] = frame.InFlightFence;
+
+		vkResetFences(m_Device, 1, &frame.InFlightFence);
+
+		// Resetting the whole pool is cheaper than resetting buffers one by one
+		vkResetCommandPool(m_Device, frame.CommandPool, 0);
+		return frame.CommandBuffer;
+	}
+
+	void LogicalRenderingDevice::CreatePipelineCache()
+	{
+		std::vector<char> data;
+
+		std::ifstream file(s_PipelineCachePath, std::ios::in | std::ios::binary | std::ios::ate);
+		if (file)
+		{
+			data.resize((size_t)file.tellg());
+			file.seekg(0);
+			file.read(data.data(), data.size());
+		}
+
+		// A cache from another driver or GPU is rejected by the driver anyway but some are known to crash instead, so check it ourselves
+		if (data.size() >= sizeof(PipelineCacheHeader))
+		{
+			PipelineCacheHeader header;
+			memcpy(&header, data.data(), sizeof(header));
+
+			const auto& props = m_PhysicalDevice->GetProperties();
+			if (header.HeaderSize < sizeof(header) || header.HeaderVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+				|| header.VendorID != props.vendorID || header.DeviceID != props.deviceID
+				|| memcmp(header.PipelineCacheUUID, props.pipelineCacheUUID, VK_UUID_SIZE) != 0)
+			{
+				LOG("Pipeline cache '%s' was made by a different device or driver, ignoring it\n", s_PipelineCachePath);
+				data.clear();
+			}
+		}
+		else
+		{
+			data.clear();
+		}
+
+		VkPipelineCacheCreateInfo cacheInfo{};
+		cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+		cacheInfo.initialDataSize = data.size();
+		cacheInfo.pInitialData = data.size() ? data.data() : nullptr;
+
+		if (vkCreatePipelineCache(m_Device, &cacheInfo, nullptr, &m_PipelineCache) != VK_SUCCESS)
+		{
+			LOG("Failed to create a pipeline cache from '%s', starting cold\n", s_PipelineCachePath);
+			cacheInfo.initialDataSize = 0;
+			cacheInfo.pInitialData = nullptr;
+			vkCreatePipelineCache(m_Device, &cacheInfo, nullptr, &m_PipelineCache);
+			data.clear();
+		}
+
+		m_PipelineCacheWarm = !data.empty();
+		LOG("Pipeline cache: %s (%d bytes)\n", m_PipelineCacheWarm ? "warm" : "cold", (uint32_t)data.size());
+	}
+
+	void LogicalRenderingDevice::SavePipelineCache()
+	{
+		size_t size = 0;
+		vkGetPipelineCacheData(m_Device, m_PipelineCache, &size, nullptr);
+
+		std::vector<char> data(size);
+		if (!size || vkGetPipelineCacheData(m_Device, m_PipelineCache, &size, data.data()) != VK_SUCCESS)
+			return;
+
+		std::error_code error;
+		std::filesystem::create_directories(std::filesystem::path(s_PipelineCachePath).parent_path(), error);
+
+		std::ofstream file(s_PipelineCachePath, std::ios::out | std::ios::binary | std::ios::trunc);
+		if (!file)
+		{
+			LOG("Could not write pipeline cache '%s'\n", s_PipelineCachePath);
+			return;
+		}
+		file.write(data.data(), size);
 	}
 
-}
\ No newline at end of file
+}
@@ -10,10 +10,21 @@ namespace Rose
 
 	struct QueueFamily
 	{
-		int32_t Graphics, Transfer; // TODO: we don't support compute cmd queues yet....
+		int32_t Graphics, Transfer; // Transfer equals Graphics when there is no separate family. TODO: we don't support compute cmd queues yet....
 		int32_t Present;
 	};
 
+	// Everything the CPU needs to record a frame while the GPU may still be working on the previous ones
+	struct FrameData
+	{
+		VkCommandPool CommandPool = VK_NULL_HANDLE;
+		VkCommandBuffer CommandBuffer = VK_NULL_HANDLE;
+
+		VkSemaphore ImageReadySemaphore = VK_NULL_HANDLE;
+		VkSemaphore RenderFinishedSemaphore = VK_NULL_HANDLE;
+		VkFence InFlightFence = VK_NULL_HANDLE;
+	};
+
 	class PhysicalRenderingDevice
 	{
 		public:
@@ -22,6 +33,9 @@ namespace Rose
 
 			const QueueFamily& GetQueueFamily() const { return m_QueueFamilyIndicies; }
 			const VkPhysicalDevice& GetDevice() const { return m_PhysicalDevice; } 
+			const VkPhysicalDeviceProperties& GetProperties() const { return m_PhysicalDeviceProps; }
+			// vkCmdDrawIndexedIndirectCount, optional in 1.2
+			bool SupportsDrawIndirectCount() const { return m_SupportsDrawIndirectCount; }
 
 
 			VkFormat FindDepthFormat();
@@ -36,6 +50,7 @@ namespace Rose
 			VkPhysicalDeviceProperties m_PhysicalDeviceProps{};
 			VkPhysicalDeviceFeatures m_PhysicalDeviceFeatures{};
 			VkPhysicalDeviceMemoryProperties m_PhysicalMemProps{};
+			bool m_SupportsDrawIndirectCount = false;
 
 			VkSampleCountFlagBits m_MSAASamples = VK_SAMPLE_COUNT_1_BIT;
 
@@ -51,16 +66,18 @@ namespace Rose
 	class LogicalRenderingDevice 
 	{
 		public :
-			LogicalRenderingDevice(const std::shared_ptr<PhysicalRenderingDevice>& physicalDevice, VkPhysicalDeviceFeatures features);
+			LogicalRenderingDevice(const std::shared_ptr<PhysicalRenderingDevice>& physicalDevice, VkPhysicalDeviceFeatures features, uint32_t framesInFlight = 2);
 
 			~LogicalRenderingDevice();
 
 			void FlushOntoScreen(VkCommandBuffer buffer);
 			void Shutdown();
 
+			// Only for one off commands (uploads etc), frames record into their own pool
 			VkCommandPool GetCommandPool() { return m_CommandPool; }
 
-			void BeginCommand(VkCommandBuffer& buffer);
+			// Waits until the GPU is done with this frame slot, acquires the next swapchain image and returns the frame's command buffer
+			VkCommandBuffer BeginCommand();
 
 			VkDevice& GetDevice() { return m_Device; }
 			uint32_t GetImageIndex() {
@@ -68,13 +85,23 @@ namespace Rose
 			}
 
 			VkQueue GetQueue() const { return m_RenderingQueue; }
+			// Same as GetQueue() when the GPU has no separate transfer family
+			VkQueue GetTransferQueue() const { return m_TransferQueue; }
+			bool HasDedicatedTransferQueue() const { return m_PhysicalDevice->GetQueueFamily().Transfer != m_PhysicalDevice->GetQueueFamily().Graphics; }
 
+			// Every pipeline should be created through this so the driver can reuse compiled pipelines across runs
+			VkPipelineCache GetPipelineCache() const { return m_PipelineCache; }
+			bool IsPipelineCacheWarm() const { return m_PipelineCacheWarm; }
 
-			// TODO: Put this into swapchain
-			VkSemaphore& GetImageReady() { return m_ImageReadySemaphore; }
-			VkSemaphore& GetRenderFinished() { return m_RenderFinishedSemaphore; }
-			VkFence& GetFramesInFlight() { return m_FramesInFlightFence; }
 
+			uint32_t GetFramesInFlight() const { return (uint32_t)m_Frames.size(); }
+			uint32_t GetCurrentFrameIndex() const { return m_CurrentFrame; }
+			FrameData& GetCurrentFrame() { return m_Frames[m_CurrentFrame]; }
+
+
+		private :
+			void CreatePipelineCache();
+			void SavePipelineCache();
 
 		private :
 			VkDevice m_Device;
@@ -83,9 +110,14 @@ namespace Rose
 
 			VkCommandPool m_CommandPool;
 			VkQueue m_RenderingQueue;
+			VkQueue m_TransferQueue;
+
+			std::vector<FrameData> m_Frames;
+			std::vector<VkFence> m_ImagesInFlight; // Fence of the frame that last rendered to each swapchain image
+			uint32_t m_CurrentFrame = 0;
 
-			VkSemaphore m_ImageReadySemaphore, m_RenderFinishedSemaphore;
-			VkFence m_FramesInFlightFence;
+			VkPipelineCache m_PipelineCache = VK_NULL_HANDLE;
+			bool m_PipelineCacheWarm = false;
 
 			uint32_t m_ImageIndex;
 	};
@@ -0,0 +1,121 @@
+#include "StaticBatcher.h"
+
+#include <unordered_map>
+#include <utility>
+
+namespace Rose
+{
+
+	namespace Utils {
+
+		static glm::vec3 TransformDirection(const glm::mat3& matrix, const glm::vec3& direction)
+		{
+			glm::vec3 result = matrix * direction;
+			float length = glm::length(result);
+			return length > 0.0f ? result / length : direction;
+		}
+
+	}
+
+
+	void StaticBatcher::BakeTransform(Mesh& mesh, const glm::mat4& transform)
+	{
+		glm::mat3 tangentMatrix = glm::mat3(transform);
+		glm::mat3 normalMatrix = glm::transpose(glm::inverse(tangentMatrix));
+
+		for (auto& vertex : mesh.Verticies)
+		{
+			vertex.Position = glm::vec3(transform * glm::vec4(vertex.Position, 1.0f));
+			vertex.Normal = Utils::TransformDirection(normalMatrix, vertex.Normal);
+			vertex.Tangent = Utils::TransformDirection(tangentMatrix, vertex.Tangent);
+			vertex.Binormal = Utils::TransformDirection(tangentMatrix, vertex.Binormal);
+		}
+
+		// A mirroring transform turns every triangle inside out, swap two corners to keep the winding
+		if (glm::determinant(tangentMatrix) < 0.0f)
+		{
+			for (size_t i = 0; i + 2 < mesh.Indicies.size(); i += 3)
+				std::swap(mesh.Indicies[i + 1], mesh.Indicies[i + 2]);
+		}
+
+		mesh.CalculateBounds();
+	}
+
+	void StaticBatcher::Merge(CookedModel& model)
+	{
+		// Parents come first, so every parent's world transform is done by the time its children need it
+		std::vector<glm::mat4> worldTransforms(model.Nodes.size());
+		for (uint32_t i = 0; i < model.Nodes.size(); i++)
+		{
+			const auto& node = model.Nodes[i];
+			worldTransforms[i] = node.Parent == UINT32_MAX ? node.LocalTransform : worldTransforms[node.Parent] * node.LocalTransform;
+		}
+
+		for (uint32_t i = 0; i < model.Meshes.size() && i < model.MeshNodes.size(); i++)
+		{
+			const glm::mat4& transform = worldTransforms[model.MeshNodes[i]];
+			if (transform != glm::mat4(1.0f))
+				BakeTransform(model.Meshes[i], transform);
+		}
+
+		std::vector<Mesh> batches;
+		std::vector<uint32_t> batchMaterials;
+		// The batch of every material that still has room, a full one is left behind and a new one started
+		std::unordered_map<uint32_t, uint32_t> openBatches;
+
+		for (uint32_t i = 0; i < model.Meshes.size(); i++)
+		{
+			Mesh& mesh = model.Meshes[i];
+			uint32_t material = model.MeshMaterials[i];
+			if (mesh.Indicies.empty())
+				continue;
+
+			if (mesh.Verticies.size() > MaxVertices)
+			{
+				batches.push_back(std::move(mesh));
+				batchMaterials.push_back(material);
+				continue;
+			}
+
+			auto it = openBatches.find(material);
+			if (it == openBatches.end() || batches[it->second].Verticies.size() + mesh.Verticies.size() > MaxVertices)
+			{
+				openBatches[material] = (uint32_t)batches.size();
+				batches.emplace_back();
+				batchMaterials.push_back(material);
+				it = openBatches.find(material);
+			}
+
+			Mesh& batch = batches[it->second];
+
+			SubMesh subMesh;
+			subMesh.FirstIndex = (uint32_t)batch.Indicies.size();
+			subMesh.IndexCount = (uint32_t)mesh.Indicies.size();
+			subMesh.BoundsMin = mesh.BoundsMin;
+			subMesh.BoundsMax = mesh.BoundsMax;
+			subMesh.BoundingSphere = mesh.BoundingSphere;
+			batch.SubMeshes.push_back(subMesh);
+
+			uint32_t baseVertex = (uint32_t)batch.Verticies.size();
+			batch.Verticies.insert(batch.Verticies.end(), mesh.Verticies.begin(), mesh.Verticies.end());
+			batch.Indicies.reserve(batch.Indicies.size() + mesh.Indicies.size());
+			for (uint32_t index : mesh.Indicies)
+				batch.Indicies.push_back(baseVertex + index);
+		}
+
+		for (auto& batch : batches)
+		{
+			// Nothing was merged into it, the mesh's own bounds already say everything
+			if (batch.SubMeshes.size() == 1)
+				batch.SubMeshes.clear();
+			batch.CalculateBounds();
+		}
+
+		model.Meshes = std::move(batches);
+		model.MeshMaterials = std::move(batchMaterials);
+		model.MeshNodes.assign(model.Meshes.size(), 0);
+		model.Nodes.assign(1, CookedNode());
+		model.StaticBatched = true;
+	}
+
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "Mesh.h"
+#include "MeshCooker.h"
+
+#include <glm/glm.hpp>
+
+namespace Rose
+{
+
+	// Import time batching of scene content that never moves, the result is cooked like any other model.
+	// Node transforms are baked into the vertices, then meshes sharing a material are concatenated into one mesh
+	// (and so one geometry pool range and one draw) with a SubMesh per source mesh, so the pieces can still be culled on their own.
+	// The node hierarchy is gone afterwards, models whose nodes move on their own are loaded without it.
+	class StaticBatcher
+	{
+		public :
+			// Merged meshes stay small enough for 16 bit indices, bigger source meshes are kept as they are
+			static const uint32_t MaxVertices = 65536;
+
+			// Expects the model's nodes, mesh nodes and mesh materials to be filled in, leaves a single root node behind.
+			// Run it before MeshletBuilder, which never lets a meshlet straddle two sub meshes, and before MeshSimplifier
+			static void Merge(CookedModel& model);
+
+			// Positions and tangents by the transform, normals by its inverse transpose
+			static void BakeTransform(Mesh& mesh, const glm::mat4& transform);
+	};
+
+}
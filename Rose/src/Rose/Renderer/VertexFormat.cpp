@@ -0,0 +1,178 @@
+#include "VertexFormat.h"
+
+#include <glm/gtc/packing.hpp>
+
+namespace Rose
+{
+
+	namespace Utils {
+
+		static int16_t ToSnorm16(float value)
+		{
+			return (int16_t)glm::round(glm::clamp(value, -1.0f, 1.0f) * 32767.0f);
+		}
+
+		static uint16_t ToUnorm16(float value)
+		{
+			return (uint16_t)glm::round(glm::clamp(value, 0.0f, 1.0f) * 65535.0f);
+		}
+
+		static void PackTangentFrame(const Vertex& vertex, int16_t outNormal[2], int16_t outTangent[2])
+		{
+			glm::vec2 normal = VertexPacker::OctahedralEncode(vertex.Normal);
+			glm::vec2 tangent = VertexPacker::OctahedralEncode(vertex.Tangent);
+
+			// y goes from [-1, 1] to (0, 1] and takes the sign of the binormal's handedness, never 0 so the sign survives
+			float handedness = glm::dot(glm::cross(vertex.Normal, vertex.Tangent), vertex.Binormal) < 0.0f ? -1.0f : 1.0f;
+			float tangentY = glm::max(tangent.y * 0.5f + 0.5f, 1.0f / 32767.0f) * handedness;
+
+			outNormal[0] = ToSnorm16(normal.x);
+			outNormal[1] = ToSnorm16(normal.y);
+			outTangent[0] = ToSnorm16(tangent.x);
+			outTangent[1] = ToSnorm16(tangentY);
+		}
+
+	}
+
+
+	uint32_t VertexPacker::GetStride(VertexFormat format, VertexStream stream)
+	{
+		if (stream == VertexStream_Position)
+			return format == VertexFormat::PackedQuantized ? sizeof(QuantizedPosition) : sizeof(glm::vec3);
+
+		return format == VertexFormat::Full ? sizeof(VertexAttributes) : sizeof(PackedAttributes);
+	}
+
+	ShaderAttributeLayout VertexPacker::GetLayout(VertexFormat format)
+	{
+		ShaderMemberType positionType = format == VertexFormat::PackedQuantized ? ShaderMemberType::UShort4Norm : ShaderMemberType::Float3;
+
+		if (format == VertexFormat::Full)
+		{
+			ShaderAttributeLayout layout =
+			{
+				{"a_Position", 0, positionType, VertexStream_Position},
+				{"a_Normal", 1, ShaderMemberType::Float3, VertexStream_Attributes},
+				{"a_Tangent", 2, ShaderMemberType::Float3, VertexStream_Attributes},
+				{"a_Binormal", 3, ShaderMemberType::Float3, VertexStream_Attributes},
+				{"a_TexCoord", 4, ShaderMemberType::Float2, VertexStream_Attributes}
+			};
+			return layout;
+		}
+
+		ShaderAttributeLayout layout =
+		{
+			{"a_Position", 0, positionType, VertexStream_Position},
+			{"a_Normal", 1, ShaderMemberType::Short2Norm, VertexStream_Attributes},
+			{"a_Tangent", 2, ShaderMemberType::Short2Norm, VertexStream_Attributes},
+			{"a_TexCoord", 4, ShaderMemberType::Half2, VertexStream_Attributes}
+		};
+		layout.Defines = { "PACKED_VERTEX" };
+		if (format == VertexFormat::PackedQuantized)
+			layout.Defines.push_back("QUANTIZED_POSITION");
+		return layout;
+	}
+
+	ShaderAttributeLayout VertexPacker::GetPositionLayout(VertexFormat format)
+	{
+		if (format == VertexFormat::PackedQuantized)
+		{
+			ShaderAttributeLayout layout = { {"a_Position", 0, ShaderMemberType::UShort4Norm, VertexStream_Position} };
+			layout.Defines = { "PACKED_VERTEX", "QUANTIZED_POSITION" };
+			return layout;
+		}
+
+		ShaderAttributeLayout layout = { {"a_Position", 0, ShaderMemberType::Float3, VertexStream_Position} };
+		if (format == VertexFormat::Packed)
+			layout.Defines = { "PACKED_VERTEX" };
+		return layout;
+	}
+
+	std::vector<std::vector<uint8_t>> VertexPacker::Pack(const Mesh& mesh, VertexFormat format)
+	{
+		const std::vector<Vertex>& vertices = mesh.Verticies;
+
+		std::vector<std::vector<uint8_t>> result(VertexStream_Count);
+		result[VertexStream_Position].resize(vertices.size() * GetStride(format, VertexStream_Position));
+		result[VertexStream_Attributes].resize(vertices.size() * GetStride(format, VertexStream_Attributes));
+
+		if (format == VertexFormat::PackedQuantized)
+		{
+			// Same mapping the shader undoes with the bounds in ObjectRecord
+			glm::vec3 extent = mesh.BoundsMax - mesh.BoundsMin;
+			glm::vec3 inverseExtent = glm::vec3(
+				extent.x > 0.0f ? 1.0f / extent.x : 0.0f,
+				extent.y > 0.0f ? 1.0f / extent.y : 0.0f,
+				extent.z > 0.0f ? 1.0f / extent.z : 0.0f);
+
+			QuantizedPosition* positions = (QuantizedPosition*)result[VertexStream_Position].data();
+			for (size_t i = 0; i < vertices.size(); i++)
+			{
+				glm::vec3 position = (vertices[i].Position - mesh.BoundsMin) * inverseExtent;
+				positions[i].Position[0] = Utils::ToUnorm16(position.x);
+				positions[i].Position[1] = Utils::ToUnorm16(position.y);
+				positions[i].Position[2] = Utils::ToUnorm16(position.z);
+				positions[i].Position[3] = 0;
+			}
+		}
+		else
+		{
+			glm::vec3* positions = (glm::vec3*)result[VertexStream_Position].data();
+			for (size_t i = 0; i < vertices.size(); i++)
+				positions[i] = vertices[i].Position;
+		}
+
+		if (format == VertexFormat::Full)
+		{
+			VertexAttributes* attributes = (VertexAttributes*)result[VertexStream_Attributes].data();
+			for (size_t i = 0; i < vertices.size(); i++)
+			{
+				attributes[i].Normal = vertices[i].Normal;
+				attributes[i].Tangent = vertices[i].Tangent;
+				attributes[i].Binormal = vertices[i].Binormal;
+				attributes[i].TexCoord = vertices[i].TexCoord;
+			}
+			return result;
+		}
+
+		PackedAttributes* packed = (PackedAttributes*)result[VertexStream_Attributes].data();
+		for (size_t i = 0; i < vertices.size(); i++)
+		{
+			Utils::PackTangentFrame(vertices[i], packed[i].Normal, packed[i].Tangent);
+			packed[i].TexCoord[0] = glm::packHalf1x16(vertices[i].TexCoord.x);
+			packed[i].TexCoord[1] = glm::packHalf1x16(vertices[i].TexCoord.y);
+		}
+		return result;
+	}
+
+	glm::vec2 VertexPacker::OctahedralEncode(const glm::vec3& direction)
+	{
+		float length = glm::abs(direction.x) + glm::abs(direction.y) + glm::abs(direction.z);
+		if (length <= 0.0f)
+			return glm::vec2(0.0f);
+
+		glm::vec3 n = direction / length;
+		glm::vec2 result = glm::vec2(n.x, n.y);
+		if (n.z < 0.0f)
+		{
+			// Fold the lower hemisphere over the diagonals
+			glm::vec2 signs = glm::vec2(n.x >= 0.0f ? 1.0f : -1.0f, n.y >= 0.0f ? 1.0f : -1.0f);
+			result = (1.0f - glm::abs(glm::vec2(n.y, n.x))) * signs;
+		}
+		return result;
+	}
+
+	glm::vec3 VertexPacker::OctahedralDecode(const glm::vec2& encoded)
+	{
+		glm::vec3 n = glm::vec3(encoded.x, encoded.y, 1.0f - glm::abs(encoded.x) - glm::abs(encoded.y));
+		if (n.z < 0.0f)
+		{
+			glm::vec2 signs = glm::vec2(n.x >= 0.0f ? 1.0f : -1.0f, n.y >= 0.0f ? 1.0f : -1.0f);
+			glm::vec2 folded = (1.0f - glm::abs(glm::vec2(n.y, n.x))) * signs;
+			n.x = folded.x;
+			n.y = folded.y;
+		}
+		return glm::normalize(n);
+	}
+
+}
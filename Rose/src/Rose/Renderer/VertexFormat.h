@@ -0,0 +1,77 @@
+#pragma once
+
+#include "Mesh.h"
+#include "API/Shader.h"
+
+#include <vector>
+
+namespace Rose
+{
+
+	// How a mesh's vertices are stored in its vertex buffer. Meshes keep the full Vertex on the CPU, packing happens when the buffer is created.
+	// Every format is split into two streams, positions alone at binding 0 and the rest at binding 1, so depth only passes fetch just positions
+	enum class VertexFormat
+	{
+		Full, // Vertex as is, 12 + 44 bytes
+		Packed, // Float position, octahedral normal and tangent, half float uvs, 12 + 12 bytes
+		PackedQuantized // Packed with unorm16 positions inside the mesh bounds, 8 + 12 bytes
+	};
+
+	enum VertexStream : uint32_t
+	{
+		VertexStream_Position = 0,
+		VertexStream_Attributes = 1,
+		VertexStream_Count
+	};
+
+	// Binding 1 of the full format
+	struct VertexAttributes
+	{
+		glm::vec3 Normal;
+		glm::vec3 Tangent;
+		glm::vec3 Binormal;
+		glm::vec2 TexCoord;
+	};
+
+	// Binding 1 of both packed formats. The binormal is rebuilt from cross(N, T), its handedness is folded into the sign of the tangent's second component
+	struct PackedAttributes
+	{
+		int16_t Normal[2];
+		int16_t Tangent[2];
+		uint16_t TexCoord[2];
+	};
+
+	// Binding 0 of the quantized format. Position is relative to the mesh bounds, ObjectRecord carries the transform back into object space
+	struct QuantizedPosition
+	{
+		uint16_t Position[4];
+	};
+
+	// A mesh's vertex streams already in one format and its 32 bit indices, what the GeometryPool copies into staging.
+	// Only points at the data, whoever filled it in keeps it alive until the pool has staged it
+	struct PackedGeometry
+	{
+		VertexFormat Format = VertexFormat::Full;
+		uint32_t VertexCount = 0;
+		uint32_t IndexCount = 0;
+		const uint8_t* Streams[VertexStream_Count] = {};
+		const uint32_t* Indices = nullptr;
+	};
+
+	class VertexPacker
+	{
+		public :
+			static uint32_t GetStride(VertexFormat format, VertexStream stream);
+			// Attribute layout and shader defines main.shader needs for the format
+			static ShaderAttributeLayout GetLayout(VertexFormat format);
+			// Only the position stream, for depth prepass and shadow pipelines
+			static ShaderAttributeLayout GetPositionLayout(VertexFormat format);
+
+			// Vertex data in the given format, one entry per VertexStream, ready to be copied into a vertex buffer
+			static std::vector<std::vector<uint8_t>> Pack(const Mesh& mesh, VertexFormat format);
+
+			static glm::vec2 OctahedralEncode(const glm::vec3& direction);
+			static glm::vec3 OctahedralDecode(const glm::vec2& encoded);
+	};
+
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include "Rose/Scene/SceneGraph.h"
+#include "Rose/Renderer/InstanceBatcher.h"
+
+namespace Rose
+{
+
+	enum ComponentBits : uint32_t
+	{
+		Component_Transform = 1 << 0,
+		Component_MeshRenderer = 1 << 1,
+		Component_Bounds = 1 << 2,
+		Component_Light = 1 << 3,
+	};
+
+	// Components are plain data, every system works on the arrays of them an archetype keeps
+
+	struct Transform
+	{
+		NodeID Node = InvalidNode; // The scene graph owns the hierarchy, this is a copy of its world transform
+		glm::mat4 World = glm::mat4(1.0f);
+	};
+
+	struct MeshRenderer
+	{
+		RenderItem Item;
+	};
+
+	// Mesh space box, the world space one lives in the archetype's WorldBounds so the culling pass can read it as arrays
+	struct Bounds
+	{
+		glm::vec3 LocalMin = glm::vec3(0.0f);
+		glm::vec3 LocalMax = glm::vec3(0.0f);
+	};
+
+	// Directional, the first one found is the sun the scene uniforms are filled in from
+	struct Light
+	{
+		glm::vec3 Direction = glm::vec3(1.0f);
+		glm::vec3 Color = glm::vec3(1.0f);
+		float Intensity = 1.0f;
+	};
+
+}
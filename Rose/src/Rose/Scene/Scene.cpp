@@ -0,0 +1,295 @@
+#include "Scene.h"
+
+#include "Rose/Core/Log.h"
+#include "Rose/Core/JobSystem.h"
+#include "Rose/Core/Timer.h"
+
+#include <algorithm>
+
+namespace Rose
+{
+
+	namespace Utils {
+
+		// Rows per job, small enough to spread a few thousand entities over the workers. A multiple of 8 keeps the culling loop on full vectors
+		static const uint32_t SystemBatchSize = 256;
+
+	}
+
+
+	uint32_t Scene::GetArchetype(uint32_t mask)
+	{
+		for (uint32_t i = 0; i < m_Archetypes.size(); i++)
+		{
+			if (m_Archetypes[i].Mask == mask)
+				return i;
+		}
+
+		m_Archetypes.emplace_back();
+		m_Archetypes.back().Mask = mask;
+		return (uint32_t)m_Archetypes.size() - 1;
+	}
+
+	EntityID Scene::CreateEntity(uint32_t mask)
+	{
+		EntityID entity;
+		if (!m_FreeEntities.empty())
+		{
+			entity = m_FreeEntities.back();
+			m_FreeEntities.pop_back();
+		}
+		else
+		{
+			entity = (EntityID)m_Entities.size();
+			m_Entities.emplace_back();
+		}
+
+		uint32_t archetypeIndex = GetArchetype(mask);
+		auto& archetype = m_Archetypes[archetypeIndex];
+
+		m_Entities[entity].Archetype = archetypeIndex;
+		m_Entities[entity].Row = (uint32_t)archetype.Entities.size();
+
+		archetype.Entities.push_back(entity);
+		if (mask & Component_Transform)
+			archetype.Transforms.emplace_back();
+		if (mask & Component_MeshRenderer)
+			archetype.MeshRenderers.emplace_back();
+		if (mask & Component_Bounds)
+		{
+			archetype.BoundsData.emplace_back();
+			archetype.WorldBounds.PushBack(glm::vec3(0.0f), glm::vec3(0.0f));
+		}
+		if (mask & Component_Light)
+			archetype.Lights.emplace_back();
+
+		m_Stats.Entities++;
+		return entity;
+	}
+
+	void Scene::DestroyEntity(EntityID entity)
+	{
+		auto& record = m_Entities[entity];
+		if (record.Archetype == UINT32_MAX)
+			return;
+
+		auto& archetype = m_Archetypes[record.Archetype];
+		uint32_t row = record.Row;
+		uint32_t last = (uint32_t)archetype.Entities.size() - 1;
+
+		if (archetype.Mask & Component_Transform)
+		{
+			auto& nodeEntities = m_NodeEntities[archetype.Transforms[row].Node];
+			nodeEntities.erase(std::find(nodeEntities.begin(), nodeEntities.end(), entity));
+		}
+
+		auto removeRow = [row, last](auto& components)
+		{
+			if (components.empty())
+				return;
+			components[row] = components[last];
+			components.pop_back();
+		};
+		removeRow(archetype.Entities);
+		removeRow(archetype.Transforms);
+		removeRow(archetype.MeshRenderers);
+		removeRow(archetype.BoundsData);
+		removeRow(archetype.Lights);
+		if (archetype.WorldBounds.GetCount())
+			archetype.WorldBounds.SwapRemove(row);
+
+		if (row != last)
+			m_Entities[archetype.Entities[row]].Row = row;
+
+		record = EntityRecord();
+		m_FreeEntities.push_back(entity);
+		m_Stats.Entities--;
+	}
+
+	void Scene::AddModel(const Model& model, GeometryPool& pool)
+	{
+		if (m_ModelMeshes.find(&model) != m_ModelMeshes.end())
+			return;
+
+		// The pool's streams are laid out for one format, a model cooked for another would be read with the wrong strides
+		if (model.GetVertexFormat() != pool.GetVertexFormat())
+		{
+			LOG("Scene: model's vertex format doesn't match the geometry pool's\n");
+			ASSERT();
+			return;
+		}
+
+		auto& meshes = m_ModelMeshes[&model];
+		meshes.assign(model.GetMeshes().size(), UINT32_MAX);
+		for (uint32_t i = 0; i < model.GetMeshes().size(); i++)
+		{
+			const auto& mesh = model.GetMeshes()[i];
+			GeometryAllocation allocation;
+			// Cooked meshes are staged straight from their packed streams, imported ones are packed first
+			const PackedGeometry* packed = model.GetPackedGeometry(i);
+			bool allocated = packed ? pool.Allocate(*packed, allocation) : pool.Allocate(mesh, allocation);
+
+			// Left out rather than drawn over another mesh's range, the pool already logged why
+			if (!allocated)
+			{
+				LOG("Scene: mesh %d of a model was skipped, it didn't fit into the geometry pool\n", i);
+				continue;
+			}
+
+			meshes[i] = InstanceBatcher::AddMesh(mesh, model.GetMeshMaterial(i), allocation);
+		}
+	}
+
+	NodeID Scene::Instantiate(const Model& model, const glm::mat4& transform, bool cullClusters)
+	{
+		auto it = m_ModelMeshes.find(&model);
+		if (it == m_ModelMeshes.end())
+		{
+			LOG("Scene: model was instantiated before AddModel()\n");
+			ASSERT();
+			return InvalidNode;
+		}
+
+		NodeID root = m_SceneGraph.CreateNode(InvalidNode, transform);
+		std::vector<NodeID> nodes = m_SceneGraph.AddModel(model, root);
+
+		for (uint32_t i = 0; i < model.GetMeshes().size(); i++)
+		{
+			if (it->second[i] == UINT32_MAX)
+				continue;
+
+			NodeID node = nodes[model.GetMeshNode(i)];
+			const glm::mat4& world = m_SceneGraph.GetWorldTransform(node);
+
+			RenderItem item = InstanceBatcher::AddInstance(it->second[i], world, cullClusters);
+			m_SceneGraph.AttachObject(node, item.ObjectIndex);
+
+			EntityID entity = CreateEntity(Component_Transform | Component_MeshRenderer | Component_Bounds);
+			auto& entityTransform = Get<Transform>(entity);
+			entityTransform.Node = node;
+			entityTransform.World = world;
+			if (m_NodeEntities.size() <= node)
+				m_NodeEntities.resize(node + 1);
+			m_NodeEntities[node].push_back(entity);
+			Get<MeshRenderer>(entity).Item = item;
+			auto& bounds = Get<Bounds>(entity);
+			bounds.LocalMin = model.GetMeshes()[i].BoundsMin;
+			bounds.LocalMax = model.GetMeshes()[i].BoundsMax;
+
+			glm::vec3 worldMin, worldMax;
+			FrustumCuller::TransformBox(world, bounds.LocalMin, bounds.LocalMax, worldMin, worldMax);
+			const auto& record = m_Entities[entity];
+			m_Archetypes[record.Archetype].WorldBounds.Set(record.Row, worldMin, worldMax);
+		}
+
+		return root;
+	}
+
+	EntityID Scene::CreateLight(const Light& light)
+	{
+		EntityID entity = CreateEntity(Component_Light);
+		Get<Light>(entity) = light;
+		return entity;
+	}
+
+	void Scene::UpdateTransforms()
+	{
+		m_SceneGraph.Update();
+		const auto& updatedNodes = m_SceneGraph.GetUpdatedNodes();
+		if (updatedNodes.empty())
+			return;
+
+		// Only the entities of nodes that moved, a node's entities are its own rows so the jobs never write the same row
+		JobCounter counter;
+		Scene* scene = this;
+		JobSystem::ParallelFor((uint32_t)updatedNodes.size(), Utils::SystemBatchSize, [scene, &updatedNodes](uint32_t start, uint32_t end)
+		{
+			for (uint32_t i = start; i < end; i++)
+			{
+				NodeID node = updatedNodes[i];
+				if (node >= scene->m_NodeEntities.size())
+					continue;
+
+				const glm::mat4& world = scene->m_SceneGraph.GetWorldTransform(node);
+				for (EntityID entity : scene->m_NodeEntities[node])
+				{
+					const auto& record = scene->m_Entities[entity];
+					auto& archetype = scene->m_Archetypes[record.Archetype];
+
+					auto& transform = archetype.Transforms[record.Row];
+					transform.World = world;
+					if (!(archetype.Mask & Component_Bounds))
+						continue;
+
+					glm::vec3 worldMin, worldMax;
+					const auto& bounds = archetype.BoundsData[record.Row];
+					FrustumCuller::TransformBox(world, bounds.LocalMin, bounds.LocalMax, worldMin, worldMax);
+					archetype.WorldBounds.Set(record.Row, worldMin, worldMax);
+				}
+			}
+		}, &counter);
+		JobSystem::Wait(counter);
+	}
+
+	void Scene::CollectRenderItems(const Frustum& frustum)
+	{
+		Timer timer;
+
+		// The frustum test runs in parallel into a flag per row, packing stays serial so the list comes out in a stable order
+		JobCounter counter;
+		for (auto& archetype : m_Archetypes)
+		{
+			if (!(archetype.Mask & Component_MeshRenderer))
+				continue;
+
+			archetype.Visible.resize(archetype.Entities.size());
+			if (!(archetype.Mask & Component_Bounds))
+			{
+				std::fill(archetype.Visible.begin(), archetype.Visible.end(), 1);
+				continue;
+			}
+
+			Archetype* rows = &archetype;
+			JobSystem::ParallelFor((uint32_t)archetype.Entities.size(), Utils::SystemBatchSize, [rows, &frustum](uint32_t start, uint32_t end)
+			{
+				FrustumCuller::Cull(frustum, rows->WorldBounds, start, end, rows->Visible.data());
+			}, &counter);
+		}
+		JobSystem::Wait(counter);
+
+		m_RenderItems.clear();
+		m_Stats.MeshRenderers = 0;
+		for (auto& archetype : m_Archetypes)
+		{
+			if (!(archetype.Mask & Component_MeshRenderer))
+				continue;
+
+			for (uint32_t i = 0; i < archetype.MeshRenderers.size(); i++)
+			{
+				if (archetype.Visible[i])
+					m_RenderItems.push_back(archetype.MeshRenderers[i].Item);
+			}
+			m_Stats.MeshRenderers += (uint32_t)archetype.MeshRenderers.size();
+		}
+
+		m_Stats.Archetypes = (uint32_t)m_Archetypes.size();
+		m_Stats.VisibleItems = (uint32_t)m_RenderItems.size();
+		m_Stats.CullTimeMs = timer.ElapsedMillis();
+	}
+
+	void Scene::ApplyLights(SceneUniformData& sceneData) const
+	{
+		for (const auto& archetype : m_Archetypes)
+		{
+			if (!(archetype.Mask & Component_Light) || archetype.Lights.empty())
+				continue;
+
+			const auto& sun = archetype.Lights[0];
+			sceneData.DirLightDir = glm::vec4(sun.Direction, 1.0f);
+			sceneData.DirLightCol = glm::vec4(sun.Color, 1.0f);
+			sceneData.DirLightIntensity.x = sun.Intensity;
+			return;
+		}
+	}
+
+}
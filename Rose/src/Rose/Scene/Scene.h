@@ -0,0 +1,119 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "Rose/Scene/Components.h"
+#include "Rose/Scene/SceneGraph.h"
+#include "Rose/Renderer/Model.h"
+#include "Rose/Renderer/GeometryPool.h"
+#include "Rose/Renderer/FrustumCuller.h"
+#include "Rose/Renderer/API/Shader.h"
+
+namespace Rose
+{
+
+	using EntityID = uint32_t;
+	static const EntityID InvalidEntity = UINT32_MAX;
+
+	struct SceneStats
+	{
+		uint32_t Entities = 0;
+		uint32_t Archetypes = 0;
+		uint32_t MeshRenderers = 0;
+		uint32_t VisibleItems = 0; // Packed by the last CollectRenderItems()
+		float CullTimeMs = 0.0f;
+	};
+
+	// Every entity with the same set of components lives in one archetype, one tightly packed array per component.
+	// Rows line up, so row i of every array belongs to Entities[i]
+	struct Archetype
+	{
+		uint32_t Mask = 0;
+		std::vector<EntityID> Entities;
+
+		std::vector<Transform> Transforms;
+		std::vector<MeshRenderer> MeshRenderers;
+		std::vector<Bounds> BoundsData;
+		std::vector<Light> Lights;
+
+		BoxArrays WorldBounds; // Per row of entities with Bounds, written by UpdateTransforms()
+		std::vector<uint8_t> Visible; // Per row, scratch for CollectRenderItems()
+
+		template<typename T>
+		std::vector<T>& GetComponents()
+		{
+			if constexpr (std::is_same_v<T, Transform>)
+				return Transforms;
+			else if constexpr (std::is_same_v<T, MeshRenderer>)
+				return MeshRenderers;
+			else if constexpr (std::is_same_v<T, Bounds>)
+				return BoundsData;
+			else
+				return Lights;
+		}
+	};
+
+	// What the sandbox draws, instead of a member per model in the Application. Models are registered once and can then be
+	// placed any number of times, each placement is a scene graph subtree with an entity per mesh.
+	// The systems run over whole component arrays on the JobSystem, the renderer only ever sees the packed list of visible render items.
+	class Scene
+	{
+		public :
+			EntityID CreateEntity(uint32_t mask);
+			// Swaps the archetype's last row into the hole. A MeshRenderer's GPUScene object stays allocated, it just isn't drawn anymore
+			void DestroyEntity(EntityID entity);
+
+			template<typename T>
+			T& Get(EntityID entity)
+			{
+				const auto& record = m_Entities[entity];
+				return m_Archetypes[record.Archetype].GetComponents<T>()[record.Row];
+			}
+
+			uint32_t GetMask(EntityID entity) const { return m_Archetypes[m_Entities[entity].Archetype].Mask; }
+
+			// Puts the model's meshes in the pool and hands them to the InstanceBatcher, once per model.
+			// The model's vertex format has to be the pool's. Meshes the pool has no room for are skipped. The model has to outlive the scene
+			void AddModel(const Model& model, GeometryPool& pool);
+			// A root node with the transform, the model's nodes under it and an entity per mesh, returns the root
+			NodeID Instantiate(const Model& model, const glm::mat4& transform = glm::mat4(1.0f), bool cullClusters = false);
+			EntityID CreateLight(const Light& light);
+
+			// Updates the scene graph and copies the world transforms (and boxes) of only the entities whose nodes moved
+			void UpdateTransforms();
+			// Culls every world box against the frustum and fills the render item list
+			void CollectRenderItems(const Frustum& frustum);
+			// The first light is the sun
+			void ApplyLights(SceneUniformData& sceneData) const;
+
+			SceneGraph& GetSceneGraph() { return m_SceneGraph; }
+			const std::vector<RenderItem>& GetRenderItems() const { return m_RenderItems; }
+			const SceneStats& GetStats() const { return m_Stats; }
+
+		private :
+			uint32_t GetArchetype(uint32_t mask);
+
+		private :
+			struct EntityRecord
+			{
+				uint32_t Archetype = UINT32_MAX;
+				uint32_t Row = 0;
+			};
+
+			std::vector<Archetype> m_Archetypes;
+			std::vector<EntityRecord> m_Entities; // By EntityID
+			std::vector<EntityID> m_FreeEntities;
+
+			// InstanceBatcher mesh of every mesh of every registered model, UINT32_MAX for meshes that didn't fit into the pool
+			std::unordered_map<const Model*, std::vector<uint32_t>> m_ModelMeshes;
+			std::vector<std::vector<EntityID>> m_NodeEntities; // By NodeID, entities with a Transform following the node
+
+			SceneGraph m_SceneGraph;
+			std::vector<RenderItem> m_RenderItems;
+			SceneStats m_Stats;
+	};
+
+}
@@ -0,0 +1,231 @@
+#include "SceneGraph.h"
+
+#include "Rose/Renderer/GPUScene.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE__)
+	#include <xmmintrin.h>
+	#define ROSE_SCENE_GRAPH_SSE
+#endif
+
+namespace Rose
+{
+
+	namespace Utils {
+
+		// result = parent * local, column by column. Columns of a glm::mat4 are 4 consecutive floats
+		static void MultiplyTransforms(const glm::mat4& parent, const glm::mat4& local, glm::mat4& result)
+		{
+#ifdef ROSE_SCENE_GRAPH_SSE
+			const float* p = &parent[0][0];
+			const float* l = &local[0][0];
+			float* r = &result[0][0];
+
+			__m128 p0 = _mm_loadu_ps(p + 0);
+			__m128 p1 = _mm_loadu_ps(p + 4);
+			__m128 p2 = _mm_loadu_ps(p + 8);
+			__m128 p3 = _mm_loadu_ps(p + 12);
+
+			for (uint32_t column = 0; column < 4; column++)
+			{
+				const float* c = l + column * 4;
+				__m128 sum = _mm_mul_ps(p0, _mm_set1_ps(c[0]));
+				sum = _mm_add_ps(sum, _mm_mul_ps(p1, _mm_set1_ps(c[1])));
+				sum = _mm_add_ps(sum, _mm_mul_ps(p2, _mm_set1_ps(c[2])));
+				sum = _mm_add_ps(sum, _mm_mul_ps(p3, _mm_set1_ps(c[3])));
+				_mm_storeu_ps(r + column * 4, sum);
+			}
+#else
+			result = parent * local;
+#endif
+		}
+
+		// Every slot of the batch is on the same level, so no slot is the parent of another one
+		static void ComputeWorldTransforms(const uint32_t* slots, size_t count, const uint32_t* parentSlots, const glm::mat4* localTransforms, glm::mat4* worldTransforms)
+		{
+			for (size_t i = 0; i < count; i++)
+			{
+				uint32_t slot = slots[i];
+				uint32_t parent = parentSlots[slot];
+				if (parent == InvalidNode)
+					worldTransforms[slot] = localTransforms[slot];
+				else
+					MultiplyTransforms(worldTransforms[parent], localTransforms[slot], worldTransforms[slot]);
+			}
+		}
+
+	}
+
+
+	NodeID SceneGraph::CreateNode(NodeID parent, const glm::mat4& localTransform)
+	{
+		NodeID node = (NodeID)m_Parents.size();
+		m_Parents.push_back(parent);
+		m_Objects.emplace_back();
+
+		// Appended unsorted, the next Update() sorts it into its level
+		m_Slots.push_back((uint32_t)m_SlotNodes.size());
+		m_SlotNodes.push_back(node);
+		m_ParentSlots.push_back(parent == InvalidNode ? InvalidNode : m_Slots[parent]);
+		m_FirstChildSlots.push_back(0);
+		m_ChildCounts.push_back(0);
+		m_Depths.push_back(0);
+		m_LocalTransforms.push_back(localTransform);
+		m_WorldTransforms.push_back(parent == InvalidNode ? localTransform : GetWorldTransform(parent) * localTransform);
+		m_Dirty.push_back(0);
+
+		m_NeedsSort = true;
+		return node;
+	}
+
+	std::vector<NodeID> SceneGraph::AddModel(const Model& model, NodeID parent)
+	{
+		const auto& nodes = model.GetNodes();
+		std::vector<NodeID> result(nodes.size());
+		for (uint32_t i = 0; i < nodes.size(); i++)
+			result[i] = CreateNode(nodes[i].Parent == UINT32_MAX ? parent : result[nodes[i].Parent], nodes[i].LocalTransform);
+		return result;
+	}
+
+	void SceneGraph::SetLocalTransform(NodeID node, const glm::mat4& localTransform)
+	{
+		uint32_t slot = m_Slots[node];
+		if (m_LocalTransforms[slot] == localTransform)
+			return;
+
+		m_LocalTransforms[slot] = localTransform;
+		// Everything gets recomputed after a sort anyway
+		if (!m_NeedsSort)
+			m_DirtySlots.push_back(slot);
+	}
+
+	void SceneGraph::AttachObject(NodeID node, uint32_t objectIndex)
+	{
+		m_Objects[node].push_back(objectIndex);
+		GPUScene::SetTransform(objectIndex, GetWorldTransform(node));
+	}
+
+	void SceneGraph::Sort()
+	{
+		uint32_t nodeCount = (uint32_t)m_Parents.size();
+
+		// Children of every node by NodeID, counting sort keeps them in creation order
+		std::vector<uint32_t> childStart(nodeCount + 1, 0);
+		for (NodeID node = 0; node < nodeCount; node++)
+		{
+			if (m_Parents[node] != InvalidNode)
+				childStart[m_Parents[node] + 1]++;
+		}
+		for (uint32_t i = 0; i < nodeCount; i++)
+			childStart[i + 1] += childStart[i];
+
+		std::vector<NodeID> children(childStart[nodeCount]);
+		std::vector<uint32_t> childFill(childStart.begin(), childStart.end() - 1);
+		for (NodeID node = 0; node < nodeCount; node++)
+		{
+			if (m_Parents[node] != InvalidNode)
+				children[childFill[m_Parents[node]]++] = node;
+		}
+
+		// Breadth first from the roots, which leaves the nodes sorted by depth with siblings next to each other
+		std::vector<NodeID> order;
+		order.reserve(nodeCount);
+		for (NodeID node = 0; node < nodeCount; node++)
+		{
+			if (m_Parents[node] == InvalidNode)
+				order.push_back(node);
+		}
+
+		std::vector<uint32_t> firstChildSlots(nodeCount), childCounts(nodeCount), depths(nodeCount, 0), parentSlots(nodeCount, InvalidNode);
+		for (uint32_t slot = 0; slot < order.size(); slot++)
+		{
+			NodeID node = order[slot];
+			firstChildSlots[slot] = (uint32_t)order.size();
+			childCounts[slot] = childStart[node + 1] - childStart[node];
+			for (uint32_t i = childStart[node]; i < childStart[node + 1]; i++)
+			{
+				parentSlots[order.size()] = slot;
+				depths[order.size()] = depths[slot] + 1;
+				order.push_back(children[i]);
+			}
+		}
+
+		std::vector<glm::mat4> localTransforms(nodeCount), worldTransforms(nodeCount);
+		for (uint32_t slot = 0; slot < nodeCount; slot++)
+		{
+			localTransforms[slot] = m_LocalTransforms[m_Slots[order[slot]]];
+			worldTransforms[slot] = m_WorldTransforms[m_Slots[order[slot]]];
+		}
+		for (uint32_t slot = 0; slot < nodeCount; slot++)
+			m_Slots[order[slot]] = slot;
+
+		m_SlotNodes = std::move(order);
+		m_ParentSlots = std::move(parentSlots);
+		m_FirstChildSlots = std::move(firstChildSlots);
+		m_ChildCounts = std::move(childCounts);
+		m_Depths = std::move(depths);
+		m_LocalTransforms = std::move(localTransforms);
+		m_WorldTransforms = std::move(worldTransforms);
+		m_Dirty.assign(nodeCount, 0);
+
+		m_LevelCount = nodeCount ? m_Depths.back() + 1 : 0;
+		m_LevelBatches.resize(m_LevelCount);
+
+		// Walking down from every root recomputes the whole graph
+		m_DirtySlots.clear();
+		for (uint32_t slot = 0; slot < nodeCount && m_Depths[slot] == 0; slot++)
+			m_DirtySlots.push_back(slot);
+
+		m_NeedsSort = false;
+	}
+
+	void SceneGraph::Update()
+	{
+		if (m_NeedsSort)
+			Sort();
+
+		m_UpdatedNodes.clear();
+		for (auto& batch : m_LevelBatches)
+			batch.clear();
+
+		for (uint32_t slot : m_DirtySlots)
+		{
+			if (m_Dirty[slot])
+				continue;
+			m_Dirty[slot] = 1;
+			m_LevelBatches[m_Depths[slot]].push_back(slot);
+		}
+		m_DirtySlots.clear();
+
+		for (uint32_t level = 0; level < m_LevelCount; level++)
+		{
+			auto& batch = m_LevelBatches[level];
+			Utils::ComputeWorldTransforms(batch.data(), batch.size(), m_ParentSlots.data(), m_LocalTransforms.data(), m_WorldTransforms.data());
+
+			// Children of a dirty node are dirty too, a node already queued on its own is only recomputed once
+			for (uint32_t slot : batch)
+			{
+				for (uint32_t child = m_FirstChildSlots[slot]; child < m_FirstChildSlots[slot] + m_ChildCounts[slot]; child++)
+				{
+					if (m_Dirty[child])
+						continue;
+					m_Dirty[child] = 1;
+					m_LevelBatches[level + 1].push_back(child);
+				}
+
+				m_Dirty[slot] = 0;
+				m_UpdatedNodes.push_back(m_SlotNodes[slot]);
+			}
+		}
+
+		for (NodeID node : m_UpdatedNodes)
+		{
+			for (uint32_t object : m_Objects[node])
+				GPUScene::SetTransform(object, GetWorldTransform(node));
+		}
+
+		m_Stats.Nodes = (uint32_t)m_Parents.size();
+		m_Stats.Levels = m_LevelCount;
+		m_Stats.UpdatedNodes = (uint32_t)m_UpdatedNodes.size();
+	}
+
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "Rose/Renderer/Model.h"
+
+namespace Rose
+{
+
+	using NodeID = uint32_t;
+	static const NodeID InvalidNode = UINT32_MAX;
+
+	struct SceneGraphStats
+	{
+		uint32_t Nodes = 0;
+		uint32_t Levels = 0;
+		uint32_t UpdatedNodes = 0; // World transforms recomputed by the last Update()
+	};
+
+	// Parent/child transform hierarchy. Nodes are stored as flat arrays (parents, local and world transforms...)
+	// sorted by depth, breadth first, so the children of a node are one contiguous run on the next level.
+	// Changing a transform only queues the node, Update() then walks down the dirty subtrees one level at a time and
+	// recomputes their world transforms in batches, every parent of a level is already done when it runs.
+	// Moving a node costs its subtree, not the scene. NodeIDs stay valid while the arrays get resorted.
+	class SceneGraph
+	{
+		public :
+			NodeID CreateNode(NodeID parent = InvalidNode, const glm::mat4& localTransform = glm::mat4(1.0f));
+			// One node per model node under parent, returns the node of every model node
+			std::vector<NodeID> AddModel(const Model& model, NodeID parent = InvalidNode);
+
+			void SetLocalTransform(NodeID node, const glm::mat4& localTransform);
+			const glm::mat4& GetLocalTransform(NodeID node) const { return m_LocalTransforms[m_Slots[node]]; }
+			// As of the last Update()
+			const glm::mat4& GetWorldTransform(NodeID node) const { return m_WorldTransforms[m_Slots[node]]; }
+			NodeID GetParent(NodeID node) const { return m_Parents[node]; }
+
+			// The GPUScene object follows the node's world transform from the next Update() on
+			void AttachObject(NodeID node, uint32_t objectIndex);
+
+			// Recomputes every dirty subtree and pushes the new world transforms of attached objects to the GPUScene
+			void Update();
+
+			// Nodes whose world transform changed in the last Update()
+			const std::vector<NodeID>& GetUpdatedNodes() const { return m_UpdatedNodes; }
+			const SceneGraphStats& GetStats() const { return m_Stats; }
+
+		private :
+			// Rebuilds the depth order after nodes were added, everything is dirty afterwards
+			void Sort();
+
+		private :
+			// By NodeID
+			std::vector<NodeID> m_Parents;
+			std::vector<uint32_t> m_Slots; // Position of the node in the depth sorted arrays
+			std::vector<std::vector<uint32_t>> m_Objects;
+
+			// Depth sorted, by slot
+			std::vector<NodeID> m_SlotNodes;
+			std::vector<uint32_t> m_ParentSlots; // InvalidNode for roots
+			std::vector<uint32_t> m_FirstChildSlots;
+			std::vector<uint32_t> m_ChildCounts;
+			std::vector<uint32_t> m_Depths;
+			std::vector<glm::mat4> m_LocalTransforms;
+			std::vector<glm::mat4> m_WorldTransforms;
+			std::vector<uint8_t> m_Dirty;
+
+			std::vector<uint32_t> m_DirtySlots; // Queued by SetLocalTransform()
+			std::vector<std::vector<uint32_t>> m_LevelBatches; // Slots to recompute on every level, reused between updates
+			std::vector<NodeID> m_UpdatedNodes;
+			uint32_t m_LevelCount = 0;
+			bool m_NeedsSort = false;
+
+			SceneGraphStats m_Stats;
+	};
+
+}
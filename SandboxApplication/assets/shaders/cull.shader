@@ -0,0 +1,111 @@
+#type compute
+#version 450 core
+
+layout(local_size_x = 64) in;
+
+struct ClusterRecord
+{
+	vec4 BoundingSphere;
+	vec4 Cone;
+	uint FirstIndex;
+	uint IndexCount;
+	int VertexOffset;
+	uint ObjectIndex;
+	uint Group;
+	uint CommandOffset;
+	uint Padding0;
+	uint Padding1;
+};
+
+struct ObjectRecord
+{
+	mat4 Model;
+	mat4 NormalMatrix;
+	vec4 BoundingSphere;
+	vec4 PositionScale;
+	vec4 PositionOffset;
+	uvec4 MaterialIndex;
+};
+
+// VkDrawIndexedIndirectCommand
+struct DrawCommand
+{
+	uint IndexCount;
+	uint InstanceCount;
+	uint FirstIndex;
+	int VertexOffset;
+	uint FirstInstance;
+};
+
+layout(std430, binding = 0) readonly buffer ClusterBuffer
+{
+	ClusterRecord Clusters[];
+} clusters;
+
+layout(std430, binding = 1) readonly buffer ObjectBuffer
+{
+	ObjectRecord Objects[];
+} objects;
+
+layout(std430, binding = 2) writeonly buffer CommandBuffer
+{
+	DrawCommand Commands[];
+} commands;
+
+layout(std430, binding = 3) buffer CountBuffer
+{
+	uint Counts[];
+} counts;
+
+layout(push_constant) uniform PushConstants
+{
+	vec4 Planes[6];
+	vec4 CameraPosition;
+	uvec4 ClusterCount;
+} pc;
+
+
+// Same test as ClusterCuller::IsVisible
+bool IsVisible(ClusterRecord cluster, ObjectRecord object)
+{
+	vec3 center = (object.Model * vec4(cluster.BoundingSphere.xyz, 1.0)).xyz;
+	float scale = max(length(object.Model[0].xyz), max(length(object.Model[1].xyz), length(object.Model[2].xyz)));
+	float radius = cluster.BoundingSphere.w * scale;
+
+	for (int i = 0; i < 6; i++)
+	{
+		if (dot(pc.Planes[i].xyz, center) + pc.Planes[i].w < -radius)
+			return false;
+	}
+
+	if (cluster.Cone.w < 1.0)
+	{
+		vec3 axis = normalize(mat3(object.NormalMatrix) * cluster.Cone.xyz);
+		vec3 toCluster = center - pc.CameraPosition.xyz;
+		if (dot(toCluster, axis) >= cluster.Cone.w * length(toCluster) + radius)
+			return false;
+	}
+
+	return true;
+}
+
+void main()
+{
+	uint index = gl_GlobalInvocationID.x;
+	if (index >= pc.ClusterCount.x)
+		return;
+
+	ClusterRecord cluster = clusters.Clusters[index];
+	if (!IsVisible(cluster, objects.Objects[cluster.ObjectIndex]))
+		return;
+
+	uint slot = atomicAdd(counts.Counts[cluster.Group], 1);
+
+	DrawCommand command;
+	command.IndexCount = cluster.IndexCount;
+	command.InstanceCount = 1;
+	command.FirstIndex = cluster.FirstIndex;
+	command.VertexOffset = cluster.VertexOffset;
+	command.FirstInstance = 0;
+	commands.Commands[cluster.CommandOffset + slot] = command;
+}
@@ -2,11 +2,20 @@
 #version 450 core
 
 
+#ifdef PACKED_VERTEX
+// Quantized positions are unorm16 inside the mesh bounds, otherwise plain floats (w reads as 1)
+layout(location = 0) in vec4 a_Position;
+// Octahedral, the sign of the tangent's y is the binormal's handedness
+layout(location = 1) in vec2 a_Normal;
+layout(location = 2) in vec2 a_Tangent;
+layout(location = 4) in vec2 a_TexCoord;
+#else
 layout(location = 0) in vec3 a_Position;
 layout(location = 1) in vec3 a_Normal;
 layout(location = 2) in vec3 a_Tangent;
 layout(location = 3) in vec3 a_Binormal;
 layout(location = 4) in vec2 a_TexCoord;
+#endif
 
 
 struct VertexOutput
@@ -26,11 +35,12 @@ struct VertexOutput
 };
 
 layout(location = 0) out VertexOutput v_Output;
+// After the 11 locations of VertexOutput
+layout(location = 11) flat out uint v_MaterialIndex;
 
 
-layout(std140, binding = 0) uniform BufferObject
+layout(std140, binding = 0) uniform SceneBuffer
 {
-	mat4 Model;
 	mat4 View;
 	mat4 Proj;
 	mat4 ViewProj;
@@ -42,26 +52,78 @@ layout(std140, binding = 0) uniform BufferObject
 	vec4 EnivormentMapIntensity;
 } ubo;
 
-void main()
+struct ObjectRecord
+{
+	mat4 Model;
+	mat4 NormalMatrix;
+	vec4 BoundingSphere;
+	vec4 PositionScale;
+	vec4 PositionOffset;
+	uvec4 MaterialIndex;
+};
+
+layout(std430, binding = 8) readonly buffer ObjectBuffer
+{
+	ObjectRecord Objects[];
+} objects;
+
+// Object index of every instance drawn this frame, a draw's instances are consecutive
+layout(std430, binding = 9) readonly buffer InstanceBuffer
+{
+	uint ObjectIndices[];
+} instances;
+
+layout(push_constant) uniform PushConstants
 {
-	mat4 transform = ubo.Model;
+	uint InstanceOffset;
+} pc;
 
-	vec4 worldPos = vec4(a_Position, 1.0);
-	vec4 worldPos2 = transform* vec4(a_Position, 1.0);
+vec3 OctahedralDecode(vec2 e)
+{
+	vec3 n = vec3(e.xy, 1.0 - abs(e.x) - abs(e.y));
+	if (n.z < 0.0)
+		n.xy = (1.0 - abs(n.yx)) * mix(vec2(-1.0), vec2(1.0), greaterThanEqual(n.xy, vec2(0.0)));
+	return normalize(n);
+}
+
+void main()
+{
+	uint objectIndex = instances.ObjectIndices[pc.InstanceOffset + gl_InstanceIndex];
+	mat4 transform = objects.Objects[objectIndex].Model;
+	mat3 normalMatrix = mat3(objects.Objects[objectIndex].NormalMatrix);
+
+#ifdef PACKED_VERTEX
+	#ifdef QUANTIZED_POSITION
+	vec3 position = objects.Objects[objectIndex].PositionOffset.xyz + a_Position.xyz * objects.Objects[objectIndex].PositionScale.xyz;
+	#else
+	vec3 position = a_Position.xyz;
+	#endif
+	vec3 normal = OctahedralDecode(a_Normal);
+	vec3 tangent = OctahedralDecode(vec2(a_Tangent.x, abs(a_Tangent.y) * 2.0 - 1.0));
+	vec3 binormal = cross(normal, tangent) * (a_Tangent.y < 0.0 ? -1.0 : 1.0);
+#else
+	vec3 position = a_Position;
+	vec3 normal = a_Normal;
+	vec3 tangent = a_Tangent;
+	vec3 binormal = a_Binormal;
+#endif
+
+	vec4 worldPos = vec4(position, 1.0);
+	vec4 worldPos2 = transform* vec4(position, 1.0);
 
 
 	v_Output.WorldPosition = worldPos2.xyz;
-	v_Output.Normal = mat3(transform) * a_Normal;
+	v_Output.Normal = normalMatrix * normal;
 
 	v_Output.TexCoord = vec2(a_TexCoord.x, 1.0f-a_TexCoord.y);
-	mat3 nMatrix = mat3(transform);
+	mat3 nMatrix = normalMatrix;
 
-	vec3 T = normalize(nMatrix * a_Binormal.xyz);
-	vec3 N = normalize(nMatrix * a_Normal.xyz);
+	vec3 T = normalize(nMatrix * binormal);
+	vec3 N = normalize(nMatrix * normal);
 	vec3 B = normalize(cross(N, T) * 1.0f);
 
 
-	v_Output.WorldNormals = mat3(transform) * mat3(a_Tangent, B, a_Normal);
+	v_Output.WorldNormals = normalMatrix * mat3(tangent, B, normal);
 
 
 
@@ -75,6 +137,7 @@ void main()
 
 	v_Output.DirLightIntensity = ubo.DirLightIntensity.x;
 	v_Output.EnivormentMapIntensity = ubo.EnivormentMapIntensity.x;
+	v_MaterialIndex = objects.Objects[objectIndex].MaterialIndex.x;
 
 	gl_Position = ubo.ViewProj * transform * worldPos;
 }
@@ -124,6 +187,19 @@ struct VertexOutput
 	float EnivormentMapIntensity;
 };
 layout(location = 0) in VertexOutput v_Input;
+layout(location = 11) flat in uint v_MaterialIndex;
+
+struct MaterialRecord
+{
+	vec4 AlbedoFactor;
+	float MetalnessFactor;
+	float RoughnessFactor;
+};
+
+layout(std430, binding = 10) readonly buffer MaterialBuffer
+{
+	MaterialRecord Materials[];
+} materials;
 
 
 layout(location = 0) out vec4 fragColor;
@@ -291,12 +367,14 @@ vec3 IBL(vec3 F0,vec3 NN, vec3 albedo, float metal, float rough)
 void main()
 {
 	
-	vec4 albedoSample = texture(u_AlbedoMap, v_Input.TexCoord);
+	MaterialRecord material = materials.Materials[v_MaterialIndex];
+
+	vec4 albedoSample = texture(u_AlbedoMap, v_Input.TexCoord) * material.AlbedoFactor;
 	float alpha = albedoSample.a;
 	vec3 albedo = pow(albedoSample.rgb, vec3(2.2));
 
-	float metallicness = 1.0f;
-	float roughness = 1.0f;
+	float metallicness = material.MetalnessFactor;
+	float roughness = material.RoughnessFactor;
 
 	float metalSample = texture(u_MetalicnessMap, v_Input.TexCoord).r* metallicness;
 	float roughSample = texture(u_RoughnessMap, v_Input.TexCoord).r* roughness;
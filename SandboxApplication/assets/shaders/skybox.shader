@@ -4,9 +4,8 @@
 
 layout(location = 0) in vec3 a_Position;
 
-layout(std140, binding = 0) uniform BufferObject
+layout(std140, binding = 0) uniform SceneBuffer
 {
-	mat4 Model;
 	mat4 View;
 	mat4 Proj;
 	mat4 ViewProj;
@@ -2,13 +2,101 @@
 #if 1
 #include "Rose/Core/Application.h"
 
+#include <imgui/imgui.h>
+#include "glm/gtx/transform.hpp"
+#include "glm/gtx/quaternion.hpp"
+
+#include <algorithm>
+
+
+namespace Rose
+{
+
+	// Two models up front, a grid of copies below them and a sun
+	class SandboxApplication : public Application
+	{
+		public :
+			// Opts in to the smallest vertex streams
+			SandboxApplication()
+				: Application(VertexFormat::PackedQuantized)
+			{
+			}
+
+		protected :
+			void OnInit() override
+			{
+				//LoadModel("assets/models/sponza/sponza.gltf");
+				auto testModel = LoadModel("assets/models/used-stainless-steel/used-stainless-steel.fbx");
+				// Not static batched, it keeps its node hierarchy so its parts can be moved on their own
+				auto sphereModel = LoadModel("assets/models/Cerberus_by_Andrew_Maximov/Cerberus_LP_mapped.fbx", false);
+
+				Scene& scene = GetScene();
+
+				// The two models up front are cluster culled, the grid of copies below them is instanced
+				scene.Instantiate(*testModel, glm::mat4(1.0f), true);
+				m_SphereModelNode = scene.Instantiate(*sphereModel, glm::mat4(1.0f), true);
+
+				float radius = 0.0f;
+				for (auto& mesh : testModel->GetMeshes())
+					radius = std::max(radius, glm::length(glm::vec3(mesh.BoundingSphere)) + mesh.BoundingSphere.w);
+
+				const uint32_t gridSize = 24;
+				float spacing = radius * 3.0f;
+				for (uint32_t z = 0; z < gridSize; z++)
+				{
+					for (uint32_t x = 0; x < gridSize; x++)
+					{
+						glm::vec3 position = glm::vec3(((float)x - gridSize * 0.5f) * spacing, -spacing, ((float)z - gridSize * 0.5f) * spacing);
+						scene.Instantiate(*testModel, glm::translate(glm::mat4(1.0f), position));
+					}
+				}
+
+				Light sun;
+				sun.Direction = glm::vec3(1.0f, 1.0f, 1.0f);
+				sun.Color = glm::vec3(1.0f, 1.0f, 1.0f);
+				sun.Intensity = 1.0f;
+				m_SunLight = scene.CreateLight(sun);
+			}
+
+			void OnUpdate(float timestep) override
+			{
+				// Only the subtree under the model root is recomputed, and only when the transform changed
+				glm::mat4 sphereTransform = glm::translate(glm::mat4(1.0f), m_SpherePos) * glm::toMat4(glm::quat(glm::radians(m_SphereRot))) * glm::scale(glm::mat4(1.0f), m_SphereScale);
+				GetScene().GetSceneGraph().SetLocalTransform(m_SphereModelNode, sphereTransform);
+			}
+
+			void OnImguiDraw() override
+			{
+				ImGui::Begin("Sandbox");
+				ImGui::DragFloat3("model pos", &m_SpherePos.x);
+				ImGui::DragFloat3("model rot", &m_SphereRot.x);
+				ImGui::DragFloat3("model scale", &m_SphereScale.x);
+				ImGui::NewLine();
+				auto& sun = GetScene().Get<Light>(m_SunLight);
+				ImGui::SliderFloat3("Dir light Direction", &sun.Direction.x, -1.0f, 1.0f);
+				ImGui::ColorEdit3("Dir light Color", &sun.Color.x);
+				ImGui::DragFloat("Dir light Intensity", &sun.Intensity);
+				ImGui::End();
+			}
+
+		private :
+			NodeID m_SphereModelNode = InvalidNode;
+			EntityID m_SunLight = InvalidEntity;
+
+			glm::vec3 m_SpherePos = { 0.0f, 150.0f, 0.0f };
+			glm::vec3 m_SphereRot = { 90.0f, 0.0, 180.0f };
+			glm::vec3 m_SphereScale = { 1.0f, 1.0f, 1.0f };
+	};
+
+}
+
 
 int main()
 {
 	using namespace Rose;
 
 
-	Application* app = new Application;
+	Application* app = new SandboxApplication;
 	app->Run();
 
 	delete app;
@@ -101,6 +101,10 @@ group "Core"
 			"_CRT_SECURE_NO_WARNINGS"
 		}
 
+		-- Only the frustum culling kernel uses AVX2, it's picked at runtime so the engine still runs without it
+		filter "files:**/FrustumCullerAVX2.cpp"
+			vectorextensions "AVX2"
+
 		filter "system:windows"
 			systemversion "latest"
 